@@ -6,6 +6,8 @@ mkdir data 2> /dev/null
 
 cp -r data bin
 gcc src/pre/pre_build.cpp -g -lm -lrt -lpthread -o bin/pre_dorfbook
-bin/pre_dorfbook gen/
+bin/pre_dorfbook gen/ data/
+gcc src/pre/pre_assets.cpp -g -lm -lrt -lpthread -o bin/pre_assets
+bin/pre_assets gen/ data/
 gcc src/build.cpp -D BUILD_DEBUG -g -lm -lrt -pthread -o bin/dorfbook
 
@@ -0,0 +1,312 @@
+// Generated from data/faces.svg:1
+const char asset_faces_text[9118] =
+	"ltgtampaposquotns_svgns_xlinkversionidxmlnsxmlns:xlinkwidthheightviewBoxoverflowenable-backgroundxml:spacesvggfillstrokedpath1.1Layer_1http://www.w3.org/2000/svghttp://www.w3.org/1999/xlink48.28362.5860 0 48.283 62.586visiblenew 0 0 48.283 62.586preservefacesface-base01#FFE3BF#000000M33.397,5.866c-0.252-0.229-0.519-0.453-0.797-0.672\n"
+	"\011\011\011c-1.929-1.511-3.855-2.951-6.172-3.802c-4.695-1.725-10.372-0.797-13.887,2.96c-1.402,1.499-2.467,3.573-3.245,5.453\n"
+	"\011\011\011c-1.074,2.6-2.484,5.311-2.886,8.125c-0.348,2.432-0.198,5.266-0.081,7.725c0.131,2.763,1.309,5.429,2.18,8.016\n"
+	"\011\011\011c1.336,3.966,3.027,8.891,6.039,11.918c3.233,3.252,8.933,3.666,13.224,3.664c1.658-0.002,3.045,0.065,4.615-0.482\n"
+	"\011\011\011c1.338-0.467,2.62-1.055,3.805-1.843c1.642-1.095,2.841-2.503,4-4.085c1.715-2.344,3.598-4.521,4.307-7.413\n"
+	"\011\011\011c0.589-2.405,0.518-4.625-0.119-6.991c-0.785-2.919-1.332-5.698-2.527-8.497c-1.334-3.12-2.674-5.931-4.428-8.841\n"
+	"\011\011\011C36.235,9.125,35.074,7.38,33.397,5.866zface-base02#FFC05F#000000M22.176,0.5c-1.118-0.03-2.339,1.046-3.311,1.496c-2.217,1.026-3.68,2.548-5.297,4.338\n"
+	"\011\011\011c-2.812,3.113-4.631,6.732-6.063,10.658c-1.5,4.116-1.747,8.576-1.746,12.903c0,4.516,0.616,9.549,2.935,13.523\n"
+	"\011\011\011c1.264,2.166,3.076,4.229,5.288,5.436c2.46,1.342,5,0.837,7.669,0.977c1.528,0.078,3.024,0.232,4.566,0.176\n"
+	"\011\011\011c2.319-0.086,4.146-1.022,6.147-2.092c6.387-3.408,10.625-10.566,10.488-17.791c-0.031-1.749-0.537-3.439-0.828-5.154\n"
+	"\011\011\011c-0.342-2.008-0.686-3.949-1.371-5.882c-1.082-3.054-1.969-5.951-3.637-8.75c-1.646-2.76-3.522-4.761-6.348-6.34\n"
+	"\011\011\011C27.815,2.402,24.905,0.5,21.593,0.5face-base03#FFD99F#000000M33.589,2.995c-1.675-1.14-3.057-2.226-5.113-1.904\n"
+	"\011\011\011c-1.838,0.288-3.789-0.103-5.638-0.213c-3.592-0.215-7.75-0.203-10.538,2.436c-2.091,1.979-3.41,4.083-4.719,6.635\n"
+	"\011\011\011c-1.777,3.467-3.882,6.799-5.302,10.441c-1.232,3.16-2.347,6.347-1.458,9.777c0.865,3.333,2.832,6.294,3.935,9.562\n"
+	"\011\011\011c0.782,2.314,1.573,4.759,2.777,6.893c0.886,1.569,1.615,2.086,3.339,2.438c1.907,0.392,3.766,1.007,5.684,1.362\n"
+	"\011\011\011c1.61,0.298,3.203,0.244,4.835,0.244c2.458,0,4.499-0.309,6.896-0.992c5.219-1.488,9.837-4.117,13.479-8.119\n"
+	"\011\011\011c1.043-1.146,2.275-2.21,2.869-3.68c0.477-1.174,0.608-2.488,0.893-3.724c0.531-2.313,1.207-4.593,1.734-6.905\n"
+	"\011\011\011c0.684-2.989,0.771-6.494-0.189-9.419C44.833,11.021,39.321,6.897,33.589,2.995zeyesface-eyes01#FFFFFF#000000M9.675,25.918c0.134,1.588,1.411,1.962,2.913,2.177c1.21,0.173,2.47,0.063,3.689,0.07\n"
+	"\011\011\011c0.646,0.005,1.539,0.122,2.078-0.352c1.766-1.55-0.965-3.1-2.22-3.707c-1.172-0.567-2.637-1.458-3.994-1.289\n"
+	"\011\011\011C10.61,23.008,9.548,24.414,9.675,25.918z#FFFFFF#000000M37.207,23.512c1.446,1.867,0.222,3.94-1.804,4.475c-1.711,0.451-3.6,0.59-5.36,0.602\n"
+	"\011\011\011c-0.813,0.006-3.142,0.465-3.409-0.637c-0.251-1.025,1.963-3.024,2.723-3.623C31.112,22.943,35.41,21.195,37.207,23.512znone#000000M32.177,26.5c0.725-0.017,0.563-1.142-0.135-0.844C31.569,25.859,31.621,26.513,32.177,26.5\n"
+	"\011\011\011znone#000000M13.99,26.418c0.107-0.003,0.192-0.039,0.255-0.095c0.297-0.263,0.102-0.939-0.333-0.854\n"
+	"\011\011\011C13.456,25.555,13.449,26.435,13.99,26.418znone#000000M9.593,19.584c0.754-0.963,2.627-1.261,3.583-0.489c0.321,0.26,0.466,0.676,0.754,0.97\n"
+	"\011\011\011c0.699,0.714,1.532,0.857,2.496,0.926c0.988,0.071,2.414,0.237,3.333-0.241none#000000M35.76,19.25c-1.929,0-4.438-0.483-5.975,0.925c-1.028,0.942-2.005,1.435-3.525,1.491Layer_6face-eyes02#FFFFFF#000000M10.753,25.665c0.313,2.259,4.729,2.705,6.403,1.773\n"
+	"\011\011\011c1.773-0.987,1.575-3.117,0.025-4.187c-1.427-0.986-2.952-1.506-4.575-0.802C11.261,23.032,10.546,24.172,10.753,25.665z#FFFFFF#000000M29.483,26.396c0.59,2.111,4.141,2.918,5.849,1.893c2.229-1.337-0.287-3.792-1.66-4.614\n"
+	"\011\011\011C31.806,22.558,28.774,23.861,29.483,26.396znone#000000M28.26,19.417c1.222-0.004,3.628-0.661,4.403,0.338c0.365,0.47,0.113,0.762,0.822,1.022\n"
+	"\011\011\011c0.56,0.205,1.344,0.057,1.939,0.057none#000000M17.093,18.417c-1.034-0.344-2.535,0.25-2.429,1.487c-1.157,0.069-5.111-0.968-5.321,0.68none#000000M13.926,24.917c-0.063,0.106-0.131,0.219-0.071,0.404c0.134,0.032,0.34,0.037,0.475,0\n"
+	"\011\011\011c0.029-0.146-0.005-0.27-0.071-0.404none#000000M32.76,25.834c-0.086,0.009-0.151-0.01-0.235,0.015c-0.311,0.378-0.008,1.089,0.49,0.723\n"
+	"\011\011\011c0.485-0.358-0.164-1.054-0.505-0.904none#000000M13.843,25.5c0.791,0.172,0.657-0.583,0.08-0.845c-0.138,0.038-0.035,0.087-0.08,0.179V25.5\n"
+	"\011\011\011znone#000000M32.676,25.667c-0.491,0.099-0.618,0.548-0.469,0.987c0.265,0.074,0.469,0.005,0.636-0.154\n"
+	"\011\011\011L32.676,25.667zface-eyes03#FFFFFF#000000M28.626,26.084c0.799,0.979,2.592,1.526,3.784,1.587\n"
+	"\011\011\011c1.305,0.067,3.157,0.311,4.266-0.503C41.347,23.736,24.931,21.552,28.626,26.084z#FFFFFF#000000M15.47,23.55c-1.021-0.156-2.092-0.252-2.877,0.067c-0.813,0.331-1.783,1.558-1.209,2.45\n"
+	"\011\011\011c0.614,0.955,2.829,0.828,3.797,0.834c1.268,0.008,2.53-0.149,3.797-0.149c0.812,0,1.67,0.173,1.618-0.896\n"
+	"\011\011\011c-0.086-1.762-2.028-1.89-3.288-2.021C16.777,23.779,16.134,23.652,15.47,23.55znone#000000M15.093,24.584c-0.134,0.412-0.146,1.438,0.585,1.024c0.526-0.297,0.202-1.138-0.418-1.024\n"
+	"\011\011\011H15.093znone#000000M32.907,26.238c0.607-0.166,0.486-1.122-0.15-1.094\n"
+	"\011\011\011C32.028,25.176,32.155,26.443,32.907,26.238znone#000000M29.176,20.5c0.332,0.857,2.505,0.178,3.076-0.071c-0.097,0.188-0.104,0.511-0.201,0.709\n"
+	"\011\011\011c1.341,0.136,3.794-1.211,4.875-0.472none#000000M12.509,20.75c0.831-0.572,2.045-0.049,2.729,0.356c1.369,0.81,3.307-0.08,4.922-0.198\n"
+	"\011\011\011c-0.137,0.016-0.271,0.046-0.402,0.091beardsface-beard01#7F2000#000000M40.778,44.911c-0.467-1.23-0.955-2.562-1.993-3.408\n"
+	"\011\011\011c-0.577-0.472-1.183-0.76-1.589-1.406c-0.342-0.543-0.438-1.244-0.918-1.7c-0.323-0.308-0.696-0.226-1.133-0.479\n"
+	"\011\011\011c-1.152-0.67-0.75-2.035-1.402-2.949c-0.467-0.652-1.038-0.471-1.813-0.467c-1.797,0.008-3.4-0.619-3.856-2.584\n"
+	"\011\011\011c-0.894,0.069-0.843,1.203-1.468,1.436c-0.818,0.307-1.448-1.075-1.83-1.743c-0.569-0.995-0.585-2.21-1.875-1.831\n"
+	"\011\011\011c-1.314,0.387-2.109,1.223-3.497,1.161c-1.524-0.068-3.118,0.107-4.574,0.566c-1.01,0.318-2.429,0.524-3.25,1.164\n"
+	"\011\011\011c0.062,0.047,0.13,0.113,0.19,0.164c-0.857,1.008-2.461,1.416-3.496,2.291c-1.007,0.854-2.972,2.129-3.178,3.532\n"
+	"\011\011\011c1.175,0.06,2.364-0.026,3.542,0.021c0.258,0.72-0.672,1.959-0.991,2.558c-0.91,1.71-2.224,3.418-2.869,5.249\n"
+	"\011\011\011c-0.794,2.253,2.432,0.702,3.491,1.283c1.206,0.662-0.418,1.828-0.017,2.978c0.5,1.432,3.064,0.584,4.246,0.702\n"
+	"\011\011\011c-0.063,0.626,0.162,1.375,0.753,1.687c0.377,0.199,0.921,0.142,1.318,0.061c0.301-0.061,1.049-0.624,1.277-0.601\n"
+	"\011\011\011c0.351,0.036,0.34,0.394,0.593,0.642c0.441,0.436,0.947,0.732,1.564,0.837c1.308,0.222,2.359-0.62,3.495-1.069\n"
+	"\011\011\011c0.224,1.009-0.06,3.084,0.988,3.737c0.959,0.601,2.145-1.518,2.944-1.959c1.496-0.827,1.147,0.732,2.305,1.132\n"
+	"\011\011\011c1.605,0.555,3.418-2.768,4.361-3.666c0.366,0.459,0.426,1.252,0.942,1.674c0.653,0.535,1.663,0.42,2.401,0.072\n"
+	"\011\011\011c0.394-0.186,1.26-1.199,1.732-1.087c0.792,0.189,1.096,2.009,1.934,2.45c3.621,1.908,2.853-5.453,2.83-6.924\n"
+	"\011\011\011C41.92,47.04,41.244,46.136,40.778,44.911zface-beard02#3F3000#000000M32.507,30.335c-1.047,0.006-2.021,0.084-3.061-0.085\n"
+	"\011\011\011c-1.049-0.17-2.038-0.589-3.088-0.761c-1.297-0.212-2.672,0.299-4.001,0.178c-0.878-0.081-1.362-0.814-2.09-0.918\n"
+	"\011\011\011c-1.601-0.229-2.149,1.395-2.81,2.397c-0.594,0.899-1.804,1.095-2.796,1.308c-1.4,0.299-4.543,0.402-5.214,1.973\n"
+	"\011\011\011c1.133,0.177-1.133,2.119-1.422,2.449c-0.792,0.901-2.047,2.111-0.583,2.642c0.911,0.329,3.007-0.079,3.639,0.5\n"
+	"\011\011\011c0.096,0.089,0.123,0.767,0.153,0.911c0.156,0.732,0.389,1.462,0.686,2.148c0.959,2.219,3.208,2.926,4.656,4.767\n"
+	"\011\011\011c0.518,0.657,0.612,1.29,0.992,1.952c0.469,0.815,1.263,0.602,2.091,0.629c0.5,1.438,0.501,3.104,0.769,4.576\n"
+	"\011\011\011c0.147,0.81,0.335,1.617,0.499,2.416c0.142,0.695,0.237,2.129,0.727,2.689c0.539,0.619,1.47,0.131,2.273,0.307\n"
+	"\011\011\011c1.154,0.254,1.696,1.748,2.852,1.672c0.959-0.063,0.714-0.746,1.25-1.254c0.449-0.426,1.172-0.226,1.641-0.723\n"
+	"\011\011\011c1.148-1.219-0.066-3.381,0.441-4.793c0.35-0.968,1.766-1.912,2.332-2.799c0.578-0.908,1.049-1.869,1.635-2.771\n"
+	"\011\011\011c0.365-0.563,0.64-1.465,1.354-1.584c0.487-0.08,1.166,0.282,1.661,0.328c0.699,0.064,1.423-0.008,2.06-0.32\n"
+	"\011\011\011c1.104-0.543,1.201-1.256,1.197-2.433c-0.002-0.827-0.646-1.92-0.512-2.665c0.18-0.994,1.221-1.956,1.516-3.015\n"
+	"\011\011\011c0.639-2.292,0.483-4.726-1.248-6.38C37.978,31.646,35.483,30.316,32.507,30.335zface-beard03#5F2500#000000M11.964,29.164c-1.279-1.582-5.529-4.817-7.155-1.857\n"
+	"\011\011\011c-0.698,1.271-0.482,3.148-0.247,4.513c0.508,2.951-0.02,6.193,0.802,9.07c0.383,1.343,1.034,2.821,1.857,3.968\n"
+	"\011\011\011c1.24,1.727,1.501,2.753,1.497,5.033c-0.006,2.777-0.181,5.806,2.369,7.467c2.233,1.455,5.04,2.48,7.597,3.159\n"
+	"\011\011\011c3.247,0.862,6.34,0.874,9.189-0.938c1.323-0.845,2.526-1.924,3.967-2.505c1.836-0.741,3.981-0.372,5.759-1.188\n"
+	"\011\011\011c2.051-0.94,3.396-3.101,4.491-4.972c1.492-2.552,2.653-5.25,3.412-8.115c0.64-2.418,0.046-4.733-0.284-7.107\n"
+	"\011\011\011c-0.16-1.15-0.05-7.181-2.625-6.371c-0.031,0.01-0.302-0.01-0.355-0.009c0.263,1.433-1.543,1.677-2.481,2.137\n"
+	"\011\011\011c-1.101,0.539-1.873,1.406-3.159,1.595c-3.043,0.442-4.668-0.996-7.135-2.125c-2.732-1.251-4.009-0.263-6.292,1.243\n"
+	"\011\011\011c-2.461,1.625-3.737,1.817-6.447,0.754C14.659,32.104,13.422,30.969,11.964,29.164znone#000000M282.642,454.793c0.333-0.333,0.667-0.667,1-1none#000000M-290.358,328.793c1.667-1,3.333-2,5-3none#000000M-79.358,462.793c2,0.333,4,0.667,6,1none#000000M-633.358,361.793c0.667,0,1.333,0,2,0Layer_1Layer_6beardseyesface-base01face-base02face-base03face-beard01face-beard02face-beard03face-eyes01face-eyes02face-eyes03faces";
+
+const XML_Blob_String asset_faces_names[24] = {
+	{ 0, 0 },
+	{ 0, 2 },
+	{ 2, 2 },
+	{ 4, 3 },
+	{ 7, 4 },
+	{ 11, 4 },
+	{ 15, 6 },
+	{ 21, 8 },
+	{ 29, 7 },
+	{ 36, 2 },
+	{ 38, 5 },
+	{ 43, 11 },
+	{ 54, 5 },
+	{ 59, 6 },
+	{ 65, 7 },
+	{ 72, 8 },
+	{ 80, 17 },
+	{ 97, 9 },
+	{ 106, 3 },
+	{ 109, 1 },
+	{ 110, 4 },
+	{ 114, 6 },
+	{ 120, 1 },
+	{ 121, 4 },
+};
+
+const XML_Blob_Node asset_faces_nodes[44] = {
+	{ 18, XML_NO_NODE, 1, XML_NO_NODE, 0, 10, 10238, { 8986, 0 } },
+	{ 19, 0, 2, 8, 10, 1, 2151, { 8986, 0 } },
+	{ 19, 1, 3, 4, 11, 1, 728, { 8986, 0 } },
+	{ 23, 2, XML_NO_NODE, XML_NO_NODE, 12, 3, 704, { 8986, 0 } },
+	{ 19, 1, 5, 6, 15, 1, 643, { 8986, 0 } },
+	{ 23, 4, XML_NO_NODE, XML_NO_NODE, 16, 3, 619, { 8986, 0 } },
+	{ 19, 1, 7, XML_NO_NODE, 19, 1, 762, { 8986, 0 } },
+	{ 23, 6, XML_NO_NODE, XML_NO_NODE, 20, 3, 738, { 8986, 0 } },
+	{ 19, 0, 9, 33, 23, 1, 3773, { 8986, 0 } },
+	{ 19, 8, 10, 17, 24, 1, 1234, { 8986, 0 } },
+	{ 23, 9, XML_NO_NODE, 11, 25, 3, 285, { 8986, 0 } },
+	{ 23, 9, XML_NO_NODE, 12, 28, 3, 252, { 8986, 0 } },
+	{ 23, 9, XML_NO_NODE, 13, 31, 3, 140, { 8986, 0 } },
+	{ 23, 9, XML_NO_NODE, 14, 34, 3, 178, { 8986, 0 } },
+	{ 23, 9, XML_NO_NODE, 15, 37, 3, 206, { 8986, 0 } },
+	{ 23, 9, XML_NO_NODE, 16, 40, 3, 129, { 8986, 0 } },
+	{ 19, 9, XML_NO_NODE, XML_NO_NODE, 43, 1, 20, { 8986, 0 } },
+	{ 19, 8, 18, 26, 44, 1, 1361, { 8986, 0 } },
+	{ 23, 17, XML_NO_NODE, 19, 45, 3, 220, { 8986, 0 } },
+	{ 23, 17, XML_NO_NODE, 20, 48, 3, 181, { 8986, 0 } },
+	{ 23, 17, XML_NO_NODE, 21, 51, 3, 170, { 8986, 0 } },
+	{ 23, 17, XML_NO_NODE, 22, 54, 3, 133, { 8986, 0 } },
+	{ 23, 17, XML_NO_NODE, 23, 57, 3, 168, { 8986, 0 } },
+	{ 23, 17, XML_NO_NODE, 24, 60, 3, 172, { 8986, 0 } },
+	{ 23, 17, XML_NO_NODE, 25, 63, 3, 140, { 8986, 0 } },
+	{ 23, 17, XML_NO_NODE, XML_NO_NODE, 66, 3, 153, { 8986, 0 } },
+	{ 19, 8, 27, XML_NO_NODE, 69, 1, 1161, { 8986, 0 } },
+	{ 23, 26, XML_NO_NODE, 28, 70, 3, 183, { 8986, 0 } },
+	{ 23, 26, XML_NO_NODE, 29, 73, 3, 322, { 8986, 0 } },
+	{ 23, 26, XML_NO_NODE, 30, 76, 3, 146, { 8986, 0 } },
+	{ 23, 26, XML_NO_NODE, 31, 79, 3, 143, { 8986, 0 } },
+	{ 23, 26, XML_NO_NODE, 32, 82, 3, 172, { 8986, 0 } },
+	{ 23, 26, XML_NO_NODE, XML_NO_NODE, 85, 3, 171, { 8986, 0 } },
+	{ 19, 0, 34, 40, 88, 1, 3715, { 8986, 0 } },
+	{ 19, 33, 35, 36, 89, 1, 1505, { 8986, 0 } },
+	{ 23, 34, XML_NO_NODE, XML_NO_NODE, 90, 3, 1480, { 8986, 0 } },
+	{ 19, 33, 37, 38, 93, 1, 1316, { 8986, 0 } },
+	{ 23, 36, XML_NO_NODE, XML_NO_NODE, 94, 3, 1291, { 8986, 0 } },
+	{ 19, 33, 39, XML_NO_NODE, 97, 1, 875, { 8986, 0 } },
+	{ 23, 38, XML_NO_NODE, XML_NO_NODE, 98, 3, 850, { 8986, 0 } },
+	{ 23, 0, XML_NO_NODE, 41, 101, 3, 91, { 8986, 0 } },
+	{ 23, 0, XML_NO_NODE, 42, 104, 3, 84, { 8986, 0 } },
+	{ 23, 0, XML_NO_NODE, 43, 107, 3, 83, { 8986, 0 } },
+	{ 23, 0, XML_NO_NODE, XML_NO_NODE, 110, 3, 84, { 8986, 0 } },
+};
+
+// Generated from src/pre/pre_assets.cpp:145
+const uint32_t asset_faces_attribute_keys[113] = {
+	0x00000008, 0x00000009, 0x0000000a, 0x0000000b, 0x0000000c, 0x0000000d, 0x0000000e, 0x0000000f, 
+	0x00000010, 0x00000011, 0x00000009, 0x00000009, 0x00000014, 0x00000015, 0x00000016, 0x00000009, 
+	0x00000014, 0x00000015, 0x00000016, 0x00000009, 0x00000014, 0x00000015, 0x00000016, 0x00000009, 
+	0x00000009, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 
+	0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 
+	0x00000014, 0x00000015, 0x00000016, 0x00000009, 0x00000009, 0x00000014, 0x00000015, 0x00000016, 
+	0x00000014, 0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 0x00000015, 
+	0x00000016, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 
+	0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 0x00000009, 0x00000014, 0x00000015, 
+	0x00000016, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 
+	0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 
+	0x00000009, 0x00000009, 0x00000014, 0x00000015, 0x00000016, 0x00000009, 0x00000014, 0x00000015, 
+	0x00000016, 0x00000009, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 
+	0x00000014, 0x00000015, 0x00000016, 0x00000014, 0x00000015, 0x00000016, 0x00000014, 0x00000015, 
+	0x00000016, 
+};
+
+const XML_Blob_String asset_faces_attribute_values[113] = {
+	{ 125, 3 },
+	{ 128, 7 },
+	{ 135, 26 },
+	{ 161, 28 },
+	{ 189, 6 },
+	{ 195, 6 },
+	{ 201, 17 },
+	{ 218, 7 },
+	{ 225, 21 },
+	{ 246, 8 },
+	{ 254, 5 },
+	{ 259, 11 },
+	{ 270, 7 },
+	{ 277, 7 },
+	{ 284, 654 },
+	{ 938, 11 },
+	{ 949, 7 },
+	{ 956, 7 },
+	{ 963, 569 },
+	{ 1532, 11 },
+	{ 1543, 7 },
+	{ 1550, 7 },
+	{ 1557, 688 },
+	{ 2245, 4 },
+	{ 2249, 11 },
+	{ 2260, 7 },
+	{ 2267, 7 },
+	{ 2274, 235 },
+	{ 2509, 7 },
+	{ 2516, 7 },
+	{ 2523, 202 },
+	{ 2725, 4 },
+	{ 2729, 7 },
+	{ 2736, 93 },
+	{ 2829, 4 },
+	{ 2833, 7 },
+	{ 2840, 131 },
+	{ 2971, 4 },
+	{ 2975, 7 },
+	{ 2982, 159 },
+	{ 3141, 4 },
+	{ 3145, 7 },
+	{ 3152, 82 },
+	{ 3234, 7 },
+	{ 3241, 11 },
+	{ 3252, 7 },
+	{ 3259, 7 },
+	{ 3266, 170 },
+	{ 3436, 7 },
+	{ 3443, 7 },
+	{ 3450, 131 },
+	{ 3581, 4 },
+	{ 3585, 7 },
+	{ 3592, 123 },
+	{ 3715, 4 },
+	{ 3719, 7 },
+	{ 3726, 86 },
+	{ 3812, 4 },
+	{ 3816, 7 },
+	{ 3823, 121 },
+	{ 3944, 4 },
+	{ 3948, 7 },
+	{ 3955, 125 },
+	{ 4080, 4 },
+	{ 4084, 7 },
+	{ 4091, 93 },
+	{ 4184, 4 },
+	{ 4188, 7 },
+	{ 4195, 106 },
+	{ 4301, 11 },
+	{ 4312, 7 },
+	{ 4319, 7 },
+	{ 4326, 133 },
+	{ 4459, 7 },
+	{ 4466, 7 },
+	{ 4473, 272 },
+	{ 4745, 4 },
+	{ 4749, 7 },
+	{ 4756, 99 },
+	{ 4855, 4 },
+	{ 4859, 7 },
+	{ 4866, 96 },
+	{ 4962, 4 },
+	{ 4966, 7 },
+	{ 4973, 125 },
+	{ 5098, 4 },
+	{ 5102, 7 },
+	{ 5109, 124 },
+	{ 5233, 6 },
+	{ 5239, 12 },
+	{ 5251, 7 },
+	{ 5258, 7 },
+	{ 5265, 1430 },
+	{ 6695, 12 },
+	{ 6707, 7 },
+	{ 6714, 7 },
+	{ 6721, 1241 },
+	{ 7962, 12 },
+	{ 7974, 7 },
+	{ 7981, 7 },
+	{ 7988, 800 },
+	{ 8788, 4 },
+	{ 8792, 7 },
+	{ 8799, 44 },
+	{ 8843, 4 },
+	{ 8847, 7 },
+	{ 8854, 37 },
+	{ 8891, 4 },
+	{ 8895, 7 },
+	{ 8902, 36 },
+	{ 8938, 4 },
+	{ 8942, 7 },
+	{ 8949, 37 },
+};
+
+const SVG_Blob_Id asset_faces_ids[14] = {
+	{ { 8986, 7 }, 0 },
+	{ { 8993, 7 }, 16 },
+	{ { 9000, 6 }, 33 },
+	{ { 9006, 4 }, 8 },
+	{ { 9010, 11 }, 2 },
+	{ { 9021, 11 }, 4 },
+	{ { 9032, 11 }, 6 },
+	{ { 9043, 12 }, 34 },
+	{ { 9055, 12 }, 36 },
+	{ { 9067, 12 }, 38 },
+	{ { 9079, 11 }, 9 },
+	{ { 9090, 11 }, 17 },
+	{ { 9101, 11 }, 26 },
+	{ { 9112, 5 }, 1 },
+};
+
+void asset_faces_blob(SVG_Blob *blob)
+{
+	blob->xml.text = asset_faces_text;
+	blob->xml.nodes = asset_faces_nodes;
+	blob->xml.node_count = 44;
+	blob->xml.attribute_keys = asset_faces_attribute_keys;
+	blob->xml.attribute_values = asset_faces_attribute_values;
+	blob->xml.attribute_count = 113;
+	blob->xml.names = asset_faces_names;
+	blob->xml.name_count = 24;
+	blob->ids = asset_faces_ids;
+	blob->id_count = 14;
+}
+
@@ -0,0 +1,364 @@
+// Generated from data/templates/dorf.tmpl:1
+const char tmpl_dorf_text[1016] =
+	" not found with ID #<html><head><title>Dwarves</title></head><body><table><tr><th>Avatar</th><th>Name</th><th>Location</th><th>Activity</th></tr><tr><td><img src=\"/entities//avatar.svg\" width=\"50\" height=\"50\"></td><td><a href=\"/entities/\"></a></td><td><a href=\"/locations/\"></a></td><td></td></tr>\n"
+	"</table></body></html>\n"
+	"<html><head><title>Activity feed</title></head><body><ul>\n"
+	"<li><a href=\"/entities/\"></a>:I will go </li><li><a href=\"/entities/\"></a>:Died suddenly</li>id: \n"
+	"data: \n"
+	"\n"
+	"</ul></body></html>\n"
+	"<html><head><title></title></head><body><h1></h1><img src=\"/entities//avatar.svg\" width=\"200\" height=\"200\"><h2> in <a href=\"/locations/\"></a></h2><h3>Hunger: , sleep: </h3></body></html><svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\" width=\"60\" height=\"60\" overflow=\"hidden\">\n"
+	"</svg>\n"
+	"<html><head><title>Locations</title></head><body><ul>\n"
+	"<li><a href=\"/locations/\"></a></li>\n"
+	"</ul></body></html>\n"
+	"<html><head><title></title></head><body><h1></h1><ul><li><a href=\"/entities/\"></a> ()</li>\n"
+	"</ul></body></html>\n";
+
+// Generated from data/templates/dorf.tmpl:4
+bool tmpl_not_found(Printer *p, const char *what, U32 id)
+{
+	return print_escaped(p, what)
+		&& print(p, to_string(tmpl_dorf_text + 0, 20))
+		&& print_u32(p, id);
+}
+
+// Generated from data/templates/dorf.tmpl:10
+bool tmpl_dwarves_begin(Printer *p)
+{
+	return print(p, to_string(tmpl_dorf_text + 20, 125));
+}
+
+// Generated from data/templates/dorf.tmpl:14
+bool tmpl_dwarves_row(Printer *p, U32 id, const char *name, U32 location_id, const char *location_name, const char *status)
+{
+	return print(p, to_string(tmpl_dorf_text + 145, 28))
+		&& print_u32(p, id)
+		&& print(p, to_string(tmpl_dorf_text + 173, 64))
+		&& print_u32(p, id)
+		&& print(p, to_string(tmpl_dorf_text + 237, 2))
+		&& print_escaped(p, name)
+		&& print(p, to_string(tmpl_dorf_text + 239, 33))
+		&& print_u32(p, location_id)
+		&& print(p, to_string(tmpl_dorf_text + 272, 2))
+		&& print_escaped(p, location_name)
+		&& print(p, to_string(tmpl_dorf_text + 274, 13))
+		&& print_escaped(p, status)
+		&& print(p, to_string(tmpl_dorf_text + 287, 11));
+}
+
+// Generated from data/templates/dorf.tmpl:19
+bool tmpl_dwarves_end(Printer *p)
+{
+	return print(p, to_string(tmpl_dorf_text + 298, 23));
+}
+
+// Generated from data/templates/dorf.tmpl:26
+bool tmpl_feed_begin(Printer *p)
+{
+	return print(p, to_string(tmpl_dorf_text + 321, 58));
+}
+
+// Generated from data/templates/dorf.tmpl:31
+bool tmpl_feed_post_activity(Printer *p, U32 id, const char *name, const char *activity)
+{
+	return print(p, to_string(tmpl_dorf_text + 379, 23))
+		&& print_u32(p, id)
+		&& print(p, to_string(tmpl_dorf_text + 402, 2))
+		&& print_escaped(p, name)
+		&& print(p, to_string(tmpl_dorf_text + 404, 15))
+		&& print_escaped(p, activity)
+		&& print(p, to_string(tmpl_dorf_text + 419, 5));
+}
+
+// Generated from data/templates/dorf.tmpl:35
+bool tmpl_feed_post_death(Printer *p, U32 id, const char *name)
+{
+	return print(p, to_string(tmpl_dorf_text + 424, 23))
+		&& print_u32(p, id)
+		&& print(p, to_string(tmpl_dorf_text + 447, 2))
+		&& print_escaped(p, name)
+		&& print(p, to_string(tmpl_dorf_text + 449, 23));
+}
+
+// Generated from data/templates/dorf.tmpl:41
+bool tmpl_feed_event(Printer *p, U64 sequence, String post)
+{
+	return print(p, to_string(tmpl_dorf_text + 472, 4))
+		&& print_u64(p, sequence)
+		&& print(p, to_string(tmpl_dorf_text + 476, 7))
+		&& print(p, post)
+		&& print(p, to_string(tmpl_dorf_text + 483, 2));
+}
+
+// Generated from data/templates/dorf.tmpl:48
+bool tmpl_feed_end(Printer *p)
+{
+	return print(p, to_string(tmpl_dorf_text + 485, 20));
+}
+
+// Generated from data/templates/dorf.tmpl:55
+bool tmpl_entity(Printer *p, U32 id, const char *name, const char *status, U32 location_id, const char *location_name, I32 hunger, I32 sleep)
+{
+	return print(p, to_string(tmpl_dorf_text + 505, 19))
+		&& print_escaped(p, name)
+		&& print(p, to_string(tmpl_dorf_text + 524, 25))
+		&& print_escaped(p, name)
+		&& print(p, to_string(tmpl_dorf_text + 549, 25))
+		&& print_u32(p, id)
+		&& print(p, to_string(tmpl_dorf_text + 574, 42))
+		&& print_escaped(p, status)
+		&& print(p, to_string(tmpl_dorf_text + 616, 24))
+		&& print_u32(p, location_id)
+		&& print(p, to_string(tmpl_dorf_text + 640, 2))
+		&& print_escaped(p, location_name)
+		&& print(p, to_string(tmpl_dorf_text + 642, 21))
+		&& print_i32(p, hunger)
+		&& print(p, to_string(tmpl_dorf_text + 663, 9))
+		&& print_i32(p, sleep)
+		&& print(p, to_string(tmpl_dorf_text + 672, 19));
+}
+
+// Generated from data/templates/dorf.tmpl:59
+bool tmpl_avatar_begin(Printer *p)
+{
+	return print(p, to_string(tmpl_dorf_text + 691, 96));
+}
+
+// Generated from data/templates/dorf.tmpl:64
+bool tmpl_avatar_end(Printer *p)
+{
+	return print(p, to_string(tmpl_dorf_text + 787, 7));
+}
+
+// Generated from data/templates/dorf.tmpl:71
+bool tmpl_locations_begin(Printer *p)
+{
+	return print(p, to_string(tmpl_dorf_text + 794, 54));
+}
+
+// Generated from data/templates/dorf.tmpl:76
+bool tmpl_locations_row(Printer *p, U32 id, const char *name)
+{
+	return print(p, to_string(tmpl_dorf_text + 848, 24))
+		&& print_u32(p, id)
+		&& print(p, to_string(tmpl_dorf_text + 872, 2))
+		&& print_escaped(p, name)
+		&& print(p, to_string(tmpl_dorf_text + 874, 10));
+}
+
+// Generated from data/templates/dorf.tmpl:81
+bool tmpl_locations_end(Printer *p)
+{
+	return print(p, to_string(tmpl_dorf_text + 884, 20));
+}
+
+// Generated from data/templates/dorf.tmpl:88
+bool tmpl_location_begin(Printer *p, const char *name)
+{
+	return print(p, to_string(tmpl_dorf_text + 904, 19))
+		&& print_escaped(p, name)
+		&& print(p, to_string(tmpl_dorf_text + 923, 25))
+		&& print_escaped(p, name)
+		&& print(p, to_string(tmpl_dorf_text + 948, 9));
+}
+
+// Generated from data/templates/dorf.tmpl:92
+bool tmpl_location_dwarf(Printer *p, U32 id, const char *name, const char *status)
+{
+	return print(p, to_string(tmpl_dorf_text + 957, 23))
+		&& print_u32(p, id)
+		&& print(p, to_string(tmpl_dorf_text + 980, 2))
+		&& print_escaped(p, name)
+		&& print(p, to_string(tmpl_dorf_text + 982, 6))
+		&& print_escaped(p, status)
+		&& print(p, to_string(tmpl_dorf_text + 988, 7));
+}
+
+// Generated from data/templates/dorf.tmpl:97
+bool tmpl_location_end(Printer *p)
+{
+	return print(p, to_string(tmpl_dorf_text + 995, 20));
+}
+
+// Generated from data/templates/server.tmpl:1
+const char tmpl_server_text[913] =
+	"<html><head><title>Server stats</title></head><body><h5>Active thread count</h5><svg width=\"400\" height=\"200\">\n"
+	"<path d=\"M30  L400 \" stroke=\"#ddd\" stroke-width=\"1\" fill=\"none\" />\n"
+	"<text x=\"25\" y=\"\" text-anchor=\"end\" fill=\"gray\"></text><path d=\" \" stroke=\"black\" stroke-width=\"2\" fill=\"none\" />\n"
+	"</svg><h5>Memory by tag</h5><table><tr><th>Tag</th><th>Live</th><th>Peak</th><th>Allocated</th><th>Allocations</th><th>Total allocations</th></tr><tr><td></td><td>kB</td><td>kB</td><td>kB/s</td><td>/s</td><td></td></tr></table></body></html><html><head><title></title></head><body><table><a href=\"allocations/\"><tr><td>:</td><td><a href=\"allocations/\"><pre>[]</pre></a></td><td>kB</td></tr></table></body></html><html><head><title>Server allocations</title></head><body><h2>[] (kB)</h2><h3> <a href=\"/allocations/\">[] (kB)</a></h3><h3>Reallocated</h3><h4></h4><table>\n"
+	"<tr><td>:</td><td></td></tr>\n"
+	"</table>\n"
+	"</body></html>";
+
+// Generated from data/templates/server.tmpl:6
+bool tmpl_stats_begin(Printer *p)
+{
+	return print(p, to_string(tmpl_server_text + 0, 111));
+}
+
+// Generated from data/templates/server.tmpl:11
+bool tmpl_stats_ruler(Printer *p, float y, float text_y, U32 value)
+{
+	return print(p, to_string(tmpl_server_text + 111, 13))
+		&& print_f32(p, y)
+		&& print(p, to_string(tmpl_server_text + 124, 6))
+		&& print_f32(p, y)
+		&& print(p, to_string(tmpl_server_text + 130, 64))
+		&& print_f32(p, text_y)
+		&& print(p, to_string(tmpl_server_text + 194, 32))
+		&& print_u32(p, value)
+		&& print(p, to_string(tmpl_server_text + 226, 7));
+}
+
+// Generated from data/templates/server.tmpl:16
+bool tmpl_stats_graph_begin(Printer *p)
+{
+	return print(p, to_string(tmpl_server_text + 233, 9));
+}
+
+// Generated from data/templates/server.tmpl:20
+bool tmpl_stats_graph_point(Printer *p, char command, float x, float y)
+{
+	return print(p, command)
+		&& print_f32(p, x)
+		&& print(p, to_string(tmpl_server_text + 242, 1))
+		&& print_f32(p, y);
+}
+
+// Generated from data/templates/server.tmpl:24
+bool tmpl_stats_graph_end(Printer *p)
+{
+	return print(p, to_string(tmpl_server_text + 243, 55));
+}
+
+// Generated from data/templates/server.tmpl:29
+bool tmpl_stats_memory_begin(Printer *p)
+{
+	return print(p, to_string(tmpl_server_text + 298, 140));
+}
+
+// Generated from data/templates/server.tmpl:33
+bool tmpl_stats_memory_row(Printer *p, const char *tag, double live_kilobytes, double peak_kilobytes, double kilobytes_per_second, double allocations_per_second, U64 allocation_count)
+{
+	return print(p, to_string(tmpl_server_text + 438, 8))
+		&& print_escaped(p, tag)
+		&& print(p, to_string(tmpl_server_text + 446, 9))
+		&& print_f64_fixed(p, live_kilobytes, 2)
+		&& print(p, to_string(tmpl_server_text + 455, 11))
+		&& print_f64_fixed(p, peak_kilobytes, 2)
+		&& print(p, to_string(tmpl_server_text + 466, 11))
+		&& print_f64_fixed(p, kilobytes_per_second, 2)
+		&& print(p, to_string(tmpl_server_text + 477, 13))
+		&& print_f64_fixed(p, allocations_per_second, 2)
+		&& print(p, to_string(tmpl_server_text + 490, 11))
+		&& print_u64(p, allocation_count)
+		&& print(p, to_string(tmpl_server_text + 501, 10));
+}
+
+// Generated from data/templates/server.tmpl:37
+bool tmpl_stats_memory_end(Printer *p)
+{
+	return print(p, to_string(tmpl_server_text + 511, 22));
+}
+
+// Generated from data/templates/server.tmpl:43
+bool tmpl_heap_begin(Printer *p, const char *title)
+{
+	return print(p, to_string(tmpl_server_text + 533, 19))
+		&& print_escaped(p, title)
+		&& print(p, to_string(tmpl_server_text + 552, 28));
+}
+
+// Generated from data/templates/server.tmpl:47
+bool tmpl_heap_row(Printer *p, U64 serial, const char *file, U32 line, const char *type, U32 count, double kilobytes)
+{
+	return print(p, to_string(tmpl_server_text + 580, 21))
+		&& print_u64(p, serial)
+		&& print(p, to_string(tmpl_server_text + 601, 10))
+		&& print_escaped(p, file)
+		&& print(p, to_string(tmpl_server_text + 611, 1))
+		&& print_u32(p, line)
+		&& print(p, to_string(tmpl_server_text + 612, 30))
+		&& print_u64(p, serial)
+		&& print(p, to_string(tmpl_server_text + 642, 7))
+		&& print_escaped(p, type)
+		&& print(p, to_string(tmpl_server_text + 649, 1))
+		&& print_u32(p, count)
+		&& print(p, to_string(tmpl_server_text + 650, 20))
+		&& print_f64_fixed(p, kilobytes, 2)
+		&& print(p, to_string(tmpl_server_text + 670, 12));
+}
+
+// Generated from data/templates/server.tmpl:51
+bool tmpl_heap_end(Printer *p)
+{
+	return print(p, to_string(tmpl_server_text + 682, 22));
+}
+
+// Generated from data/templates/server.tmpl:55
+bool tmpl_allocation_begin(Printer *p, const char *type, U32 count, double kilobytes)
+{
+	return print(p, to_string(tmpl_server_text + 704, 62))
+		&& print_escaped(p, type)
+		&& print(p, to_string(tmpl_server_text + 766, 1))
+		&& print_u32(p, count)
+		&& print(p, to_string(tmpl_server_text + 767, 3))
+		&& print_f64_fixed(p, kilobytes, 2)
+		&& print(p, to_string(tmpl_server_text + 770, 8));
+}
+
+// Generated from data/templates/server.tmpl:59
+bool tmpl_allocation_link(Printer *p, const char *what, U64 serial, const char *type, U32 count, double kilobytes)
+{
+	return print(p, to_string(tmpl_server_text + 778, 4))
+		&& print_escaped(p, what)
+		&& print(p, to_string(tmpl_server_text + 782, 23))
+		&& print_u64(p, serial)
+		&& print(p, to_string(tmpl_server_text + 805, 2))
+		&& print_escaped(p, type)
+		&& print(p, to_string(tmpl_server_text + 807, 1))
+		&& print_u32(p, count)
+		&& print(p, to_string(tmpl_server_text + 808, 3))
+		&& print_f64_fixed(p, kilobytes, 2)
+		&& print(p, to_string(tmpl_server_text + 811, 12));
+}
+
+// Generated from data/templates/server.tmpl:63
+bool tmpl_allocation_reallocated(Printer *p)
+{
+	return print(p, to_string(tmpl_server_text + 823, 20));
+}
+
+// Generated from data/templates/server.tmpl:67
+bool tmpl_allocation_trace_begin(Printer *p, const char *title)
+{
+	return print(p, to_string(tmpl_server_text + 843, 4))
+		&& print_escaped(p, title)
+		&& print(p, to_string(tmpl_server_text + 847, 13));
+}
+
+// Generated from data/templates/server.tmpl:72
+bool tmpl_allocation_trace_row(Printer *p, const char *filename, I32 line, const char *function)
+{
+	return print(p, to_string(tmpl_server_text + 860, 8))
+		&& print_escaped(p, filename)
+		&& print(p, to_string(tmpl_server_text + 868, 1))
+		&& print_i32(p, line)
+		&& print(p, to_string(tmpl_server_text + 869, 9))
+		&& print_escaped(p, function)
+		&& print(p, to_string(tmpl_server_text + 878, 11));
+}
+
+// Generated from data/templates/server.tmpl:77
+bool tmpl_allocation_trace_end(Printer *p)
+{
+	return print(p, to_string(tmpl_server_text + 889, 9));
+}
+
+// Generated from data/templates/server.tmpl:82
+bool tmpl_allocation_end(Printer *p)
+{
+	return print(p, to_string(tmpl_server_text + 898, 14));
+}
+
@@ -0,0 +1,191 @@
+
+// Sampling allocation profiler for release builds. Every thread counts down the
+// bytes it allocates through M_ALLOC and records the call stack of the
+// allocation that crosses zero, after which the countdown restarts from a
+// random distance with a mean of ALLOC_PROFILE_SAMPLE_BYTES. A sample stands
+// for all the allocations it was picked from, so the sites add up to an
+// unbiased estimate of the allocated bytes while only a tiny fraction of the
+// allocations pay for the stack capture.
+//
+// The samples are aggregated by call stack and type and served in the folded
+// stack format of flame graphs, see `render_alloc_profile`.
+
+#if BUILD_ALLOC_PROFILE
+
+#define ALLOC_PROFILE_SAMPLE_BYTES KB(512)
+#define ALLOC_PROFILE_MAX_DEPTH 16
+
+// Must be a power of two
+#define ALLOC_PROFILE_SITES 4096
+
+struct Alloc_Profile_Site
+{
+	U32 hash;
+	U32 depth;
+	const char *type;
+	void *stack[ALLOC_PROFILE_MAX_DEPTH];
+
+	// Estimated allocations and bytes the samples of the site stand for
+	double count;
+	double bytes;
+};
+
+struct Alloc_Profile
+{
+	bool initialized;
+	os_mutex lock;
+	Alloc_Profile_Site sites[ALLOC_PROFILE_SITES];
+	U32 site_count;
+
+	// Samples that found no free site, shown as one line of their own
+	U64 dropped_samples;
+	double dropped_bytes;
+};
+Alloc_Profile g_alloc_profile;
+
+OS_THREAD_LOCAL I64 g_alloc_profile_countdown;
+OS_THREAD_LOCAL U64 g_alloc_profile_random;
+
+void alloc_profile_init()
+{
+	os_mutex_init(&g_alloc_profile.lock);
+	g_alloc_profile.initialized = true;
+}
+
+// Random distance to the next sample, exponentially distributed
+I64 alloc_profile_next_countdown()
+{
+	U64 x = g_alloc_profile_random;
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	g_alloc_profile_random = x;
+
+	// Uniform in [0, 1)
+	double uniform = (double)((x * 0x2545F4914F6CDD1DULL) >> 11) / (double)(1ULL << 53);
+	return (I64)(-log(1.0 - uniform) * ALLOC_PROFILE_SAMPLE_BYTES) + 1;
+}
+
+U32 alloc_profile_hash(void **stack, U32 depth, const char *type)
+{
+	U64 hash = (U64)(uintptr_t)type;
+	for (U32 i = 0; i < depth; i++) {
+		hash = (hash ^ (U64)(uintptr_t)stack[i]) * 0x100000001B3ULL;
+	}
+	return (U32)(hash ^ (hash >> 32));
+}
+
+// Records the allocation that took the countdown below zero. Not inlined so the
+// stack trace always starts with this function, which is skipped.
+NOINLINE void alloc_profile_sample(size_t size, const char *type)
+{
+	if (!g_alloc_profile_random) {
+		// First allocation of the thread, start from a random point
+		g_alloc_profile_random = (U64)(uintptr_t)&g_alloc_profile_countdown | 1;
+		g_alloc_profile_countdown = alloc_profile_next_countdown();
+		return;
+	}
+
+	g_alloc_profile_countdown = alloc_profile_next_countdown();
+	if (!g_alloc_profile.initialized)
+		return;
+
+	void *trace[ALLOC_PROFILE_MAX_DEPTH + 1];
+	U32 trace_length = (U32)os_capture_stack_trace(trace, Count(trace));
+	if (trace_length <= 1)
+		return;
+	void **stack = trace + 1;
+	U32 depth = trace_length - 1;
+
+	// An allocation of `size` bytes is sampled with this probability
+	double probability = 1.0 - exp(-(double)size / ALLOC_PROFILE_SAMPLE_BYTES);
+	double weight = probability > 0.0 ? 1.0 / probability : 1.0;
+
+	U32 hash = alloc_profile_hash(stack, depth, type);
+	U32 mask = ALLOC_PROFILE_SITES - 1;
+
+	os_mutex_lock(&g_alloc_profile.lock);
+
+	Alloc_Profile_Site *site = 0;
+	for (U32 index = hash & mask;; index = (index + 1) & mask) {
+		Alloc_Profile_Site *slot = &g_alloc_profile.sites[index];
+		if (slot->depth == 0) {
+			// Keep some room so the probes stay short
+			if (g_alloc_profile.site_count >= ALLOC_PROFILE_SITES * 3 / 4)
+				break;
+			slot->hash = hash;
+			slot->depth = depth;
+			slot->type = type;
+			memcpy(slot->stack, stack, depth * sizeof(void*));
+			g_alloc_profile.site_count++;
+			site = slot;
+			break;
+		}
+		if (slot->hash == hash && slot->depth == depth && slot->type == type
+			&& !memcmp(slot->stack, stack, depth * sizeof(void*))) {
+			site = slot;
+			break;
+		}
+	}
+
+	if (site) {
+		site->count += weight;
+		site->bytes += weight * (double)size;
+	} else {
+		g_alloc_profile.dropped_samples++;
+		g_alloc_profile.dropped_bytes += weight * (double)size;
+	}
+
+	os_mutex_unlock(&g_alloc_profile.lock);
+}
+
+inline void alloc_profile_count(size_t size, const char *type)
+{
+	g_alloc_profile_countdown -= (I64)size;
+	if (g_alloc_profile_countdown < 0)
+		alloc_profile_sample(size, type);
+}
+
+inline void *alloc_profile_malloc(size_t size, const char *type, Mem_Tag tag)
+{
+	alloc_profile_count(size, type);
+	return mem_tag_malloc(size, tag);
+}
+
+inline void *alloc_profile_calloc(size_t size, const char *type, Mem_Tag tag)
+{
+	alloc_profile_count(size, type);
+	return mem_tag_calloc(size, tag);
+}
+
+inline void *alloc_profile_realloc(void *ptr, size_t size, const char *type)
+{
+	alloc_profile_count(size, type);
+	return mem_tag_realloc(ptr, size);
+}
+
+inline void alloc_profile_free(void *ptr)
+{
+	mem_tag_free(ptr);
+}
+
+// Copies the profile so it can be symbolized without holding the lock, returns
+// the number of sites. `sites` must have room for ALLOC_PROFILE_SITES.
+U32 alloc_profile_copy_sites(Alloc_Profile_Site *sites, U64 *dropped_samples, double *dropped_bytes)
+{
+	os_mutex_lock(&g_alloc_profile.lock);
+
+	U32 count = 0;
+	for (U32 i = 0; i < ALLOC_PROFILE_SITES; i++) {
+		if (g_alloc_profile.sites[i].depth > 0)
+			sites[count++] = g_alloc_profile.sites[i];
+	}
+	*dropped_samples = g_alloc_profile.dropped_samples;
+	*dropped_bytes = g_alloc_profile.dropped_bytes;
+
+	os_mutex_unlock(&g_alloc_profile.lock);
+
+	return count;
+}
+
+#endif
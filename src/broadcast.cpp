@@ -0,0 +1,76 @@
+
+#define BROADCAST_MAX_MESSAGES 128
+
+// Fans out published messages to any number of waiting subscribers. Every
+// message is a fragment rendered once by the publisher, subscribers retain
+// the fragments and send them without holding the lock. Subscribers that fall
+// behind by more than `BROADCAST_MAX_MESSAGES` skip the oldest messages.
+struct Broadcast
+{
+	os_mutex lock;
+	os_cond cond;
+
+	// Sequence number of the latest message, message `n` is stored at
+	// `messages[n % BROADCAST_MAX_MESSAGES]`.
+	U64 sequence;
+	Fragment *messages[BROADCAST_MAX_MESSAGES];
+};
+
+void broadcast_init(Broadcast *broadcast)
+{
+	os_mutex_init(&broadcast->lock);
+	os_cond_init(&broadcast->cond);
+	broadcast->sequence = 0;
+	memset(broadcast->messages, 0, sizeof(broadcast->messages));
+}
+
+// Publish `message` as `sequence`, which must be larger than the previous one.
+// Takes ownership of the reference to `message`.
+void broadcast_publish(Broadcast *broadcast, U64 sequence, Fragment *message)
+{
+	os_mutex_lock(&broadcast->lock);
+
+	assert(sequence > broadcast->sequence);
+	broadcast->sequence = sequence;
+	fragment_replace(&broadcast->messages[sequence % BROADCAST_MAX_MESSAGES], message);
+
+	os_cond_broadcast(&broadcast->cond);
+	os_mutex_unlock(&broadcast->lock);
+}
+
+U64 broadcast_sequence(Broadcast *broadcast)
+{
+	os_mutex_lock(&broadcast->lock);
+	U64 sequence = broadcast->sequence;
+	os_mutex_unlock(&broadcast->lock);
+	return sequence;
+}
+
+// Waits for the messages after `*sequence` and adds them to `list`, updates
+// `*sequence` to the last returned message. Returns the number of messages,
+// which is zero if nothing was published within the timeout.
+U32 broadcast_wait(Broadcast *broadcast, U64 *sequence, Fragment_List *list, int timeout_seconds)
+{
+	os_mutex_lock(&broadcast->lock);
+
+	if (broadcast->sequence <= *sequence) {
+		os_cond_wait(&broadcast->cond, &broadcast->lock, timeout_seconds);
+	}
+
+	U64 latest = broadcast->sequence;
+	U64 first = *sequence + 1;
+	if (latest >= BROADCAST_MAX_MESSAGES && first <= latest - BROADCAST_MAX_MESSAGES)
+		first = latest - BROADCAST_MAX_MESSAGES + 1;
+
+	U32 count = 0;
+	for (U64 seq = first; seq <= latest; seq++) {
+		Fragment *message = broadcast->messages[seq % BROADCAST_MAX_MESSAGES];
+		if (!message || !fragment_list_push(list, message))
+			break;
+		*sequence = seq;
+		count++;
+	}
+
+	os_mutex_unlock(&broadcast->lock);
+	return count;
+}
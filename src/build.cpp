@@ -1,24 +1,44 @@
 
 #include "prelude.h"
 
+// Release builds sample allocations for the allocation profile, define
+// BUILD_NO_ALLOC_PROFILE to leave it out
+#if !defined(BUILD_DEBUG) && !defined(BUILD_NO_ALLOC_PROFILE)
+#define BUILD_ALLOC_PROFILE 1
+#endif
+
+// Count the memory used by every subsystem, see mem_tags.cpp
+#define BUILD_MEM_TAGS 1
+
 #include "platform_shared.cpp"
 #ifdef _WIN32
 #include "platform_windows.cpp"
 #else
 #include "platform_linux.cpp"
+#include "platform_linux_symbols.cpp"
 #endif
+#include "thread_shard.cpp"
 
 #include "../gen/pre_output.cpp"
 #include "source_loc.cpp"
+#include "mem_tags.cpp"
+#include "alloc_profile.cpp"
 #include "debug_alloc.cpp"
 #include "strings.cpp"
 #include "utf.cpp"
 #include "memory.cpp"
+#include "reserved_memory.cpp"
+#include "pool.cpp"
 #include "string_table.cpp"
+#include "concurrent_string_table.cpp"
 #include "scanner.cpp"
 #include "printer.cpp"
+#include "../gen/pre_templates.cpp"
+#include "fragment.cpp"
+#include "broadcast.cpp"
 #include "xml.cpp"
 #include "svg.cpp"
+#include "../gen/pre_assets.cpp"
 #include "gzip/compress_search.cpp"
 #include "gzip/deflate.cpp"
 #include "random.cpp"
@@ -0,0 +1,221 @@
+
+// String table that can be shared between threads. The table is split into
+// shards by the top bits of the hash, each with its own lock for insertion.
+// Lookups don't take any locks: entries are published into the slots with a
+// release store and never move or get removed, and when a shard grows the old
+// slot array is kept alive until the table is freed, so a reader can always
+// finish probing whichever array it loaded. Interned strings from any thread
+// are pointer-comparable.
+
+// Handle to a string in a `Concurrent_String_Table`, unlike `Intern_Id` it
+// doesn't need the table to be resolved. Equal strings have equal pointers.
+struct Interned_String
+{
+	String string;
+#ifdef BUILD_DEBUG
+	void *debug_table_id;
+#endif
+};
+
+bool operator==(Interned_String a, Interned_String b) {
+#if BUILD_DEBUG
+	assert(a.debug_table_id == b.debug_table_id);
+#endif
+	return a.string.data == b.string.data;
+}
+
+bool operator!=(Interned_String a, Interned_String b) {
+	return !(a == b);
+}
+
+#define CONCURRENT_STRING_TABLE_SHARD_BITS 4
+#define CONCURRENT_STRING_TABLE_SHARDS (1 << CONCURRENT_STRING_TABLE_SHARD_BITS)
+
+struct Concurrent_String_Entry
+{
+	U32 hash;
+	U32 length;
+};
+
+inline char *concurrent_string_entry_data(Concurrent_String_Entry *entry)
+{
+	return (char*)(entry + 1);
+}
+
+struct Concurrent_String_Slots
+{
+	size_t size;
+
+	// Previous slot array of the shard that readers might still be using
+	Concurrent_String_Slots *retired;
+};
+
+inline Concurrent_String_Entry *volatile *concurrent_string_slots(Concurrent_String_Slots *slots)
+{
+	return (Concurrent_String_Entry *volatile *)(slots + 1);
+}
+
+struct CACHE_ALIGNED Concurrent_String_Shard
+{
+	os_mutex lock;
+	Concurrent_String_Slots *volatile slots;
+	size_t count;
+	Push_Allocator alloc;
+};
+
+struct Concurrent_String_Table
+{
+	Concurrent_String_Shard shards[CONCURRENT_STRING_TABLE_SHARDS];
+};
+
+void concurrent_string_table_init(Concurrent_String_Table *table)
+{
+	memset(table, 0, sizeof(Concurrent_String_Table));
+	for (U32 i = 0; i < CONCURRENT_STRING_TABLE_SHARDS; i++) {
+		os_mutex_init(&table->shards[i].lock);
+		table->shards[i].alloc.tag = Mem_Tag_Strings;
+	}
+}
+
+void concurrent_string_table_free(Concurrent_String_Table *table)
+{
+	for (U32 i = 0; i < CONCURRENT_STRING_TABLE_SHARDS; i++) {
+		Concurrent_String_Shard *shard = &table->shards[i];
+		Concurrent_String_Slots *slots = shard->slots;
+		while (slots) {
+			Concurrent_String_Slots *retired = slots->retired;
+			M_FREE(slots);
+			slots = retired;
+		}
+		push_allocator_free(&shard->alloc);
+	}
+}
+
+inline Concurrent_String_Shard *concurrent_string_shard(Concurrent_String_Table *table, U32 hash)
+{
+	return &table->shards[hash >> (32 - CONCURRENT_STRING_TABLE_SHARD_BITS)];
+}
+
+Concurrent_String_Entry *concurrent_string_find(Concurrent_String_Slots *slots, String str, U32 hash)
+{
+	if (!slots)
+		return 0;
+
+	Concurrent_String_Entry *volatile *entries = concurrent_string_slots(slots);
+	size_t mask = slots->size - 1;
+	size_t index = hash & mask;
+
+	for (;;) {
+		Concurrent_String_Entry *entry = (Concurrent_String_Entry*)os_atomic_load_pointer(
+			(void *volatile *)&entries[index]);
+		if (!entry)
+			return 0;
+		if (entry->hash == hash && entry->length == str.length
+			&& !memcmp(concurrent_string_entry_data(entry), str.data, str.length))
+			return entry;
+		index = (index + 1) & mask;
+	}
+}
+
+void concurrent_string_place(Concurrent_String_Slots *slots, Concurrent_String_Entry *entry)
+{
+	Concurrent_String_Entry *volatile *entries = concurrent_string_slots(slots);
+	size_t mask = slots->size - 1;
+	size_t index = entry->hash & mask;
+	while (entries[index])
+		index = (index + 1) & mask;
+	os_atomic_store_pointer((void *volatile *)&entries[index], entry);
+}
+
+// Must be called with the shard locked
+void concurrent_string_shard_grow(Concurrent_String_Shard *shard)
+{
+	Concurrent_String_Slots *old_slots = shard->slots;
+	size_t new_size = old_slots ? old_slots->size * 2 : 16;
+
+	Concurrent_String_Slots *new_slots = (Concurrent_String_Slots*)M_ALLOC_RAW_ZERO_TAGGED(
+		sizeof(Concurrent_String_Slots) + new_size * sizeof(Concurrent_String_Entry*), Mem_Tag_Strings);
+	new_slots->size = new_size;
+	new_slots->retired = old_slots;
+
+	if (old_slots) {
+		Concurrent_String_Entry *volatile *old_entries = concurrent_string_slots(old_slots);
+		for (size_t i = 0; i < old_slots->size; i++) {
+			if (old_entries[i])
+				concurrent_string_place(new_slots, old_entries[i]);
+		}
+	}
+
+	// Readers that loaded the old array still find everything that was in it
+	os_atomic_store_pointer((void *volatile *)&shard->slots, new_slots);
+}
+
+inline Interned_String concurrent_interned(Concurrent_String_Table *table, Concurrent_String_Entry *entry)
+{
+	Interned_String result;
+	result.string = to_string(concurrent_string_entry_data(entry), entry->length);
+#ifdef BUILD_DEBUG
+	result.debug_table_id = table;
+#endif
+	return result;
+}
+
+bool intern_if_not_new(Interned_String *result, Concurrent_String_Table *table, String str)
+{
+	if (str.length == 0)
+		return false;
+
+	U32 hash = string_hash(str);
+	Concurrent_String_Shard *shard = concurrent_string_shard(table, hash);
+	Concurrent_String_Slots *slots = (Concurrent_String_Slots*)os_atomic_load_pointer(
+		(void *volatile *)&shard->slots);
+
+	Concurrent_String_Entry *entry = concurrent_string_find(slots, str, hash);
+	if (!entry)
+		return false;
+
+	*result = concurrent_interned(table, entry);
+	return true;
+}
+
+Interned_String intern(Concurrent_String_Table *table, String str)
+{
+	if (str.length == 0) {
+		Interned_String empty;
+		empty.string = empty_string();
+#ifdef BUILD_DEBUG
+		empty.debug_table_id = table;
+#endif
+		return empty;
+	}
+
+	Interned_String result;
+	if (intern_if_not_new(&result, table, str))
+		return result;
+
+	assert(str.length <= UINT32_MAX);
+	U32 hash = string_hash(str);
+	Concurrent_String_Shard *shard = concurrent_string_shard(table, hash);
+
+	os_mutex_lock(&shard->lock);
+
+	// Another thread may have inserted the string after the lookup
+	Concurrent_String_Entry *entry = concurrent_string_find(shard->slots, str, hash);
+	if (!entry) {
+		if (!shard->slots || shard->count >= shard->slots->size * 3 / 4)
+			concurrent_string_shard_grow(shard);
+
+		entry = (Concurrent_String_Entry*)push_allocator_push_aligned(&shard->alloc,
+			sizeof(Concurrent_String_Entry) + str.length, ALIGNOF(Concurrent_String_Entry));
+		entry->hash = hash;
+		entry->length = (U32)str.length;
+		memcpy(concurrent_string_entry_data(entry), str.data, str.length);
+
+		concurrent_string_place(shard->slots, entry);
+		shard->count++;
+	}
+
+	os_mutex_unlock(&shard->lock);
+
+	return concurrent_interned(table, entry);
+}
@@ -5,6 +5,12 @@
 #define DEBUG_ALLOC_ALLOCATED_STATE 0xA1A1A1A1
 #define DEBUG_ALLOC_FREED_STATE 0xAFAFAFAF
 
+// Allocations are tracked in shards so threads don't serialize on one lock.
+// Threads are assigned to shards in turn and an allocation stays in the shard
+// of the thread that allocated it, so only frees from other threads and the
+// heap views touch the lock of another shard.
+#define DEBUG_ALLOC_SHARDS 16
+
 struct Debug_Alloc_Header
 {
 	U32 magic;
@@ -22,149 +28,288 @@ struct Debug_Alloc_Header
 	U64 size;
 	U64 prev_serial, next_serial;
 	U64 serial;
+
+	// Serial of the allocation a chain of reallocations started from
+	U64 first_serial;
+	U32 shard;
+	Mem_Tag tag;
 };
 
 Debug_Alloc_Header g_debug_log_storage[100000];
 
-struct Debug_Memory
+// The serials of a shard are taken with its lock held, so both the live list
+// and the log of a shard are ordered by serial.
+struct CACHE_ALIGNED Debug_Alloc_Shard
 {
 	os_mutex lock;
-	U64 serial;
 	Debug_Alloc_Header root;
+
+	// Ring of the latest allocations of the shard, `log_index` is the newest
 	Debug_Alloc_Header *log;
 	U32 log_index;
+	U32 log_count;
 	U32 log_size;
 };
+
+struct Debug_Memory
+{
+	os_atomic_uint64 serial;
+	Debug_Alloc_Shard shards[DEBUG_ALLOC_SHARDS];
+};
 Debug_Memory g_debug_memory;
 
 void debug_alloc_init()
 {
-	os_mutex_init(&g_debug_memory.lock);
-	g_debug_memory.log = g_debug_log_storage;
-	g_debug_memory.log_size = Count(g_debug_log_storage);
+	U32 log_size = Count(g_debug_log_storage) / DEBUG_ALLOC_SHARDS;
+	for (U32 i = 0; i < DEBUG_ALLOC_SHARDS; i++) {
+		Debug_Alloc_Shard *shard = &g_debug_memory.shards[i];
+		os_mutex_init(&shard->lock);
+		shard->log = g_debug_log_storage + i * log_size;
+		shard->log_size = log_size;
+	}
 }
 
-Debug_Alloc_Header *debug_alloc_lock_heap()
+inline U32 debug_current_shard()
 {
-	os_mutex_lock(&g_debug_memory.lock);
-	return g_debug_memory.root.next;
+	return thread_shard(DEBUG_ALLOC_SHARDS);
 }
 
-void debug_alloc_unlock_heap()
+// Must be called with the shard locked
+void unsafe_debug_shard_insert(Debug_Alloc_Shard *shard, Debug_Alloc_Header *header)
 {
-	os_mutex_unlock(&g_debug_memory.lock);
+	header->serial = os_atomic_increment64(&g_debug_memory.serial);
+	if (!header->first_serial)
+		header->first_serial = header->serial;
+	header->prev = &shard->root;
+	header->next = shard->root.next;
+	if (shard->root.next)
+		shard->root.next->prev = header;
+	shard->root.next = header;
+
+	if (shard->log) {
+		shard->log_index = (shard->log_index + 1) % shard->log_size;
+		shard->log[shard->log_index] = *header;
+		if (shard->log_count < shard->log_size)
+			shard->log_count++;
+	}
 }
 
-struct Debug_Alloc_Snapshot
+// Returns the logged allocation at `index` counting from the oldest one
+inline Debug_Alloc_Header *unsafe_debug_shard_log_at(Debug_Alloc_Shard *shard, U32 index)
+{
+	U32 oldest = (shard->log_index + shard->log_size + 1 - shard->log_count) % shard->log_size;
+	return shard->log + (oldest + index) % shard->log_size;
+}
+
+// Returns the number of logged allocations with a serial less than `serial`
+U32 unsafe_debug_shard_log_rank(Debug_Alloc_Shard *shard, U64 serial)
+{
+	U32 lo = 0, hi = shard->log_count;
+	while (lo < hi) {
+		U32 mid = lo + (hi - lo) / 2;
+		if (unsafe_debug_shard_log_at(shard, mid)->serial < serial)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+Debug_Alloc_Header *unsafe_debug_shard_get_serial(Debug_Alloc_Shard *shard, U64 serial)
+{
+	if (!shard->log || !serial)
+		return 0;
+
+	U32 rank = unsafe_debug_shard_log_rank(shard, serial);
+	if (rank == shard->log_count)
+		return 0;
+
+	Debug_Alloc_Header *header = unsafe_debug_shard_log_at(shard, rank);
+	return header->serial == serial ? header : 0;
+}
+
+// The live allocations of the shards are merged in order of serial, newest
+// first, while all the shards are locked.
+struct Debug_Heap_Iterator
 {
-	Debug_Alloc_Snapshot *prev, *next;
-	Debug_Alloc_Header header;
-	void *pointer;
+	Debug_Alloc_Header *heads[DEBUG_ALLOC_SHARDS];
 };
 
-Debug_Alloc_Snapshot* debug_thread_memory_snapshot(os_thread_id thread_id)
+Debug_Alloc_Header *debug_heap_next(Debug_Heap_Iterator *it)
 {
-	Debug_Alloc_Snapshot *root = 0;
-
-	Debug_Alloc_Header *header = debug_alloc_lock_heap();
-	for (; header; header = header->next) {
-		if (os_thread_id_equal(header->thread_id, thread_id)) {
-			Debug_Alloc_Snapshot *copy = (Debug_Alloc_Snapshot*)malloc(sizeof(Debug_Alloc_Snapshot));
-			copy->header = *header;
-			copy->pointer = header + 1;
-
-			if (root) root->prev = copy;
-			copy->next = root;
-			copy->prev = 0;
-			root = copy;
-		}
+	U32 best = DEBUG_ALLOC_SHARDS;
+	for (U32 i = 0; i < DEBUG_ALLOC_SHARDS; i++) {
+		if (it->heads[i] && (best == DEBUG_ALLOC_SHARDS || it->heads[i]->serial > it->heads[best]->serial))
+			best = i;
 	}
+	if (best == DEBUG_ALLOC_SHARDS)
+		return 0;
 
-	debug_alloc_unlock_heap();
+	Debug_Alloc_Header *header = it->heads[best];
+	it->heads[best] = header->next;
+	return header;
+}
 
-	return root;
+void debug_alloc_lock_heap(Debug_Heap_Iterator *it)
+{
+	for (U32 i = 0; i < DEBUG_ALLOC_SHARDS; i++) {
+		Debug_Alloc_Shard *shard = &g_debug_memory.shards[i];
+		os_mutex_lock(&shard->lock);
+		it->heads[i] = shard->root.next;
+	}
 }
 
-Debug_Alloc_Snapshot *debug_snapshot_new_allocations(Debug_Alloc_Snapshot *begin, Debug_Alloc_Snapshot *end)
+void debug_alloc_unlock_heap()
 {
-	Debug_Alloc_Snapshot *root = 0;
+	for (U32 i = 0; i < DEBUG_ALLOC_SHARDS; i++) {
+		os_mutex_unlock(&g_debug_memory.shards[i].lock);
+	}
+}
 
-	for (Debug_Alloc_Snapshot *e = end; e; e = e->next) {
-		bool found = false;
+// Live allocations of one thread first made after some serial, oldest first
+struct Debug_Alloc_Snapshot
+{
+	Debug_Alloc_Header *allocations;
+	U32 count;
+};
 
-		for (Debug_Alloc_Snapshot *b = begin; b; b = b->next) {
-			if (b->pointer == e->pointer) {
-				found = true;
-				break;
-			}
-		}
+// Allocations made after calling this have a greater serial
+U64 debug_alloc_current_serial()
+{
+	return g_debug_memory.serial;
+}
+
+// Copies the live allocations of the current thread that were first allocated
+// after `serial`. Reallocating an older block gives it a new serial but it keeps
+// its `first_serial`, so it isn't counted. The live list of a shard is ordered
+// newest first and the thread's allocations are all in its own shard, so only
+// the allocations made since `serial` are visited and the shard is locked just
+// for that long.
+Debug_Alloc_Snapshot debug_thread_allocations_since(U64 serial)
+{
+	Debug_Alloc_Snapshot snapshot = { };
+	os_thread_id thread_id = os_current_thread_id();
+
+	Debug_Alloc_Shard *shard = &g_debug_memory.shards[debug_current_shard()];
+	os_mutex_lock(&shard->lock);
 
-		if (!found) {
-			Debug_Alloc_Snapshot *copy = (Debug_Alloc_Snapshot*)malloc(sizeof(Debug_Alloc_Snapshot));
-			*copy = *e;
+	U32 count = 0;
+	for (Debug_Alloc_Header *header = shard->root.next; header && header->serial > serial; header = header->next) {
+		if (os_thread_id_equal(header->thread_id, thread_id) && header->first_serial > serial)
+			count++;
+	}
+
+	if (count > 0)
+		snapshot.allocations = (Debug_Alloc_Header*)malloc(count * sizeof(Debug_Alloc_Header));
 
-			if (root) root->prev = copy;
-			copy->next = root;
-			copy->prev = 0;
-			root = copy;
+	if (snapshot.allocations) {
+		snapshot.count = count;
+		for (Debug_Alloc_Header *header = shard->root.next; count > 0; header = header->next) {
+			if (os_thread_id_equal(header->thread_id, thread_id) && header->first_serial > serial)
+				snapshot.allocations[--count] = *header;
 		}
 	}
 
-	return root;
+	os_mutex_unlock(&shard->lock);
+
+	return snapshot;
 }
 
-Debug_Alloc_Snapshot *debug_thread_memory_snapshot()
+void debug_alloc_snapshot_free(Debug_Alloc_Snapshot *snapshot)
 {
-	return debug_thread_memory_snapshot(os_current_thread_id());
+	free(snapshot->allocations);
+	snapshot->allocations = 0;
+	snapshot->count = 0;
 }
 
-void debug_alloc_snapshot_free(Debug_Alloc_Snapshot *snapshot)
+bool debug_alloc_get_serial(U64 serial, Debug_Alloc_Header *out)
 {
-	while (snapshot) {
-		Debug_Alloc_Snapshot *next = snapshot->next;
-		free(snapshot);
-		snapshot = next;
+	bool found = false;
+	for (U32 i = 0; !found && i < DEBUG_ALLOC_SHARDS; i++) {
+		Debug_Alloc_Shard *shard = &g_debug_memory.shards[i];
+		os_mutex_lock(&shard->lock);
+
+		Debug_Alloc_Header *header = unsafe_debug_shard_get_serial(shard, serial);
+		if (header) {
+			*out = *header;
+			found = true;
+		}
+
+		os_mutex_unlock(&shard->lock);
 	}
+	return found;
 }
 
-Debug_Alloc_Header *unsafe_debug_alloc_get_serial(U64 serial)
+// Copy of the logs of all the shards, walked merged in order of serial newest
+// first by `debug_alloc_log_next`. Each shard is locked once for the copy.
+//
+// The log storage is split evenly between the shards, so a shard only keeps
+// its latest `Count(g_debug_log_storage) / DEBUG_ALLOC_SHARDS` allocations and
+// a busy thread loses its history before the others. The copy starts at the
+// newest of the oldest serials of the full shards so that the merged view
+// covers one window of time with no allocations missing from it.
+struct Debug_Alloc_Log_Snapshot
 {
-	if (!g_debug_memory.log || !serial)
-		return 0;
+	Debug_Alloc_Header *storage;
+	Debug_Alloc_Header *begins[DEBUG_ALLOC_SHARDS];
+	Debug_Alloc_Header *ends[DEBUG_ALLOC_SHARDS];
+};
 
-	I64 diff = (I64)(g_debug_memory.serial - serial);
-	I64 index = (I64)g_debug_memory.log_index - diff;
+bool debug_alloc_log_snapshot(Debug_Alloc_Log_Snapshot *snapshot)
+{
+	snapshot->storage = (Debug_Alloc_Header*)malloc(sizeof(g_debug_log_storage));
+	if (!snapshot->storage)
+		return false;
 
-	if (index < 0) {
-		index += g_debug_memory.log_size;
-	}
+	U64 first_serial = 0;
+	Debug_Alloc_Header *pos = snapshot->storage;
+	for (U32 i = 0; i < DEBUG_ALLOC_SHARDS; i++) {
+		Debug_Alloc_Shard *shard = &g_debug_memory.shards[i];
+		snapshot->begins[i] = pos;
 
-	if (index < 0) {
-		return 0;
+		os_mutex_lock(&shard->lock);
+
+		for (U32 j = 0; j < shard->log_count; j++)
+			*pos++ = *unsafe_debug_shard_log_at(shard, j);
+
+		if (shard->log_count == shard->log_size && shard->log_size > 0)
+			first_serial = max(first_serial, snapshot->begins[i]->serial);
+
+		os_mutex_unlock(&shard->lock);
+
+		snapshot->ends[i] = pos;
 	}
 
-	Debug_Alloc_Header *header = g_debug_memory.log + index;
-	if (header->serial != serial)
-		return 0;
+	for (U32 i = 0; i < DEBUG_ALLOC_SHARDS; i++) {
+		while (snapshot->begins[i] != snapshot->ends[i] && snapshot->begins[i]->serial < first_serial)
+			snapshot->begins[i]++;
+	}
 
-	return header;
+	return true;
 }
 
-bool debug_alloc_get_serial(U64 serial, Debug_Alloc_Header *out)
+Debug_Alloc_Header *debug_alloc_log_next(Debug_Alloc_Log_Snapshot *snapshot)
 {
-	os_mutex_lock(&g_debug_memory.lock);
-
-	Debug_Alloc_Header *header = unsafe_debug_alloc_get_serial(serial);
-	if (header) {
-		*out = *header;
+	U32 best = DEBUG_ALLOC_SHARDS;
+	for (U32 i = 0; i < DEBUG_ALLOC_SHARDS; i++) {
+		if (snapshot->ends[i] == snapshot->begins[i])
+			continue;
+		if (best == DEBUG_ALLOC_SHARDS || snapshot->ends[i][-1].serial > snapshot->ends[best][-1].serial)
+			best = i;
 	}
+	if (best == DEBUG_ALLOC_SHARDS)
+		return 0;
 
-	os_mutex_unlock(&g_debug_memory.lock);
+	return --snapshot->ends[best];
+}
 
-	return header != 0;
+void debug_alloc_log_snapshot_free(Debug_Alloc_Log_Snapshot *snapshot)
+{
+	free(snapshot->storage);
+	snapshot->storage = 0;
 }
 
-void *debug_allocate(size_t size, const char *type, size_t type_size, Source_Loc loc)
+void *debug_allocate(size_t size, const char *type, size_t type_size, Mem_Tag tag, Source_Loc loc)
 {
 	Debug_Alloc_Header *header_and_data = (Debug_Alloc_Header*)
 		malloc(sizeof(Debug_Alloc_Header) + size);
@@ -184,45 +329,44 @@ void *debug_allocate(size_t size, const char *type, size_t type_size, Source_Loc
 	header_and_data->thread_id = os_current_thread_id();
 	header_and_data->prev_serial = 0;
 	header_and_data->next_serial = 0;
+	header_and_data->first_serial = 0;
+	header_and_data->shard = debug_current_shard();
+#if BUILD_MEM_TAGS
+	header_and_data->tag = mem_tag_resolve(tag);
+	mem_tag_count_alloc(header_and_data->tag, size);
+#else
+	header_and_data->tag = tag;
+#endif
 
 	header_and_data->alloc_trace_length = os_capture_stack_trace(
 			header_and_data->alloc_trace,
 			Count(header_and_data->alloc_trace));
 
-	os_mutex_lock(&g_debug_memory.lock);
-
-	header_and_data->serial = ++g_debug_memory.serial;
-	header_and_data->prev = &g_debug_memory.root;
-	header_and_data->next = g_debug_memory.root.next;
-	if (g_debug_memory.root.next)
-		g_debug_memory.root.next->prev = header_and_data;
-	g_debug_memory.root.next = header_and_data;
+	Debug_Alloc_Shard *shard = &g_debug_memory.shards[header_and_data->shard];
+	os_mutex_lock(&shard->lock);
 
-	if (g_debug_memory.log) {
-		g_debug_memory.log_index = (g_debug_memory.log_index + 1) % g_debug_memory.log_size;
-		g_debug_memory.log[g_debug_memory.log_index] = *header_and_data;
-	}
+	unsafe_debug_shard_insert(shard, header_and_data);
 
 #ifdef BREAK_AT_SERIAL
 	if (header_and_data->serial == BREAK_AT_SERIAL)
 		os_debug_break();
 #endif
 
-	os_mutex_unlock(&g_debug_memory.lock);
+	os_mutex_unlock(&shard->lock);
 
 	return header_and_data + 1;
 }
 
-void *debug_allocate_nonzero(size_t size, const char *type, size_t type_size, Source_Loc loc)
+void *debug_allocate_nonzero(size_t size, const char *type, size_t type_size, Mem_Tag tag, Source_Loc loc)
 {
-	void *mem = debug_allocate(size, type, type_size, loc);
+	void *mem = debug_allocate(size, type, type_size, tag, loc);
 	if (mem) memset(mem, 0xAA, size);
 	return mem;
 }
 
-void *debug_allocate_zero(size_t size, const char *type, size_t type_size, Source_Loc loc)
+void *debug_allocate_zero(size_t size, const char *type, size_t type_size, Mem_Tag tag, Source_Loc loc)
 {
-	void *mem = debug_allocate(size, type, type_size, loc);
+	void *mem = debug_allocate(size, type, type_size, tag, loc);
 	if (mem) memset(mem, 0x00, size);
 	return mem;
 }
@@ -233,21 +377,10 @@ Debug_Alloc_Header *debug_get_header(void *ptr) {
 	return header;
 }
 
-void debug_free(void *ptr, Source_Loc loc)
+// Unlinks a live allocation and updates its log entry, must be called with
+// the shard of the allocation locked
+void unsafe_debug_shard_remove(Debug_Alloc_Shard *shard, Debug_Alloc_Header *header, Source_Loc loc)
 {
-	if (!ptr) return;
-
-	Debug_Alloc_Header *header = debug_get_header(ptr);
-
-	memset(ptr, 0xFE, header->size);
-
-	os_mutex_lock(&g_debug_memory.lock);
-
-	if (header->state != DEBUG_ALLOC_ALLOCATED_STATE) {
-		// Double free
-		assert(0);
-	}
-	header->state = DEBUG_ALLOC_FREED_STATE;
 	header->free_loc = loc;
 
 	header->free_trace_length = os_capture_stack_trace(
@@ -261,12 +394,36 @@ void debug_free(void *ptr, Source_Loc loc)
 		header->next->prev = header->prev;
 	}
 
-	Debug_Alloc_Header *logged = unsafe_debug_alloc_get_serial(header->serial);
+	Debug_Alloc_Header *logged = unsafe_debug_shard_get_serial(shard, header->serial);
 	if (logged) {
 		*logged = *header;
 	}
+}
+
+void debug_free(void *ptr, Source_Loc loc)
+{
+	if (!ptr) return;
+
+	Debug_Alloc_Header *header = debug_get_header(ptr);
+
+	memset(ptr, 0xFE, header->size);
+
+	Debug_Alloc_Shard *shard = &g_debug_memory.shards[header->shard];
+	os_mutex_lock(&shard->lock);
+
+	if (header->state != DEBUG_ALLOC_ALLOCATED_STATE) {
+		// Double free
+		assert(0);
+	}
+	header->state = DEBUG_ALLOC_FREED_STATE;
 
-	os_mutex_unlock(&g_debug_memory.lock);
+	unsafe_debug_shard_remove(shard, header, loc);
+
+	os_mutex_unlock(&shard->lock);
+
+#if BUILD_MEM_TAGS
+	mem_tag_count_free(header->tag, (size_t)header->size);
+#endif
 
 	free(header);
 }
@@ -274,48 +431,41 @@ void debug_free(void *ptr, Source_Loc loc)
 void *debug_reallocate(void *ptr, size_t size, const char *type, size_t type_size, Source_Loc loc)
 {
 	if (!ptr) {
-		return debug_allocate(size, type, type_size, loc);
+		return debug_allocate(size, type, type_size, Mem_Tag_Inherit, loc);
 	} else if (!size) {
 		debug_free(ptr, loc);
 		return 0;
 	}
 
-	os_mutex_lock(&g_debug_memory.lock);
-
 	Debug_Alloc_Header *header = debug_get_header(ptr);
+	Debug_Alloc_Shard *old_shard = &g_debug_memory.shards[header->shard];
+
+	os_mutex_lock(&old_shard->lock);
 
 	if (header->state != DEBUG_ALLOC_ALLOCATED_STATE) {
 		// Already freed
 		assert(0);
 	}
 
-	if (header->prev) {
-		header->prev->next = header->next;
-	}
-	if (header->next) {
-		header->next->prev = header->prev;
-	}
-	header->free_loc = loc;
+	unsafe_debug_shard_remove(old_shard, header, loc);
 
-	header->free_trace_length = os_capture_stack_trace(
-			header->free_trace,
-			Count(header->free_trace));
+	os_mutex_unlock(&old_shard->lock);
 
 	U64 old_serial = header->serial;
-	Debug_Alloc_Header *logged = unsafe_debug_alloc_get_serial(old_serial);
-	if (logged) {
-		*logged = *header;
-	}
-
-	os_mutex_unlock(&g_debug_memory.lock);
-
 	size_t old_type_size = header->type_size;
+#if BUILD_MEM_TAGS
+	mem_tag_count_free(header->tag, (size_t)header->size);
+#endif
 	Debug_Alloc_Header *new_header = (Debug_Alloc_Header*)realloc(header, size + sizeof(Debug_Alloc_Header));
 
 	new_header->size = size;
 	new_header->alloc_loc = loc;
 	new_header->thread_id = os_current_thread_id();
 	new_header->prev_serial = old_serial;
+	new_header->shard = debug_current_shard();
+#if BUILD_MEM_TAGS
+	mem_tag_count_alloc(new_header->tag, size);
+#endif
 
 	new_header->alloc_trace_length = os_capture_stack_trace(
 			new_header->alloc_trace,
@@ -323,54 +473,76 @@ void *debug_reallocate(void *ptr, size_t size, const char *type, size_t type_siz
 
 	assert(new_header->type_size == old_type_size);
 
-	os_mutex_lock(&g_debug_memory.lock);
+	Debug_Alloc_Shard *shard = &g_debug_memory.shards[new_header->shard];
+	os_mutex_lock(&shard->lock);
 
-	new_header->serial = ++g_debug_memory.serial;
-	new_header->prev = &g_debug_memory.root;
-	new_header->next = g_debug_memory.root.next;
-	if (g_debug_memory.root.next)
-		g_debug_memory.root.next->prev = new_header;
-	g_debug_memory.root.next = new_header;
-
-	if (g_debug_memory.log) {
-		g_debug_memory.log_index = (g_debug_memory.log_index + 1) % g_debug_memory.log_size;
-		g_debug_memory.log[g_debug_memory.log_index] = *new_header;
-	}
-
-	Debug_Alloc_Header *old_logged = unsafe_debug_alloc_get_serial(old_serial);
-	if (old_logged) {
-		old_logged->next_serial = new_header->serial;
-	}
+	unsafe_debug_shard_insert(shard, new_header);
+	U64 new_serial = new_header->serial;
 
 #ifdef BREAK_AT_SERIAL
-	if (new_header->serial == BREAK_AT_SERIAL)
+	if (new_serial == BREAK_AT_SERIAL)
 		os_debug_break();
 #endif
 
-	os_mutex_unlock(&g_debug_memory.lock);
+	os_mutex_unlock(&shard->lock);
+
+	// Link the log entry of the old allocation to the new one
+	os_mutex_lock(&old_shard->lock);
+	Debug_Alloc_Header *old_logged = unsafe_debug_shard_get_serial(old_shard, old_serial);
+	if (old_logged) {
+		old_logged->next_serial = new_serial;
+	}
+	os_mutex_unlock(&old_shard->lock);
+
 	return new_header + 1;
 }
 
 #endif
 
+// The *_TAGGED variants count the allocation under `tag` instead of the
+// current tag of the thread, see mem_tags.cpp. Reallocations keep their tag.
 #ifdef BUILD_DEBUG
 
-#define M_ALLOC_RAW(size) (debug_allocate_nonzero((size), "void", 1, SOURCE_LOC))
-#define M_ALLOC_RAW_ZERO(size) (debug_allocate_zero((size), "void", 1, SOURCE_LOC))
-#define M_ALLOC(type, count) ((type*)debug_allocate_nonzero(sizeof(type) * (count), #type, sizeof(type), SOURCE_LOC))
-#define M_ALLOC_ZERO(type, count) ((type*)debug_allocate_zero(sizeof(type) * (count), #type, sizeof(type), SOURCE_LOC))
+#define M_ALLOC_RAW_TAGGED(size, tag) (debug_allocate_nonzero((size), "void", 1, (tag), SOURCE_LOC))
+#define M_ALLOC_RAW_ZERO_TAGGED(size, tag) (debug_allocate_zero((size), "void", 1, (tag), SOURCE_LOC))
+#define M_ALLOC_TAGGED(type, count, tag) ((type*)debug_allocate_nonzero(sizeof(type) * (count), #type, sizeof(type), (tag), SOURCE_LOC))
+#define M_ALLOC_ZERO_TAGGED(type, count, tag) ((type*)debug_allocate_zero(sizeof(type) * (count), #type, sizeof(type), (tag), SOURCE_LOC))
 
 #define M_REALLOC_RAW(ptr, size) (debug_reallocate((ptr), (size), "void", 1, SOURCE_LOC))
 #define M_REALLOC(ptr, type, count) ((type*)debug_reallocate((ptr), sizeof(type) * (count), #type, sizeof(type), SOURCE_LOC))
 
 #define M_FREE(ptr) (debug_free((ptr), SOURCE_LOC))
 
+#elif BUILD_ALLOC_PROFILE
+
+#define M_ALLOC_RAW_TAGGED(size, tag) (alloc_profile_malloc((size), "void", (tag)))
+#define M_ALLOC_RAW_ZERO_TAGGED(size, tag) (alloc_profile_calloc((size), "void", (tag)))
+#define M_ALLOC_TAGGED(type, count, tag) ((type*)alloc_profile_malloc(sizeof(type) * (count), #type, (tag)))
+#define M_ALLOC_ZERO_TAGGED(type, count, tag) ((type*)alloc_profile_calloc(sizeof(type) * (count), #type, (tag)))
+
+#define M_REALLOC_RAW(ptr, size) (alloc_profile_realloc((ptr), (size), "void"))
+#define M_REALLOC(ptr, type, count) ((type*)alloc_profile_realloc((ptr), sizeof(type) * (count), #type))
+
+#define M_FREE(ptr) (alloc_profile_free((ptr)))
+
+#elif BUILD_MEM_TAGS
+
+#define M_ALLOC_RAW_TAGGED(size, tag) mem_tag_malloc((size), (tag))
+#define M_ALLOC_RAW_ZERO_TAGGED(size, tag) mem_tag_calloc((size), (tag))
+#define M_ALLOC_TAGGED(type, count, tag) (type*)mem_tag_malloc(sizeof(type) * (count), (tag))
+#define M_ALLOC_ZERO_TAGGED(type, count, tag) (type*)mem_tag_calloc(sizeof(type) * (count), (tag))
+
+#define M_REALLOC_RAW(ptr, size) mem_tag_realloc((ptr), (size))
+#define M_REALLOC(ptr, type, count) (type*)mem_tag_realloc(ptr, sizeof(type) * (count))
+
+#define M_FREE(ptr) mem_tag_free((ptr))
+
 #else
 
-#define M_ALLOC_RAW(size) malloc((size))
-#define M_ALLOC_RAW_ZERO(size) calloc((size), 1)
-#define M_ALLOC(type, count) (type*)malloc(sizeof(type) * (count))
-#define M_ALLOC_ZERO(type, count) (type*)calloc(sizeof(type), (count))
+#define M_ALLOC_RAW_TAGGED(size, tag) malloc((size))
+#define M_ALLOC_RAW_ZERO_TAGGED(size, tag) calloc((size), 1)
+#define M_ALLOC_TAGGED(type, count, tag) (type*)malloc(sizeof(type) * (count))
+#define M_ALLOC_ZERO_TAGGED(type, count, tag) (type*)calloc(sizeof(type), (count))
 
 #define M_REALLOC_RAW(ptr, size) realloc((ptr), (size))
 #define M_REALLOC(ptr, type, count) (type*)realloc(ptr, sizeof(type) * (count))
@@ -379,3 +551,7 @@ void *debug_reallocate(void *ptr, size_t size, const char *type, size_t type_siz
 
 #endif
 
+#define M_ALLOC_RAW(size) M_ALLOC_RAW_TAGGED(size, Mem_Tag_Inherit)
+#define M_ALLOC_RAW_ZERO(size) M_ALLOC_RAW_ZERO_TAGGED(size, Mem_Tag_Inherit)
+#define M_ALLOC(type, count) M_ALLOC_TAGGED(type, count, Mem_Tag_Inherit)
+#define M_ALLOC_ZERO(type, count) M_ALLOC_ZERO_TAGGED(type, count, Mem_Tag_Inherit)
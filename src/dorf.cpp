@@ -25,6 +25,12 @@ struct Dwarf
 	Activity activity;
 	bool alive;
 	U32 seed;
+
+	// Cached HTML fragments of the dwarf for the dwarf and location lists,
+	// `dirty` is set when something shown in them changes.
+	bool dirty;
+	Fragment *row_fragment;
+	Fragment *location_fragment;
 };
 
 struct Location
@@ -56,9 +62,64 @@ struct World
 	U32 post_index;
 	Assets *assets;
 
+	// New posts are published to `feed` if set with `post_count` as the
+	// sequence number.
+	Broadcast *feed;
+	U64 post_count;
+
 	Random_Series random_series;
 };
 
+Dwarf *find_dwarf(World *world, U32 id)
+{
+	for (U32 i = 0; i < Count(world->dwarves); i++) {
+		if (world->dwarves[i].id == id)
+			return &world->dwarves[i];
+	}
+	return 0;
+}
+
+// Renders the post as a single line list item
+bool render_post(World *world, Post *post, Printer *p)
+{
+	Dwarf *dwarf = find_dwarf(world, post->by_id);
+	if (!dwarf)
+		return true;
+
+	switch (post->type) {
+
+	case Post_Activity:
+		return tmpl_feed_post_activity(p, dwarf->id, dwarf->name,
+			activity_infos[post->data].description);
+
+	case Post_Death:
+		return tmpl_feed_post_death(p, dwarf->id, dwarf->name);
+
+	}
+
+	return true;
+}
+
+// Serialize the post as an event once for all the feed subscribers
+void world_publish_post(World *world, Post *post)
+{
+	char post_buffer[KB(1)];
+	Printer post_printer = make_printer(post_buffer, sizeof(post_buffer));
+	if (!render_post(world, post, &post_printer))
+		return;
+	String post_html = to_string(post_buffer, post_printer.pos);
+
+	char buffer[KB(2)];
+	Printer p = make_printer(buffer, sizeof(buffer));
+	if (!tmpl_feed_event(&p, world->post_count, post_html))
+		return;
+
+	Fragment *event = fragment_new(buffer, p.pos - buffer, Mem_Tag_World);
+	if (event) {
+		broadcast_publish(world->feed, world->post_count, event);
+	}
+}
+
 void world_post(World *world, U32 id, Post_Type type, U64 data)
 {
 	world->post_index = (world->post_index + 1) % Count(world->posts);
@@ -66,12 +127,20 @@ void world_post(World *world, U32 id, Post_Type type, U64 data)
 	post->by_id = id;
 	post->type = type;
 	post->data = data;
+
+	world->post_count++;
+	if (world->feed) {
+		world_publish_post(world, post);
+	}
 }
 
 void dwarf_do_activity(World *world, Dwarf *dwarf, Activity activity)
 {
 	Random_Series *rs = &world->random_series;
 
+	if (dwarf->activity != activity)
+		dwarf->dirty = true;
+
 	dwarf->activity = activity;
 	if (activity != Activity_Idle && next_one_in(rs, 100)) {
 		world_post(world, dwarf->id, Post_Activity, activity);
@@ -117,6 +186,7 @@ void world_tick(World *world)
 					Location *new_location = &world->locations[i];
 					if (new_location->id && new_location->has_food) {
 						dwarf->location = new_location->id;
+						dwarf->dirty = true;
 						break;
 					}
 				}
@@ -134,6 +204,7 @@ void world_tick(World *world)
 					Location *new_location = &world->locations[i];
 					if (new_location->id && new_location->has_bed) {
 						dwarf->location = new_location->id;
+						dwarf->dirty = true;
 						break;
 					}
 				}
@@ -150,77 +221,87 @@ void world_tick(World *world)
 		if (next_one_in(rs, 1000) && next_one_in(rs, 1000)) {
 			world_post(world, dwarf->id, Post_Death, 0);
 			dwarf->alive = false;
+			dwarf->dirty = true;
 		}
 	}
 }
 
-int render_dwarves(World *world, char *buffer)
+// Re-render the cached fragments of the dwarf if they are stale
+bool dwarf_update_fragments(World *world, Dwarf *dwarf)
+{
+	if (!dwarf->dirty && dwarf->row_fragment && dwarf->location_fragment)
+		return true;
+
+	Location *location = &world->locations[dwarf->location];
+
+	char buffer[KB(1)];
+	Printer p = make_printer(buffer, sizeof(buffer));
+	if (!tmpl_dwarves_row(&p, dwarf->id, dwarf->name,
+		location->id, location->name, dwarf_status(dwarf)))
+		return false;
+	Fragment *row = fragment_new(buffer, p.pos - buffer, Mem_Tag_World);
+
+	p = make_printer(buffer, sizeof(buffer));
+	if (!tmpl_location_dwarf(&p, dwarf->id, dwarf->name, dwarf_status(dwarf))) {
+		fragment_release(row);
+		return false;
+	}
+	Fragment *location_row = fragment_new(buffer, p.pos - buffer, Mem_Tag_World);
+
+	if (!row || !location_row) {
+		fragment_release(row);
+		fragment_release(location_row);
+		return false;
+	}
+
+	fragment_replace(&dwarf->row_fragment, row);
+	fragment_replace(&dwarf->location_fragment, location_row);
+	dwarf->dirty = false;
+	return true;
+}
+
+// The page is assembled into `list` from the cached dwarf rows and the static
+// parts printed to `p`.
+int render_dwarves(World *world, Printer *p, Fragment_List *list)
 {
-	char *ptr = buffer;
-	ptr += sprintf(ptr, "<html><head><title>Dwarves</title></head>");
-	ptr += sprintf(ptr, "<body><table><tr><th>Avatar</th><th>Name</th>");
-	ptr += sprintf(ptr, "<th>Location</th><th>Activity</th></tr>");
+	char *begin = p->pos;
+	if (!tmpl_dwarves_begin(p)) return 500;
+	fragment_list_push(list, begin, p->pos);
+
 	for (U32 i = 0; i < Count(world->dwarves); i++) {
 		Dwarf *dwarf = &world->dwarves[i];
 		if (dwarf->id == 0)
 			continue;
-		Location *location = &world->locations[dwarf->location];
 
-		ptr += sprintf(ptr, "<tr><td><img src=\"/entities/%d/avatar.svg\" "
-			"width=\"50\" height=\"50\"></td>", dwarf->id);
-		ptr += sprintf(ptr, "<td><a href=\"/entities/%d\">%s</a></td>",
-			dwarf->id, dwarf->name);
-		ptr += sprintf(ptr, "<td><a href=\"/locations/%d\">%s</a></td>",
-			location->id, location->name);
-		ptr += sprintf(ptr, "<td>%s</td></tr>\n",
-			dwarf_status(dwarf));
+		if (!dwarf_update_fragments(world, dwarf)) return 500;
+		if (!fragment_list_push(list, dwarf->row_fragment)) return 500;
 	}
-	ptr += sprintf(ptr, "</table></body></html>\n");
+
+	begin = p->pos;
+	if (!tmpl_dwarves_end(p)) return 500;
+	if (!fragment_list_push(list, begin, p->pos)) return 500;
 
 	return 200;
 }
 
-int render_feed(World *world, char *buffer)
+int render_feed(World *world, Printer *p)
 {
-	char *ptr = buffer;
-	ptr += sprintf(ptr, "<html><head><title>Activity feed</title></head>");
-	ptr += sprintf(ptr, "<body><ul>\n");
+	if (!tmpl_feed_begin(p)) return 500;
 	for (U32 i = 0; i < Count(world->posts); i++) {
 		Post *post = &world->posts[i];
-		if (post->by_id == 0)
-			continue;
-
-		Dwarf *dwarf = 0;
-		for (U32 j = 0; j < Count(world->dwarves); j++) {
-			if (world->dwarves[j].id == post->by_id)
-				dwarf = &world->dwarves[j];
-		}
-		if (!dwarf)
+		if (post->by_id == 0 || !find_dwarf(world, post->by_id))
 			continue;
 
-		ptr += sprintf(ptr, "<li><a href=\"/entities/%d\">%s</a>:", dwarf->id, dwarf->name);
-
-		switch (post->type) {
-
-		case Post_Activity:
-			ptr += sprintf(ptr, "I will go %s", activity_infos[post->data].description);
-			break;
-
-		case Post_Death:
-			ptr += sprintf(ptr, "Died suddenly");
-			break;
-
-		}
-		ptr += sprintf(ptr, "</li>\n");
+		if (!render_post(world, post, p)) return 500;
+		if (!print(p, '\n')) return 500;
 	}
-	ptr += sprintf(ptr, "</ul></body></html>\n");
+	if (!tmpl_feed_end(p)) return 500;
 
 	return 200;
 }
 
-int render_entity(World *world, U32 id, char *buffer)
+int render_entity(World *world, U32 id, Printer *p)
 {
-	char *ptr = buffer;
 	Dwarf *dwarf = 0;
 	for (U32 i = 0; i < Count(world->dwarves); i++) {
 		if (world->dwarves[i].id == id) {
@@ -230,26 +311,20 @@ int render_entity(World *world, U32 id, char *buffer)
 	}
 
 	if (!dwarf) {
-		sprintf(buffer, "Entity not found with ID #%u", id);
+		tmpl_not_found(p, "Entity", id);
 		return 404;
 	}
 
-	ptr += sprintf(ptr, "<html><head><title>%s</title></head>", dwarf->name);
-	ptr += sprintf(ptr, "<body><h1>%s</h1>", dwarf->name);
-	ptr += sprintf(ptr, "<img src=\"/entities/%d/avatar.svg\""
-		"width=\"200\" height=\"200\">", dwarf->id);
 	Location* location = &world->locations[dwarf->location];
-	ptr += sprintf(ptr, "<h2>%s in <a href=\"/locations/%d\">%s</a></h2>",
-		dwarf_status(dwarf), location->id, location->name);
-	ptr += sprintf(ptr, "<h3>Hunger: %d, sleep: %d</h3>", dwarf->hunger, dwarf->sleep);
-	ptr += sprintf(ptr, "</body></html>");
+	if (!tmpl_entity(p, dwarf->id, dwarf->name, dwarf_status(dwarf),
+		location->id, location->name, dwarf->hunger, dwarf->sleep))
+		return 500;
 
 	return 200;
 }
 
-int render_entity_avatar(World *world, U32 id, char *buffer)
+int render_entity_avatar(World *world, U32 id, Printer *p)
 {
-	char *ptr = buffer;
 	Dwarf *dwarf = 0;
 	for (U32 i = 0; i < Count(world->dwarves); i++) {
 		if (world->dwarves[i].id == id) {
@@ -259,16 +334,11 @@ int render_entity_avatar(World *world, U32 id, char *buffer)
 	}
 
 	if (!dwarf) {
-		sprintf(buffer, "Entity not found with ID #%u", id);
+		tmpl_not_found(p, "Entity", id);
 		return 404;
 	}
 
-	ptr += sprintf(ptr, "<svg xmlns=\"http://www.w3.org/2000/svg\" version=\"1.1\""
-		" width=\"60\" height=\"60\" overflow=\"hidden\">\n");
-
-	Printer p;
-	p.pos = ptr;
-	p.end = ptr + 10000;
+	if (!tmpl_avatar_begin(p)) return 500;
 
 	Random_Series series = series_from_seed32(dwarf->seed);
 
@@ -276,44 +346,51 @@ int render_entity_avatar(World *world, U32 id, char *buffer)
 		"base", "beard", "eyes",
 	};
 
+	SVG_XML *faces = &world->assets->faces;
+	U32 nodes[Count(parts)];
+	size_t size = 0;
+
 	for (size_t i = 0; i < Count(parts); i++) {
 		char name[64];
 
 		sprintf(name, "face-%s%02d", parts[i], 1 + next(&series, 3));
-		XML_Node *node = svg_find_by_id(&world->assets->faces, c_string(name));
-
-		if (!print_xml(&p, node))
+		nodes[i] = svg_find_by_id(faces, c_string(name));
+		if (nodes[i] == XML_NO_NODE)
 			return 500;
+		size += xml_node(&faces->xml, nodes[i])->print_size;
 	}
 
-	ptr = p.pos;
+	// Reserve space for all the parts at once and copy them in
+	char *dst = print_reserve(p, size);
+	if (!dst) return 500;
+	for (size_t i = 0; i < Count(parts); i++) {
+		dst = xml_write(dst, &faces->xml, nodes[i]);
+	}
 
-	ptr += sprintf(ptr, "</svg>\n");
+	if (!tmpl_avatar_end(p)) return 500;
 
 	return 200;
 }
 
-int render_locations(World *world, char *buffer)
+int render_locations(World *world, Printer *p)
 {
-	char *ptr = buffer;
-	ptr += sprintf(ptr, "<html><head><title>Locations</title></head>");
-	ptr += sprintf(ptr, "<body><ul>\n");
+	if (!tmpl_locations_begin(p)) return 500;
 	for (U32 i = 0; i < Count(world->locations); i++) {
 		Location *location = &world->locations[i];
 		if (location->id == 0)
 			continue;
 
-		ptr += sprintf(ptr, "<li><a href=\"/locations/%d\">%s</a></li>\n",
-				location->id, location->name);
+		if (!tmpl_locations_row(p, location->id, location->name))
+			return 500;
 	}
-	ptr += sprintf(ptr, "</ul></body></html>\n");
+	if (!tmpl_locations_end(p)) return 500;
 
 	return 200;
 }
 
-int render_location(World *world, U32 id, char *buffer)
+// The page is assembled into `list` like in `render_dwarves()`.
+int render_location(World *world, U32 id, Printer *p, Fragment_List *list)
 {
-	char *ptr = buffer;
 	Location *location = 0;
 	for (U32 i = 0; i < Count(world->locations); i++) {
 		if (world->locations[i].id == id) {
@@ -322,24 +399,27 @@ int render_location(World *world, U32 id, char *buffer)
 		}
 	}
 
+	char *begin = p->pos;
 	if (!location) {
-		sprintf(buffer, "Location not found with ID #%u", id);
+		if (!tmpl_not_found(p, "Location", id)) return 500;
+		if (!fragment_list_push(list, begin, p->pos)) return 500;
 		return 404;
 	}
 
-	ptr += sprintf(ptr, "<html><head><title>%s</title></head><body>", location->name);
-	ptr += sprintf(ptr, "<h1>%s</h1><ul>", location->name);
+	if (!tmpl_location_begin(p, location->name)) return 500;
+	fragment_list_push(list, begin, p->pos);
 
 	for (U32 i = 0; i < Count(world->dwarves); i++) {
 		Dwarf *dwarf = &world->dwarves[i];
 		if (dwarf->id != 0 && dwarf->location == id) {
-			ptr += sprintf(ptr, "<li><a href=\"/entities/%d\">%s</a> (%s)</li>\n",
-				dwarf->id, dwarf->name, dwarf_status(dwarf));
+			if (!dwarf_update_fragments(world, dwarf)) return 500;
+			if (!fragment_list_push(list, dwarf->location_fragment)) return 500;
 		}
 	}
 
-	ptr += sprintf(ptr, "</ul></body></html>\n");
+	begin = p->pos;
+	if (!tmpl_location_end(p)) return 500;
+	if (!fragment_list_push(list, begin, p->pos)) return 500;
 
 	return 200;
 }
-
@@ -0,0 +1,116 @@
+
+// Immutable reference counted piece of rendered output. The owner of a cached
+// fragment holds one reference and replaces the fragment when it goes stale,
+// while response threads retain the fragments they are sending so they can be
+// sent without holding the lock of the owner.
+struct Fragment
+{
+	os_atomic_uint32 ref_count;
+	U32 length;
+};
+
+inline char *fragment_data(Fragment *fragment)
+{
+	return (char*)(fragment + 1);
+}
+
+// Fragments are counted under `tag`, as the cache they belong to may be filled
+// by whichever thread renders it first
+Fragment *fragment_new(const char *data, size_t length, Mem_Tag tag=Mem_Tag_Inherit)
+{
+	assert(length <= UINT32_MAX);
+
+	Fragment *fragment = (Fragment*)M_ALLOC_RAW_TAGGED(sizeof(Fragment) + length, tag);
+	if (!fragment)
+		return 0;
+
+	fragment->ref_count = 1;
+	fragment->length = (U32)length;
+	memcpy(fragment_data(fragment), data, length);
+	return fragment;
+}
+
+inline void fragment_retain(Fragment *fragment)
+{
+	os_atomic_increment(&fragment->ref_count);
+}
+
+inline void fragment_release(Fragment *fragment)
+{
+	if (fragment && os_atomic_decrement(&fragment->ref_count) == 0) {
+		M_FREE(fragment);
+	}
+}
+
+// Replace a cached fragment, the old one is freed once it's no longer sent
+inline void fragment_replace(Fragment **cached, Fragment *fragment)
+{
+	fragment_release(*cached);
+	*cached = fragment;
+}
+
+#define FRAGMENT_LIST_MAX 256
+
+// A page assembled from spans of a response buffer and cached fragments which
+// is sent with a single gathered write.
+struct Fragment_List
+{
+	os_send_buffer buffers[FRAGMENT_LIST_MAX];
+	Fragment *fragments[FRAGMENT_LIST_MAX];
+	U32 buffer_count;
+	U32 fragment_count;
+};
+
+inline void fragment_list_init(Fragment_List *list)
+{
+	list->buffer_count = 0;
+	list->fragment_count = 0;
+}
+
+// Push the text printed since `begin`, the text must stay alive until the list
+// is sent.
+bool fragment_list_push(Fragment_List *list, const char *begin, const char *end)
+{
+	if (begin == end)
+		return true;
+
+	// Extend the previous span if this continues it
+	if (list->buffer_count > 0) {
+		os_send_buffer *last = &list->buffers[list->buffer_count - 1];
+		if (last->data + last->length == begin) {
+			last->length += end - begin;
+			return true;
+		}
+	}
+
+	if (list->buffer_count == FRAGMENT_LIST_MAX)
+		return false;
+
+	os_send_buffer *buffer = &list->buffers[list->buffer_count++];
+	buffer->data = begin;
+	buffer->length = end - begin;
+	return true;
+}
+
+bool fragment_list_push(Fragment_List *list, Fragment *fragment)
+{
+	if (list->buffer_count == FRAGMENT_LIST_MAX)
+		return false;
+
+	fragment_retain(fragment);
+	list->fragments[list->fragment_count++] = fragment;
+
+	os_send_buffer *buffer = &list->buffers[list->buffer_count++];
+	buffer->data = fragment_data(fragment);
+	buffer->length = fragment->length;
+	return true;
+}
+
+void fragment_list_release(Fragment_List *list)
+{
+	for (U32 i = 0; i < list->fragment_count; i++) {
+		fragment_release(list->fragments[i]);
+	}
+	list->fragment_count = 0;
+	list->buffer_count = 0;
+}
@@ -4,6 +4,12 @@
 #include <time.h>
 
 #define DORF_PORT "3500"
+#define BODY_STORAGE_SIZE MB(1)
+// Address space reserved for the scratch memory of every connection. The largest
+// user is /test/ with its two TEST_BUFFER_SIZE buffers, the pages render in a
+// fraction of that.
+#define SCRATCH_RESERVE_SIZE MB(8)
+#define SOCKET_BUFFER_SIZE 1024
 
 os_socket server_socket;
 os_atomic_uint32 active_thread_count;
@@ -14,6 +20,8 @@ struct Server_Stats
 	U32 snapshot_index;
 	long *active_thread_counts;
 	os_mutex lock;
+
+	Mem_Tag_Stats memory;
 };
 
 Server_Stats global_stats;
@@ -135,6 +143,7 @@ void update_to_now(World_Instance *world_instance)
 OS_THREAD_ENTRY(thread_background_world_update, world_instance_ptr)
 {
 	World_Instance *world_instance = (World_Instance*)world_instance_ptr;
+	mem_tag_set_thread(Mem_Tag_World);
 
 	for (;;) {
 		os_mutex_lock(&world_instance->lock);
@@ -153,19 +162,17 @@ OS_THREAD_ENTRY(thread_background_stat_update, server_stats)
 		stats->active_thread_counts[stats->snapshot_index] = active_thread_count;
 
 		stats->snapshot_index = (stats->snapshot_index + 1) % stats->snapshot_count;
+
+		mem_tag_sample(&stats->memory, 1.0);
 		os_mutex_unlock(&stats->lock);
 
 		os_sleep_seconds(1);
 	}
 }
 
-int render_stats(Server_Stats *stats, char *body)
+int render_stats(Server_Stats *stats, Printer *p)
 {
-	char *ptr = body;
-
-	ptr += sprintf(ptr, "<html><head><title>Server stats</title></head><body>");
-	ptr += sprintf(ptr, "<h5>Active thread count</h5>");
-	ptr += sprintf(ptr, "<svg width=\"400\" height=\"200\">\n");
+	if (!tmpl_stats_begin(p)) return 500;
 
 	long max_thread_count = 1;
 	for (U32 i = 0; i < stats->snapshot_count; i++) {
@@ -178,13 +185,11 @@ int render_stats(Server_Stats *stats, char *body)
 	for (long i = 0; i <= ruler_count; i++) {
 		long value = i * ruler_size;
 		float y = 195.0f - (float)value / graph_height * 170.0f;
-		ptr += sprintf(ptr, "<path d=\"M30 %f L400 %f\" stroke=\"#ddd\" stroke-width=\"1\""
-			" fill=\"none\" />\n", y, y);
-		ptr += sprintf(ptr, "<text x=\"25\" y=\"%f\" text-anchor=\"end\" "
-			"fill=\"gray\">%d</text>", y + 4.0f, (int)value);
+		if (!tmpl_stats_ruler(p, y, y + 4.0f, (U32)value))
+			return 500;
 	}
 
-	ptr += sprintf(ptr, "<path d=\"");
+	if (!tmpl_stats_graph_begin(p)) return 500;
 	char command_char = 'M';
 	for (U32 i = 0; i < stats->snapshot_count; i++) {
 		int snapshot_index = (stats->snapshot_index - 1 - i + stats->snapshot_count)
@@ -194,42 +199,85 @@ int render_stats(Server_Stats *stats, char *body)
 		float y = 195.0f - (float)stats->active_thread_counts[snapshot_index]
 			/ graph_height * 170.0f;
 
-		ptr += sprintf(ptr, "%c%f %f ", command_char, x, y);
+		if (!tmpl_stats_graph_point(p, command_char, x, y))
+			return 500;
 		command_char = 'L';
 	}
-	ptr += sprintf(ptr, "\" stroke=\"black\" stroke-width=\"2\" fill=\"none\" />\n");
-	ptr += sprintf(ptr, "</svg>");
+	if (!tmpl_stats_graph_end(p)) return 500;
+
+	if (!tmpl_stats_memory_begin(p)) return 500;
+	for (U32 i = Mem_Tag_Other; i < Mem_Tag_Count; i++) {
+		Mem_Tag_Total *total = &stats->memory.totals[i];
+		if (!tmpl_stats_memory_row(p, mem_tag_names[i],
+			(double)(I64)total->live_bytes / 1000.0,
+			(double)stats->memory.peak_bytes[i] / 1000.0,
+			(double)stats->memory.allocated_per_second[i] / 1000.0,
+			stats->memory.allocations_per_second[i],
+			total->allocation_count))
+			return 500;
+	}
+	if (!tmpl_stats_memory_end(p)) return 500;
 
 	return 200;
 }
 
-int render_heap(char *body)
+#if BUILD_DEBUG
+
+bool render_heap_row(Printer *p, Debug_Alloc_Header *header)
+{
+	return tmpl_heap_row(p,
+		header->serial,
+		header->alloc_loc.file,
+		header->alloc_loc.line,
+		header->type,
+		(U32)header->size / (U32)header->type_size,
+		(double)header->size / 1000.0);
+}
+
+bool render_allocation_trace(Printer *p, const char *title, void **trace, U32 trace_length)
 {
-	char *ptr = body;
+	if (!trace_length)
+		return true;
+
+	os_symbol_info *symbols = os_get_address_infos(trace, (int)trace_length);
+	if (!symbols)
+		return true;
+
+	bool success = tmpl_allocation_trace_begin(p, title);
+	for (U32 i = 0; success && i < trace_length; i++) {
+		if (!symbols[i].filename || !symbols[i].function)
+			continue;
+		success = tmpl_allocation_trace_row(p,
+			symbols[i].filename, symbols[i].line, symbols[i].function);
+	}
+	success = success && tmpl_allocation_trace_end(p);
+
+	os_free_address_infos(symbols);
+	return success;
+}
+
+#endif
 
+int render_heap(Printer *p)
+{
 #if BUILD_DEBUG
 
-	ptr += sprintf(ptr, "<html><head><title>Server heap</title></head><body>");
-	ptr += sprintf(ptr, "<table>");
+	if (!tmpl_heap_begin(p, "Server heap")) return 500;
 
-	Debug_Alloc_Header *header = debug_alloc_lock_heap();
-	for (; header; header = header->next) {
-		ptr += sprintf(ptr, "<a href=\"allocations/%llu\">", header->serial);
-		ptr += sprintf(ptr, "<tr><td>%s:%d</td>"
-				"<td><a href=\"allocations/%llu\"><pre>%s[%d]</pre></a></td>"
-				"<td>%.2fkB</td></tr>",
-				header->alloc_loc.file,
-				header->alloc_loc.line,
-				header->serial,
-				header->type,
-				(U32)header->size / (U32)header->type_size,
-				(double)header->size / 1000.0);
+	bool success = true;
+	Debug_Heap_Iterator it;
+	debug_alloc_lock_heap(&it);
+	while (success) {
+		Debug_Alloc_Header *header = debug_heap_next(&it);
+		if (!header)
+			break;
+		success = render_heap_row(p, header);
 	}
 
 	debug_alloc_unlock_heap();
 
-	ptr += sprintf(ptr, "</table>");
-	ptr += sprintf(ptr, "</body></html>");
+	if (!success) return 500;
+	if (!tmpl_heap_end(p)) return 500;
 
 	return 200;
 #else
@@ -237,35 +285,27 @@ int render_heap(char *body)
 #endif
 }
 
-int render_allocations(char *body)
+int render_allocations(Printer *p)
 {
-	char *ptr = body;
-
 #if BUILD_DEBUG
 
-	ptr += sprintf(ptr, "<html><head><title>Server allocations</title></head><body>");
-	ptr += sprintf(ptr, "<table>");
-
-	Debug_Alloc_Header header;
+	if (!tmpl_heap_begin(p, "Server allocations")) return 500;
 
-	U64 serial = g_debug_memory.serial;
-	for (; debug_alloc_get_serial(serial, &header); serial--) {
+	Debug_Alloc_Log_Snapshot snapshot;
+	if (!debug_alloc_log_snapshot(&snapshot)) return 500;
 
-		ptr += sprintf(ptr, "<a href=\"allocations/%llu\">", header.serial);
-		ptr += sprintf(ptr, "<tr><td>%s:%d</td>"
-				"<td><a href=\"allocations/%llu\"><pre>%s[%d]</pre></a></td>"
-				"<td>%.2fkB</td></tr>",
-				header.alloc_loc.file,
-				header.alloc_loc.line,
-				header.serial,
-				header.type,
-				(U32)header.size / (U32)header.type_size,
-				(double)header.size / 1000.0);
+	bool success = true;
+	while (success) {
+		Debug_Alloc_Header *header = debug_alloc_log_next(&snapshot);
+		if (!header)
+			break;
+		success = render_heap_row(p, header);
 	}
 
+	debug_alloc_log_snapshot_free(&snapshot);
 
-	ptr += sprintf(ptr, "</table>");
-	ptr += sprintf(ptr, "</body></html>");
+	if (!success) return 500;
+	if (!tmpl_heap_end(p)) return 500;
 
 	return 200;
 #else
@@ -273,10 +313,8 @@ int render_allocations(char *body)
 #endif
 }
 
-int render_allocation(char *body, U64 serial)
+int render_allocation(Printer *p, U64 serial)
 {
-	char *ptr = body;
-
 #if BUILD_DEBUG
 
 	Debug_Alloc_Header header;
@@ -284,83 +322,150 @@ int render_allocation(char *body, U64 serial)
 		return 404;
 	}
 
-	ptr += sprintf(ptr, "<html><head><title>Server allocations</title></head><body>");
-
-	ptr += sprintf(ptr, "<h2>%s[%d] (%.2fkB)</h2>",
+	if (!tmpl_allocation_begin(p,
 			header.type,
-			header.size / header.type_size,
-			(double)header.size / 1000.0f);
+			(U32)(header.size / header.type_size),
+			(double)header.size / 1000.0))
+		return 500;
 
 	if (header.next_serial) {
 		Debug_Alloc_Header new_header;
 
+		bool success;
 		if (debug_alloc_get_serial(header.next_serial, &new_header)) {
-			ptr += sprintf(ptr, "<h3>Reallocated as <a href=\"/allocations/%llu\">%s[%d] (%.2fkB)</a></h3>",
+			success = tmpl_allocation_link(p, "Reallocated as",
 					new_header.serial,
 					new_header.type,
-					new_header.size / new_header.type_size,
-					(double)new_header.size / 1000.0f);
+					(U32)(new_header.size / new_header.type_size),
+					(double)new_header.size / 1000.0);
 		} else {
-			ptr += sprintf(ptr, "<h3>Reallocated</h3>");
+			success = tmpl_allocation_reallocated(p);
 		}
+		if (!success) return 500;
 	}
 
 	if (header.prev_serial) {
 		Debug_Alloc_Header new_header;
 
+		bool success;
 		if (debug_alloc_get_serial(header.prev_serial, &new_header)) {
-			ptr += sprintf(ptr, "<h3>Reallocated from <a href=\"/allocations/%llu\">%s[%d] (%.2fkB)</a></h3>",
+			success = tmpl_allocation_link(p, "Reallocated from",
 					new_header.serial,
 					new_header.type,
-					new_header.size / new_header.type_size,
-					(double)new_header.size / 1000.0f);
+					(U32)(new_header.size / new_header.type_size),
+					(double)new_header.size / 1000.0);
 		} else {
-			ptr += sprintf(ptr, "<h3>Reallocated</h3>");
+			success = tmpl_allocation_reallocated(p);
 		}
+		if (!success) return 500;
 	}
 
-	if (header.alloc_trace_length) {
-		os_symbol_info *symbols = os_get_address_infos(header.alloc_trace, (int)header.alloc_trace_length);
-		if (symbols) {
-			ptr += sprintf(ptr, "<h4>Allocation trace</h4><table>\n");
-			for (U32 i = 0; i < header.alloc_trace_length; i++) {
-				if (!symbols[i].filename || !symbols[i].function)
-					continue;
-				ptr += sprintf(ptr, "<tr><td>%s:%d</td><td>%s</td></tr>\n",
-					symbols[i].filename, symbols[i].line, symbols[i].function);
-			}
-			ptr += sprintf(ptr, "</table>\n");
-		}
+	if (!render_allocation_trace(p, "Allocation trace",
+		header.alloc_trace, header.alloc_trace_length))
+		return 500;
+
+	if (!render_allocation_trace(p, "Free trace",
+		header.free_trace, header.free_trace_length))
+		return 500;
+
+	if (!tmpl_allocation_end(p)) return 500;
+
+	return 200;
+#else
+	return 404;
+#endif
+}
+
+#if BUILD_ALLOC_PROFILE
+
+// Frame names can't contain the separators of the folded format
+bool print_folded_frame(Printer *p, const char *name, int length)
+{
+	for (int i = 0; i < length; i++) {
+		char c = name[i];
+		if (!print(p, c == ';' || c == '\n' ? '_' : c))
+			return false;
 	}
+	return true;
+}
 
-	if (header.free_trace_length) {
-		os_symbol_info *symbols = os_get_address_infos(header.free_trace, (int)header.free_trace_length);
-		if (symbols) {
-			ptr += sprintf(ptr, "<h4>Free trace</h4><table>\n");
-			for (U32 i = 0; i < header.free_trace_length; i++) {
-				if (!symbols[i].filename || !symbols[i].function)
-					continue;
-				ptr += sprintf(ptr, "<tr><td>%s:%d</td><td>%s</td></tr>\n",
-					symbols[i].filename, symbols[i].line, symbols[i].function);
-			}
-			ptr += sprintf(ptr, "</table>\n");
+bool render_alloc_profile_site(Printer *p, Alloc_Profile_Site *site)
+{
+	os_symbol_info *symbols = os_get_address_infos(site->stack, (int)site->depth);
+
+	// Outermost frame first
+	bool success = true;
+	for (U32 i = site->depth; success && i > 0; i--) {
+		U32 frame = i - 1;
+		if (symbols && symbols[frame].function) {
+			success = print_folded_frame(p, symbols[frame].function, symbols[frame].function_length);
+		} else {
+			char address[32];
+			int length = sprintf(address, "0x%llx", (unsigned long long)(uintptr_t)site->stack[frame]);
+			success = print(p, to_string(address, length));
 		}
+		success = success && print(p, ';');
 	}
 
-	ptr += sprintf(ptr, "</body></html>");
+	success = success
+		&& print(p, site->type)
+		&& print(p, ' ')
+		&& print_u64(p, (U64)(site->bytes + 0.5))
+		&& print(p, '\n');
 
-	return 200;
+	if (symbols)
+		os_free_address_infos(symbols);
+	return success;
+}
+
+#endif
+
+// Sampled allocated bytes by call stack in the folded format of flame graphs:
+// one `outer;inner;type bytes` line per call site. The samples that didn't fit
+// in the site table are summed on a `[dropped N samples] bytes` line.
+int render_alloc_profile(Printer *p, Reserved_Allocator *scratch)
+{
+#if BUILD_ALLOC_PROFILE
+
+	Alloc_Profile_Site *sites = PUSH_ALLOC_N(scratch, Alloc_Profile_Site, ALLOC_PROFILE_SITES);
+	U64 dropped_samples;
+	double dropped_bytes;
+	U32 count = alloc_profile_copy_sites(sites, &dropped_samples, &dropped_bytes);
+
+	bool success = true;
+	for (U32 i = 0; success && i < count; i++) {
+		success = render_alloc_profile_site(p, &sites[i]);
+	}
+
+	if (success && dropped_samples > 0) {
+		success = print(p, "[dropped ")
+			&& print_u64(p, dropped_samples)
+			&& print(p, " samples] ")
+			&& print_u64(p, (U64)(dropped_bytes + 0.5))
+			&& print(p, '\n');
+	}
+
+	return success ? 200 : 500;
 #else
 	return 404;
 #endif
 }
 
+// Per-connection state is allocated by the accept loop, which keeps a cache of
+// the pool, and given back by the response thread with a single release to the
+// shared list as every connection gets a new thread. Body storage is too large
+// to keep around for every past connection, so it goes back to the system
+// after each one.
+Pool connection_pool;
+
 struct Response_Thread_Data
 {
 	os_socket client_socket;
 	World_Instance *world_instance;
 	char *body_storage;
 	int thread_id;
+
+	char socket_buffer[SOCKET_BUFFER_SIZE];
 };
 
 struct Socket_Buffer
@@ -379,12 +484,13 @@ struct Read_Block
 	int length;
 };
 
-Socket_Buffer buffer_new(os_socket socket, int size=1024)
+// NOTE: The storage of the buffer is owned by the caller
+Socket_Buffer buffer_new(os_socket socket, char *data, int data_size)
 {
 	Socket_Buffer buffer = { 0 };
 	buffer.socket = socket;
-	buffer.data = M_ALLOC(char, size);
-	buffer.data_size = size;
+	buffer.data = data;
+	buffer.data_size = data_size;
 	return buffer;
 }
 
@@ -393,12 +499,6 @@ void buffer_limit(Socket_Buffer *buffer, int bytes)
 	buffer->limit_left = bytes;
 }
 
-// NOTE: Does not free the socket
-void buffer_free(Socket_Buffer *buffer)
-{
-	M_FREE(buffer->data);
-}
-
 bool buffer_fill_read(Socket_Buffer *buffer)
 {
 	int to_read = min(buffer->data_size, buffer->limit_left);
@@ -491,31 +591,54 @@ int buffer_read_amount(Socket_Buffer *buffer, char *data, int length)
 	return true;
 }
 
-void send_response(os_socket socket, const char *content_type, int status,
-	const char *body, size_t body_length, String *extra_headers, U32 extra_header_count)
+// Sends the response headers and all the body buffers with one gathered write
+void send_gather_response(os_socket socket, const char *content_type, int status,
+	const os_send_buffer *body, U32 body_count, String *extra_headers, U32 extra_header_count)
 {
-	const char *status_desc = get_http_status_description(status);
-	char response_start[128];
-	sprintf(response_start, "HTTP/1.1 %d %s\r\n", status, status_desc);
+	size_t body_length = 0;
+	for (U32 i = 0; i < body_count; i++) {
+		body_length += body[i].length;
+	}
 
-	char content_length_header[128];
-	sprintf(content_length_header, "Content-Length: %d\r\n", (int)body_length);
-	char content_type_header[128];
-	sprintf(content_type_header, "Content-Type: %s\r\n", content_type);
-	const char *separator = "\r\n";
+	char header_data[KB(2)];
+	Printer p = make_printer(header_data, sizeof(header_data));
 
-	os_socket_send(socket, response_start, (int)strlen(response_start));
-	os_socket_send(socket, content_length_header, (int)strlen(content_length_header));
-	os_socket_send(socket, content_type_header, (int)strlen(content_type_header));
+	print(&p, "HTTP/1.1 ");
+	print_u32(&p, (U32)status);
+	print(&p, ' ');
+	print(&p, get_http_status_description(status));
+	print(&p, "\r\nContent-Length: ");
+	print_u64(&p, (U64)body_length);
+	print(&p, "\r\nContent-Type: ");
+	print(&p, content_type);
+	print(&p, "\r\n");
 
 	for (U32 i = 0; i < extra_header_count; i++) {
-		String header = extra_headers[i];
-		os_socket_send(socket, header.data, (int)header.length);
-		os_socket_send(socket, separator, (int)strlen(separator));
+		print(&p, extra_headers[i]);
+		print(&p, "\r\n");
 	}
 
-	os_socket_send(socket, separator, (int)strlen(separator));
-	os_socket_send_and_flush(socket, body, (int)body_length);
+	if (!print(&p, "\r\n"))
+		return;
+
+	os_send_buffer buffers[FRAGMENT_LIST_MAX + 1];
+	assert(body_count < Count(buffers));
+
+	buffers[0].data = header_data;
+	buffers[0].length = p.pos - header_data;
+	memcpy(buffers + 1, body, body_count * sizeof(os_send_buffer));
+
+	os_socket_send_gather_and_flush(socket, buffers, (int)body_count + 1);
+}
+
+void send_response(os_socket socket, const char *content_type, int status,
+	const char *body, size_t body_length, String *extra_headers, U32 extra_header_count)
+{
+	os_send_buffer buffer;
+	buffer.data = body;
+	buffer.length = body_length;
+	send_gather_response(socket, content_type, status, &buffer, 1,
+		extra_headers, extra_header_count);
 }
 
 void send_response(os_socket socket, const char *content_type, int status,
@@ -530,6 +653,58 @@ void send_text_response(os_socket socket, const char *content_type, int status,
 	send_response(socket, content_type, status, body, strlen(body));
 }
 
+// A render that fails leaves whatever it managed to push in the list, so only
+// complete pages are sent and errors get a fixed body instead. Not found pages
+// are complete, they're rendered like in the other routes.
+void send_fragment_response(os_socket socket, const char *content_type, int status,
+	Fragment_List *list)
+{
+	if (status == 200 || status == 404) {
+		send_gather_response(socket, content_type, status,
+			list->buffers, list->buffer_count, 0, 0);
+	} else {
+		const char *body = "<html><body><h1>Internal server error.</h1></body></html>";
+		send_text_response(socket, "text/html", status, body);
+	}
+}
+
+// Sends the new feed posts as server-sent events until the client disconnects.
+// The posts are serialized once in `world_post()` and shared by all the
+// clients. Resumes after `last_event_id` if it's still in the broadcast buffer.
+void stream_feed(os_socket socket, Broadcast *feed, U64 last_event_id)
+{
+	const char *headers =
+		"HTTP/1.1 200 OK\r\n"
+		"Content-Type: text/event-stream\r\n"
+		"Cache-Control: no-cache\r\n"
+		"\r\n";
+	if (os_socket_send_and_flush(socket, headers, (int)strlen(headers)) < 0)
+		return;
+
+	U64 sequence = broadcast_sequence(feed);
+	if (last_event_id && last_event_id < sequence)
+		sequence = last_event_id;
+
+	for (;;) {
+		Fragment_List list;
+		fragment_list_init(&list);
+
+		bool success;
+		if (broadcast_wait(feed, &sequence, &list, 10) > 0) {
+			success = os_socket_send_gather_and_flush(socket, list.buffers, (int)list.buffer_count);
+		} else {
+			// Send a comment to keep the connection alive and notice if the
+			// client has disconnected
+			const char *keep_alive = ":\n\n";
+			success = os_socket_send_and_flush(socket, keep_alive, (int)strlen(keep_alive)) >= 0;
+		}
+
+		fragment_list_release(&list);
+		if (!success)
+			break;
+	}
+}
+
 OS_THREAD_ENTRY(thread_do_response, thread_data)
 {
 	Response_Thread_Data *data = (Response_Thread_Data*)thread_data;
@@ -537,11 +712,22 @@ OS_THREAD_ENTRY(thread_do_response, thread_data)
 	World_Instance *world_instance = data->world_instance;
 	char *body = data->body_storage;
 
+	// Everything a connection allocates that isn't tagged otherwise
+	mem_tag_set_thread(Mem_Tag_Net);
+
 	os_atomic_increment(&active_thread_count);
 
-	Socket_Buffer buffer = buffer_new(client_socket);
+	Socket_Buffer buffer = buffer_new(client_socket, data->socket_buffer, sizeof(data->socket_buffer));
 
-	for (;;) {
+	// Temporaries of a request are pushed here and released all at once when
+	// the request is done. Only the address space is reserved up front. The
+	// debug views copy more than fits here and use the heap instead.
+	Reserved_Allocator scratch;
+	bool has_scratch = reserved_allocator_init(&scratch, SCRATCH_RESERVE_SIZE, Mem_Tag_Scratch);
+	if (!has_scratch)
+		printf("%d: Failed to reserve scratch memory\n", data->thread_id);
+
+	while (has_scratch) {
 
 		// Allow only 8kB of request line and headers, but reset on every request
 		buffer_limit(&buffer, KB(8));
@@ -558,6 +744,7 @@ OS_THREAD_ENTRY(thread_do_response, thread_data)
 		sscanf(line, "%s %s %s\r\n", method, path, http_version);
 
 		unsigned int content_length = 0;
+		unsigned long long last_event_id = 0;
 
 		bool failed = false;
 		while (strlen(line)) {
@@ -567,6 +754,7 @@ OS_THREAD_ENTRY(thread_do_response, thread_data)
 			}
 			// TODO: Case-insensitive headers
 			sscanf(line, "Content-Length: %d", &content_length);
+			sscanf(line, "Last-Event-ID: %llu", &last_event_id);
 		}
 		if (failed)
 			break;
@@ -574,6 +762,7 @@ OS_THREAD_ENTRY(thread_do_response, thread_data)
 		U32 id;
 		U64 serial;
 		char test_name[128];
+		Printer p = make_printer(body, BODY_STORAGE_SIZE);
 		if (!strcmp(path, "/favicon.ico")) {
 			FILE *icon = fopen("data/icon.ico", "rb");
 			fseek(icon, 0, SEEK_END);
@@ -606,89 +795,111 @@ OS_THREAD_ENTRY(thread_do_response, thread_data)
 
 		} else if (!strcmp(path, "/dwarves")) {
 
+			Fragment_List list;
+			fragment_list_init(&list);
+
 			os_mutex_lock(&world_instance->lock);
 			update_to_now(world_instance);
-			int status = render_dwarves(world_instance->world, body);
+			int status = render_dwarves(world_instance->world, &p, &list);
 			os_mutex_unlock(&world_instance->lock);
 
-			send_response(client_socket, "text/html", status, body, strlen(body));
+			send_fragment_response(client_socket, "text/html", status, &list);
+			fragment_list_release(&list);
+
+		} else if (!strcmp(path, "/feed/stream")) {
+
+			stream_feed(client_socket, world_instance->world->feed, last_event_id);
+
+			// The stream only ends when the client disconnects
+			printf("%d: Stream %s %s closed\n", data->thread_id, method, path);
+			break;
 
 		} else if (!strcmp(path, "/feed")) {
 
 			os_mutex_lock(&world_instance->lock);
 			update_to_now(world_instance);
-			int status = render_feed(world_instance->world, body);
+			int status = render_feed(world_instance->world, &p);
 			os_mutex_unlock(&world_instance->lock);
 
-			send_text_response(client_socket, "text/html", status, body);
+			send_response(client_socket, "text/html", status, body, p.pos - body);
 
 			// TODO: Seriously need a real routing scheme
 		} else if (sscanf(path, "/entities/%d", &id) == 1 && strstr(path, "avatar.svg")) {
 
 			os_mutex_lock(&world_instance->lock);
 			update_to_now(world_instance);
-			int status = render_entity_avatar(world_instance->world, id, body);
+			int status = render_entity_avatar(world_instance->world, id, &p);
 			os_mutex_unlock(&world_instance->lock);
 
-			send_text_response(client_socket, "image/svg+xml", status, body);
+			send_response(client_socket, "image/svg+xml", status, body, p.pos - body);
 
 		} else if (sscanf(path, "/entities/%d", &id) == 1) {
 
 			os_mutex_lock(&world_instance->lock);
 			update_to_now(world_instance);
-			int status = render_entity(world_instance->world, id, body);
+			int status = render_entity(world_instance->world, id, &p);
 			os_mutex_unlock(&world_instance->lock);
 
-			send_text_response(client_socket, "text/html", status, body);
+			send_response(client_socket, "text/html", status, body, p.pos - body);
 
 		} else if (!strcmp(path, "/locations")) {
 
 			os_mutex_lock(&world_instance->lock);
 			update_to_now(world_instance);
-			int status = render_locations(world_instance->world, body);
+			int status = render_locations(world_instance->world, &p);
 			os_mutex_unlock(&world_instance->lock);
 
-			send_text_response(client_socket, "text/html", status, body);
+			send_response(client_socket, "text/html", status, body, p.pos - body);
 
 		} else if (sscanf(path, "/locations/%d", &id) == 1) {
 
+			Fragment_List list;
+			fragment_list_init(&list);
+
 			os_mutex_lock(&world_instance->lock);
 			update_to_now(world_instance);
-			int status = render_location(world_instance->world, id, body);
+			int status = render_location(world_instance->world, id, &p, &list);
 			os_mutex_unlock(&world_instance->lock);
 
-			send_text_response(client_socket, "text/html", status, body);
+			send_fragment_response(client_socket, "text/html", status, &list);
+			fragment_list_release(&list);
 
 		} else if (!strcmp(path, "/stats")) {
 
 			os_mutex_lock(&global_stats.lock);
-			int status = render_stats(&global_stats, body);
+			int status = render_stats(&global_stats, &p);
 			os_mutex_unlock(&global_stats.lock);
 
-			send_text_response(client_socket, "text/html", status, body);
+			send_response(client_socket, "text/html", status, body, p.pos - body);
 
 		} else if (!strcmp(path, "/heap")) {
 
-			int status = render_heap(body);
+			int status = render_heap(&p);
+
+			send_response(client_socket, "text/html", status, body, p.pos - body);
 
-			send_text_response(client_socket, "text/html", status, body);
+		} else if (!strcmp(path, "/profile/allocations")) {
+
+			int status = render_alloc_profile(&p, &scratch);
+
+			send_response(client_socket, "text/plain", status, body, p.pos - body);
 
 		} else if (sscanf(path, "/allocations/%llu", &serial) == 1) {
 
-			int status = render_allocation(body, serial);
+			int status = render_allocation(&p, serial);
 
-			send_text_response(client_socket, "text/html", status, body);
+			send_response(client_socket, "text/html", status, body, p.pos - body);
 
 		} else if (!strcmp(path, "/allocations")) {
 
-			int status = render_allocations(body);
+			int status = render_allocations(&p);
 
-			send_text_response(client_socket, "text/html", status, body);
+			send_response(client_socket, "text/html", status, body, p.pos - body);
 
 		} else if (sscanf(path, "/test/%s", test_name) == 1) {
 
-			char *in_buffer = M_ALLOC(char, TEST_BUFFER_SIZE);
-			char *out_buffer = M_ALLOC(char, TEST_BUFFER_SIZE);
+			char *in_buffer = PUSH_ALLOC_N(&scratch, char, TEST_BUFFER_SIZE);
+			char *out_buffer = PUSH_ALLOC_N(&scratch, char, TEST_BUFFER_SIZE);
 
 			buffer_limit(&buffer, TEST_BUFFER_SIZE);
 
@@ -710,9 +921,6 @@ OS_THREAD_ENTRY(thread_do_response, thread_data)
 				out_buffer, out_length,
 				extra_headers, Count(extra_headers));
 
-			M_FREE(in_buffer);
-			M_FREE(out_buffer);
-
 		} else if (!strcmp(path, "/")) {
 			const char *body = "<html><body><h1>Hello world!</h1></body></html>";
 			send_text_response(client_socket, "text/html", 200, body);
@@ -721,6 +929,8 @@ OS_THREAD_ENTRY(thread_do_response, thread_data)
 			send_text_response(client_socket, "text/html", 404, body);
 		}
 
+		push_allocator_reset(&scratch);
+
 		float ms = os_timer_delta_ms(begin_respond, os_get_timer());
 		printf("%d: Request %s %s (took %.2f ms)\n", data->thread_id, method, path, ms);
 	}
@@ -728,9 +938,9 @@ OS_THREAD_ENTRY(thread_do_response, thread_data)
 	os_socket_stop_recv(client_socket);
 	os_socket_close(client_socket);
 
-	buffer_free(&buffer);
+	push_allocator_free(&scratch);
 	M_FREE(body);
-	M_FREE(thread_data);
+	pool_release_shared(&connection_pool, thread_data);
 
 	os_atomic_decrement(&active_thread_count);
 
@@ -745,12 +955,17 @@ int main(int argc, char **argv)
 #if BUILD_DEBUG
 	debug_alloc_init();
 #endif
+#if BUILD_ALLOC_PROFILE
+	alloc_profile_init();
+#endif
 
 	static char err_buffer[128];
 
 	signal(SIGINT, handle_kill);
 	signal(SIGTERM, handle_kill);
 
+	pool_init(&connection_pool, sizeof(Response_Thread_Data), Mem_Tag_Net);
+
 	global_stats.snapshot_count = 100;
 	global_stats.active_thread_counts = M_ALLOC_ZERO(long, global_stats.snapshot_count);
 	os_mutex_init(&global_stats.lock);
@@ -795,9 +1010,15 @@ int main(int argc, char **argv)
 
 	char name_buf[512], *name_ptr = name_buf;
 
+	Mem_Tag main_tag = mem_tag_set_thread(Mem_Tag_World);
+
 	static World world = { 0 };
 	world.random_series = series_from_seed32(0xD02F);
 
+	static Broadcast feed;
+	broadcast_init(&feed);
+	world.feed = &feed;
+
 	world.locations[1].id = 1;
 	world.locations[1].name = "Initial Cave";
 	world.locations[2].id = 2;
@@ -828,19 +1049,12 @@ int main(int argc, char **argv)
 		dwarf->seed = next32(&world.random_series);
 	}
 
+	mem_tag_set_thread(Mem_Tag_XML);
 	Assets assets = { 0 };
-	static char face_xml_data[1024*1024];
-
-	FILE *face_xml_file = fopen("data/faces.svg", "r");
-	size_t num_bytes = fread(face_xml_data, 1, sizeof(face_xml_data), face_xml_file);
-
-	if (!parse_xml(&assets.faces.xml, face_xml_data, num_bytes)) {
-		puts("Failed to parse face SVG");
-	}
-
-	fclose(face_xml_file);
-
-	initialize_id_list(&assets.faces);
+	SVG_Blob faces_blob;
+	asset_faces_blob(&faces_blob);
+	svg_from_blob(&assets.faces, &faces_blob);
+	mem_tag_set_thread(main_tag);
 
 	world.assets = &assets;
 
@@ -867,10 +1081,10 @@ int main(int argc, char **argv)
 			continue;
 		}
 
-		Response_Thread_Data *thread_data = M_ALLOC(Response_Thread_Data, 1);
+		Response_Thread_Data *thread_data = POOL_ALLOC(&connection_pool, Response_Thread_Data);
 		thread_data->client_socket = client_socket;
 		thread_data->world_instance = &world_instance;
-		thread_data->body_storage = M_ALLOC(char, 1024*1024);
+		thread_data->body_storage = M_ALLOC_TAGGED(char, BODY_STORAGE_SIZE, Mem_Tag_Net);
 		thread_data->thread_id = ++thread_id;
 
 #if 1
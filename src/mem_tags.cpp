@@ -0,0 +1,191 @@
+
+// Memory accounting by subsystem. Every allocation is counted under a tag,
+// either given explicitly with the M_*_TAGGED macros and the `tag` field of the
+// allocators, or taken from the current tag of the thread set with
+// `mem_tag_set_thread`. The counters are split into shards like the debug
+// allocator so threads mostly update their own cache lines.
+
+enum Mem_Tag
+{
+	// Use the current tag of the thread
+	Mem_Tag_Inherit,
+
+	Mem_Tag_Other,
+	Mem_Tag_XML,
+	Mem_Tag_Strings,
+	Mem_Tag_World,
+	Mem_Tag_Net,
+	Mem_Tag_Gzip,
+	Mem_Tag_Scratch,
+
+	Mem_Tag_Count,
+};
+
+const char *mem_tag_names[] = {
+	"inherit", "other", "xml", "strings", "world", "net", "gzip", "scratch",
+};
+
+#if BUILD_MEM_TAGS
+
+#define MEM_TAG_SHARDS 16
+
+struct Mem_Tag_Counters
+{
+	// Live bytes wrap around in shards that free more than they allocate, the
+	// sum over the shards is still correct.
+	os_atomic_uint64 live_bytes;
+	os_atomic_uint64 allocated_bytes;
+	os_atomic_uint64 allocation_count;
+};
+
+struct CACHE_ALIGNED Mem_Tag_Shard
+{
+	Mem_Tag_Counters tags[Mem_Tag_Count];
+};
+
+Mem_Tag_Shard g_mem_tag_shards[MEM_TAG_SHARDS];
+
+OS_THREAD_LOCAL Mem_Tag g_mem_tag_thread;
+
+// Sets the tag of allocations that don't specify one, returns the previous tag
+Mem_Tag mem_tag_set_thread(Mem_Tag tag)
+{
+	Mem_Tag previous = g_mem_tag_thread;
+	g_mem_tag_thread = tag;
+	return previous;
+}
+
+inline Mem_Tag mem_tag_resolve(Mem_Tag tag)
+{
+	if (tag == Mem_Tag_Inherit)
+		tag = g_mem_tag_thread;
+	return tag == Mem_Tag_Inherit ? Mem_Tag_Other : tag;
+}
+
+inline Mem_Tag_Counters *mem_tag_counters(Mem_Tag tag)
+{
+	return &g_mem_tag_shards[thread_shard(MEM_TAG_SHARDS)].tags[tag];
+}
+
+// `tag` must be resolved
+inline void mem_tag_count_alloc(Mem_Tag tag, size_t size)
+{
+	Mem_Tag_Counters *counters = mem_tag_counters(tag);
+	os_atomic_add64(&counters->live_bytes, (U64)size);
+	os_atomic_add64(&counters->allocated_bytes, (U64)size);
+	os_atomic_increment64(&counters->allocation_count);
+}
+
+inline void mem_tag_count_free(Mem_Tag tag, size_t size)
+{
+	os_atomic_add64(&mem_tag_counters(tag)->live_bytes, (U64)0 - (U64)size);
+}
+
+// Release builds keep the size and tag of an allocation in front of it, padded
+// to keep the alignment of malloc.
+struct Mem_Tag_Header
+{
+	U64 size;
+	U64 tag;
+};
+
+inline void *mem_tag_finish_alloc(Mem_Tag_Header *header, size_t size, Mem_Tag tag)
+{
+	if (!header)
+		return 0;
+	header->size = size;
+	header->tag = tag;
+	mem_tag_count_alloc(tag, size);
+	return header + 1;
+}
+
+void *mem_tag_malloc(size_t size, Mem_Tag tag)
+{
+	tag = mem_tag_resolve(tag);
+	return mem_tag_finish_alloc((Mem_Tag_Header*)malloc(sizeof(Mem_Tag_Header) + size), size, tag);
+}
+
+void *mem_tag_calloc(size_t size, Mem_Tag tag)
+{
+	tag = mem_tag_resolve(tag);
+	return mem_tag_finish_alloc((Mem_Tag_Header*)calloc(sizeof(Mem_Tag_Header) + size, 1), size, tag);
+}
+
+// Reallocated memory keeps its tag
+void *mem_tag_realloc(void *ptr, size_t size)
+{
+	if (!ptr)
+		return mem_tag_malloc(size, Mem_Tag_Inherit);
+
+	Mem_Tag_Header *header = (Mem_Tag_Header*)ptr - 1;
+	Mem_Tag tag = (Mem_Tag)header->tag;
+	size_t old_size = (size_t)header->size;
+
+	Mem_Tag_Header *new_header = (Mem_Tag_Header*)realloc(header, sizeof(Mem_Tag_Header) + size);
+	if (!new_header)
+		return 0;
+
+	mem_tag_count_free(tag, old_size);
+	return mem_tag_finish_alloc(new_header, size, tag);
+}
+
+void mem_tag_free(void *ptr)
+{
+	if (!ptr)
+		return;
+
+	Mem_Tag_Header *header = (Mem_Tag_Header*)ptr - 1;
+	mem_tag_count_free((Mem_Tag)header->tag, (size_t)header->size);
+	free(header);
+}
+
+struct Mem_Tag_Total
+{
+	U64 live_bytes;
+	U64 allocated_bytes;
+	U64 allocation_count;
+};
+
+// Sums the counters of a tag over the shards, the shards are read without
+// locking so the total is only consistent while the tag is not in use.
+Mem_Tag_Total mem_tag_total(Mem_Tag tag)
+{
+	Mem_Tag_Total total = { };
+	for (U32 i = 0; i < MEM_TAG_SHARDS; i++) {
+		Mem_Tag_Counters *counters = &g_mem_tag_shards[i].tags[tag];
+		total.live_bytes += counters->live_bytes;
+		total.allocated_bytes += counters->allocated_bytes;
+		total.allocation_count += counters->allocation_count;
+	}
+	return total;
+}
+
+// Peak and rate of the tags derived from periodic samples of the totals
+struct Mem_Tag_Stats
+{
+	Mem_Tag_Total totals[Mem_Tag_Count];
+	U64 peak_bytes[Mem_Tag_Count];
+	double allocated_per_second[Mem_Tag_Count];
+	double allocations_per_second[Mem_Tag_Count];
+};
+
+void mem_tag_sample(Mem_Tag_Stats *stats, double seconds)
+{
+	for (U32 i = Mem_Tag_Other; i < Mem_Tag_Count; i++) {
+		Mem_Tag_Total total = mem_tag_total((Mem_Tag)i);
+		Mem_Tag_Total *previous = &stats->totals[i];
+
+		if (seconds > 0.0) {
+			stats->allocated_per_second[i] = (double)(total.allocated_bytes - previous->allocated_bytes) / seconds;
+			stats->allocations_per_second[i] = (double)(total.allocation_count - previous->allocation_count) / seconds;
+		}
+
+		// Live bytes can transiently read below zero while the shards are summed
+		if ((I64)total.live_bytes > 0)
+			stats->peak_bytes[i] = max(stats->peak_bytes[i], total.live_bytes);
+
+		*previous = total;
+	}
+}
+
+#endif
@@ -16,27 +16,53 @@ struct Push_Page
 struct Push_Allocator
 {
 	Push_Page page;
+
+	// Pages are counted under this tag, see mem_tags.cpp
+	Mem_Tag tag;
 };
 
 struct Push_Stream
 {
 	Push_Allocator *allocator;
 	size_t start;
+
+	// The start of the stream stays aligned to this when it's moved
+	size_t alignment;
 };
 
+// Bytes needed to align `pointer` to `alignment`, which must be a power of two
+inline size_t align_padding(const void *pointer, size_t alignment)
+{
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+	return (size_t)(-(uintptr_t)pointer) & (alignment - 1);
+}
+
+// Every page buffer is preceded by room for its header, which is filled in when
+// the page stops being the current one, so retiring a page allocates nothing.
+inline Push_Page *push_page_header(char *buffer)
+{
+	return (Push_Page*)buffer - 1;
+}
+
+inline void push_page_free(char *buffer)
+{
+	if (buffer)
+		M_FREE(push_page_header(buffer));
+}
+
 inline Push_Page *push_allocator_new_page(Push_Allocator *allocator, size_t size_hint)
 {
 	size_t new_size = max(allocator->page.size * 2, size_hint);
 
 	Push_Page *old_page = 0;
 	if (allocator->page.size > 0) {
-		old_page = M_ALLOC(Push_Page, 1);
+		old_page = push_page_header(allocator->page.buffer);
 		*old_page = allocator->page;
 	}
 
 	Push_Page *new_page = &allocator->page;
 	new_page->previous = old_page;
-	new_page->buffer = M_ALLOC(char, new_size);
+	new_page->buffer = M_ALLOC_TAGGED(char, sizeof(Push_Page) + new_size, allocator->tag) + sizeof(Push_Page);
 	new_page->position = 0;
 	new_page->size = new_size;
 
@@ -54,6 +80,20 @@ inline void *push_allocator_push(Push_Allocator *allocator, size_t size)
 	return data;
 }
 
+inline void *push_allocator_push_aligned(Push_Allocator *allocator, size_t size, size_t alignment)
+{
+	Push_Page *page = &allocator->page;
+	size_t padding = align_padding(page->buffer + page->position, alignment);
+	if (page->size - page->position < size + padding) {
+		// Page buffers are only aligned as well as the system allocator aligns
+		push_allocator_new_page(allocator, size + alignment - 1);
+		padding = align_padding(page->buffer, alignment);
+	}
+	void *data = page->buffer + page->position + padding;
+	page->position += padding + size;
+	return data;
+}
+
 inline void *push_allocator_copy(Push_Allocator *allocator, size_t size, void *src)
 {
 	void *dst = push_allocator_push(allocator, size);
@@ -61,24 +101,86 @@ inline void *push_allocator_copy(Push_Allocator *allocator, size_t size, void *s
 	return dst;
 }
 
+inline void *push_allocator_copy_aligned(Push_Allocator *allocator, size_t size, size_t alignment, void *src)
+{
+	void *dst = push_allocator_push_aligned(allocator, size, alignment);
+	memcpy(dst, src, size);
+	return dst;
+}
+
 void push_allocator_free(Push_Allocator *allocator)
 {
-	M_FREE(allocator->page.buffer);
+	Push_Page *page = allocator->page.previous;
+	push_page_free(allocator->page.buffer);
+
+	while (page) {
+		Push_Page *prev_page = page->previous;
+		push_page_free(page->buffer);
+		page = prev_page;
+	}
+}
+
+// Position of a push allocator that it can be rewound back to
+struct Push_Marker
+{
+	char *buffer;
+	size_t position;
+};
+
+inline Push_Marker push_allocator_mark(Push_Allocator *allocator)
+{
+	Push_Marker marker;
+	marker.buffer = allocator->page.buffer;
+	marker.position = allocator->page.position;
+	return marker;
+}
+
+// Releases everything pushed after `marker` was taken. Pages created after the
+// marker are freed.
+void push_allocator_rewind(Push_Allocator *allocator, Push_Marker marker)
+{
+	while (allocator->page.buffer != marker.buffer && allocator->page.previous) {
+		Push_Page *prev_page = allocator->page.previous;
+		push_page_free(allocator->page.buffer);
+		allocator->page = *prev_page;
+	}
 
+	if (allocator->page.buffer == marker.buffer) {
+		allocator->page.position = marker.position;
+	} else {
+		// The marker was taken before the first page was created
+		allocator->page.position = 0;
+	}
+}
+
+// Releases everything in the allocator but keeps the newest page around, so an
+// allocator that is reset between uses settles to one page that fits the
+// largest use and stops allocating.
+void push_allocator_reset(Push_Allocator *allocator)
+{
 	Push_Page *page = allocator->page.previous;
 	while (page) {
 		Push_Page *prev_page = page->previous;
-		M_FREE(page->buffer);
-		M_FREE(page);
+		push_page_free(page->buffer);
 		page = prev_page;
 	}
+
+	allocator->page.previous = 0;
+	allocator->page.position = 0;
 }
 
-inline Push_Stream start_push_stream(Push_Allocator *allocator)
+// Default alignment of streams, enough for the typed pushes of any basic type
+#define PUSH_STREAM_ALIGNMENT 16
+
+// Elements pushed into the stream can be aligned up to `alignment`
+inline Push_Stream start_push_stream(Push_Allocator *allocator, size_t alignment=PUSH_STREAM_ALIGNMENT)
 {
+	push_allocator_push_aligned(allocator, 0, alignment);
+
 	Push_Stream stream;
 	stream.allocator = allocator;
 	stream.start = allocator->page.position;
+	stream.alignment = alignment;
 	return stream;
 }
 
@@ -101,18 +203,31 @@ inline void *push_stream_push(Push_Stream *stream, size_t size)
 	Push_Page *page = &stream->allocator->page;
 	if (page->size - page->position < size) {
 		size_t prefix_size = page->position - stream->start;
-		Push_Page *old_page = push_allocator_new_page(stream->allocator, prefix_size + size);
+		Push_Page *old_page = push_allocator_new_page(stream->allocator,
+			prefix_size + size + stream->alignment - 1);
+		size_t start = align_padding(page->buffer, stream->alignment);
 		if (old_page) {
-			memcpy(page->buffer, old_page->buffer + stream->start, prefix_size);
+			memcpy(page->buffer + start, old_page->buffer + stream->start, prefix_size);
 		}
-		page->position = prefix_size;
-		stream->start = 0;
+		page->position = start + prefix_size;
+		stream->start = start;
 	}
 	void *data = page->buffer + page->position;
 	page->position += size;
 	return data;
 }
 
+// Aligns relative to the start of the stream so the alignment survives moving
+// the stream, `alignment` can't be larger than the one of the stream.
+inline void *push_stream_push_aligned(Push_Stream *stream, size_t size, size_t alignment)
+{
+	assert(alignment <= stream->alignment);
+	Push_Page *page = &stream->allocator->page;
+	size_t padding = align_padding((void*)(page->position - stream->start), alignment);
+	char *data = (char*)push_stream_push(stream, padding + size);
+	return data + padding;
+}
+
 inline void *push_stream_copy(Push_Stream *stream, size_t size, void *src)
 {
 	void *dst = push_stream_push(stream, size);
@@ -120,20 +235,34 @@ inline void *push_stream_copy(Push_Stream *stream, size_t size, void *src)
 	return dst;
 }
 
-#define PUSH_ALLOC(allocator, type) ((type*)push_allocator_push((allocator), sizeof(type)))
-#define PUSH_ALLOC_N(allocator, type, n) ((type*)push_allocator_push((allocator), (n) * sizeof(type)))
+inline void *push_stream_copy_aligned(Push_Stream *stream, size_t size, size_t alignment, void *src)
+{
+	void *dst = push_stream_push_aligned(stream, size, alignment);
+	memcpy(dst, src, size);
+	return dst;
+}
+
+// Typed pushes are aligned to the alignment of the type, strings are not aligned
+#define PUSH_ALLOC(allocator, type) ((type*)push_allocator_push_aligned((allocator), sizeof(type), ALIGNOF(type)))
+#define PUSH_ALLOC_N(allocator, type, n) ((type*)push_allocator_push_aligned((allocator), (n) * sizeof(type), ALIGNOF(type)))
 #define PUSH_ALLOC_STR(allocator, n) to_string(((char*)push_allocator_push((allocator), (n))), n)
 
-#define PUSH_COPY(allocator, type, data) ((type*)push_allocator_copy((allocator), sizeof(type), (data)))
-#define PUSH_COPY_N(allocator, type, n, data) ((type*)push_allocator_copy((allocator), (n) * sizeof(type), (data)))
+// Explicitly aligned arrays for SIMD loads
+#define PUSH_ALLOC_ALIGNED(allocator, type, n, alignment) ((type*)push_allocator_push_aligned((allocator), (n) * sizeof(type), (alignment)))
+#define PUSH_ALLOC_16(allocator, type, n) PUSH_ALLOC_ALIGNED(allocator, type, n, 16)
+#define PUSH_ALLOC_32(allocator, type, n) PUSH_ALLOC_ALIGNED(allocator, type, n, 32)
+#define PUSH_ALLOC_64(allocator, type, n) PUSH_ALLOC_ALIGNED(allocator, type, n, 64)
+
+#define PUSH_COPY(allocator, type, data) ((type*)push_allocator_copy_aligned((allocator), sizeof(type), ALIGNOF(type), (data)))
+#define PUSH_COPY_N(allocator, type, n, data) ((type*)push_allocator_copy_aligned((allocator), (n) * sizeof(type), ALIGNOF(type), (data)))
 #define PUSH_COPY_STR(allocator, str) to_string(((char*)push_allocator_copy((allocator), (str).length, (str).data)), (str).length)
 
-#define STREAM_ALLOC(stream, type) ((type*)push_stream_push((stream), sizeof(type)))
-#define STREAM_ALLOC_N(stream, type, n) ((type*)push_stream_push((stream), (n) * sizeof(type)))
+#define STREAM_ALLOC(stream, type) ((type*)push_stream_push_aligned((stream), sizeof(type), ALIGNOF(type)))
+#define STREAM_ALLOC_N(stream, type, n) ((type*)push_stream_push_aligned((stream), (n) * sizeof(type), ALIGNOF(type)))
 #define STREAM_ALLOC_STR(stream, n) to_string(((char*)push_stream_push((stream), (n))), n)
 
-#define STREAM_COPY(stream, type, data) ((type*)push_stream_copy((stream), sizeof(type), (data)))
-#define STREAM_COPY_N(stream, type, n, data) ((type*)push_stream_copy((stream), (n) * sizeof(type), (data)))
+#define STREAM_COPY(stream, type, data) ((type*)push_stream_copy_aligned((stream), sizeof(type), ALIGNOF(type), (data)))
+#define STREAM_COPY_N(stream, type, n, data) ((type*)push_stream_copy_aligned((stream), (n) * sizeof(type), ALIGNOF(type), (data)))
 #define STREAM_COPY_STR(stream, str) to_string(((char*)push_stream_copy((stream), (str).length, (str).data)), (str).length)
 
 #define LIST_STRUCT(type) struct type##_List { type *data; size_t count, capacity; }; \
@@ -155,3 +284,78 @@ inline void *push_stream_copy(Push_Stream *stream, size_t size, void *src)
 	} \
 	void list_free(type##_List *list) { M_FREE(list->data); }
 
+// Growable array that keeps its first `N` elements inline, so small arrays
+// don't allocate at all. An array with `arena` set grows into the arena instead
+// of the heap and leaves its old storage to the arena. Zero-initialized arrays
+// are empty and ready to use, and like with LIST_STRUCT `data` can be pointed
+// to external read-only data. `data` may point into the array itself, so an
+// array in use must not be copied or moved in memory.
+template <typename T, size_t N>
+struct Dyn_Array
+{
+	T *data;
+	size_t count, capacity;
+	Push_Allocator *arena;
+	T inline_data[N];
+};
+
+template <typename T, size_t N>
+void list_realloc(Dyn_Array<T, N> *list, size_t size)
+{
+	// Elements are relocated with memcpy when the array grows
+	static_assert(__is_trivially_copyable(T), "Dyn_Array elements must be trivially copyable");
+
+	if (!list->data && size <= N) {
+		list->data = list->inline_data;
+		list->capacity = N;
+		return;
+	}
+
+	size_t new_capacity = max(size, list->capacity * 2);
+	bool is_inline = list->data == list->inline_data;
+
+	T *new_data;
+	if (list->arena) {
+		new_data = PUSH_ALLOC_N(list->arena, T, new_capacity);
+	} else if (!is_inline) {
+		list->data = M_REALLOC(list->data, T, new_capacity);
+		list->capacity = new_capacity;
+		return;
+	} else {
+		new_data = M_ALLOC(T, new_capacity);
+	}
+
+	if (list->count > 0)
+		memcpy(new_data, list->data, list->count * sizeof(T));
+	list->data = new_data;
+	list->capacity = new_capacity;
+}
+
+template <typename T, size_t N>
+T *list_push(Dyn_Array<T, N> *list, size_t count=1)
+{
+	if (list->count + count > list->capacity)
+		list_realloc(list, list->count + count);
+	T *dst = list->data + list->count;
+	list->count += count;
+	return dst;
+}
+
+template <typename T, size_t N>
+T *list_push(Dyn_Array<T, N> *list, const T *data, size_t count=1)
+{
+	T *dst = list_push(list, count);
+	memcpy(dst, data, count * sizeof(T));
+	return dst;
+}
+
+template <typename T, size_t N>
+void list_free(Dyn_Array<T, N> *list)
+{
+	if (!list->arena && list->data != list->inline_data)
+		M_FREE(list->data);
+	list->data = 0;
+	list->count = 0;
+	list->capacity = 0;
+}
+
@@ -9,11 +9,11 @@
 #include <errno.h>
 #include <netinet/tcp.h>
 #include <execinfo.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
 
 typedef timespec os_timer_mark;
 
-char *os_linux_executable_name;
-
 os_timer_mark os_get_timer()
 {
 	timespec value;
@@ -26,6 +26,7 @@ float os_timer_delta_ms(os_timer_mark begin, os_timer_mark end)
 	time_t sec_diff = end.tv_sec - begin.tv_sec;
 	int nano_diff = end.tv_nsec - begin.tv_nsec;
 	float ms = sec_diff * 1000.0f + nano_diff / 1000000.0f;
+	return ms;
 }
 
 typedef int os_socket;
@@ -56,6 +57,42 @@ int os_socket_send(os_socket sock, const char *data, int length)
 	return send(sock, data, length, MSG_NOSIGNAL);
 }
 
+// Sends all the buffers in order with as few system calls as possible
+bool os_socket_send_gather(os_socket sock, const os_send_buffer *buffers, int count)
+{
+	iovec iov[64];
+	int index = 0;
+	size_t offset = 0;
+
+	while (index < count) {
+		int iov_count = 0;
+		for (int i = index; i < count && iov_count < (int)Count(iov); i++) {
+			size_t skip = i == index ? offset : 0;
+			iov[iov_count].iov_base = (void*)(buffers[i].data + skip);
+			iov[iov_count].iov_len = buffers[i].length - skip;
+			iov_count++;
+		}
+
+		msghdr msg = { 0 };
+		msg.msg_iov = iov;
+		msg.msg_iovlen = iov_count;
+		ssize_t sent = sendmsg(sock, &msg, MSG_NOSIGNAL);
+		if (sent < 0)
+			return false;
+
+		// Advance past the fully sent buffers, sendmsg() may stop early
+		size_t left = (size_t)sent;
+		while (index < count && left >= buffers[index].length - offset) {
+			left -= buffers[index].length - offset;
+			offset = 0;
+			index++;
+		}
+		offset += left;
+	}
+
+	return true;
+}
+
 bool os_socket_set_delayed(os_socket sock, bool delayed) {
 	int flag = delayed ? 0 : 1;
 	return setsockopt(sock, IPPROTO_TCP, TCP_NODELAY,
@@ -71,6 +108,15 @@ int os_socket_send_and_flush(os_socket sock, const char *data, int length)
 	return ret;
 }
 
+bool os_socket_send_gather_and_flush(os_socket sock, const os_send_buffer *buffers, int count)
+{
+	bool set = os_socket_set_delayed(sock, false);
+	bool ret = os_socket_send_gather(sock, buffers, count);
+	if (set) os_socket_set_delayed(sock, true);
+
+	return ret;
+}
+
 bool os_socket_set_timeout(os_socket sock, int recv_sec, int send_sec)
 {
 	timeval recv_time;
@@ -105,6 +151,27 @@ inline void os_mutex_unlock(os_mutex *mutex)
 	pthread_mutex_unlock(mutex);
 }
 
+typedef pthread_cond_t os_cond;
+
+inline void os_cond_init(os_cond *cond)
+{
+	pthread_cond_init(cond, 0);
+}
+
+// Returns false if the wait timed out
+inline bool os_cond_wait(os_cond *cond, os_mutex *mutex, int timeout_seconds)
+{
+	timespec deadline;
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout_seconds;
+	return pthread_cond_timedwait(cond, mutex, &deadline) == 0;
+}
+
+inline void os_cond_broadcast(os_cond *cond)
+{
+	pthread_cond_broadcast(cond);
+}
+
 inline void os_sleep_seconds(int seconds)
 {
 	sleep(seconds);
@@ -112,16 +179,47 @@ inline void os_sleep_seconds(int seconds)
 
 typedef volatile U32 os_atomic_uint32;
 
-inline void os_atomic_increment(os_atomic_uint32 *value)
+// Returns the incremented value
+inline U32 os_atomic_increment(os_atomic_uint32 *value)
+{
+	return __sync_add_and_fetch(value, 1);
+}
+
+// Returns the decremented value
+inline U32 os_atomic_decrement(os_atomic_uint32 *value)
+{
+	return __sync_sub_and_fetch(value, 1);
+}
+
+typedef volatile U64 os_atomic_uint64;
+
+// Returns the incremented value
+inline U64 os_atomic_increment64(os_atomic_uint64 *value)
 {
-	__sync_fetch_and_add(value, 1);
+	return __sync_add_and_fetch(value, 1);
 }
 
-inline void os_atomic_decrement(os_atomic_uint32 *value)
+// Returns the value after adding `amount`
+inline U64 os_atomic_add64(os_atomic_uint64 *value, U64 amount)
 {
-	__sync_fetch_and_sub(value, 1);
+	return __sync_add_and_fetch(value, amount);
 }
 
+// Pointer load and store that order the memory accesses before the store to
+// happen before the ones after the load that sees it.
+inline void *os_atomic_load_pointer(void *volatile *pointer)
+{
+	return __atomic_load_n(pointer, __ATOMIC_ACQUIRE);
+}
+
+inline void os_atomic_store_pointer(void *volatile *pointer, void *value)
+{
+	__atomic_store_n(pointer, value, __ATOMIC_RELEASE);
+}
+
+// Storage class of variables that have a separate instance for every thread
+#define OS_THREAD_LOCAL __thread
+
 #define OS_THREAD_ENTRY(function, param) void* function(void *param)
 #define OS_THREAD_RETURN return 0
 
@@ -141,7 +239,6 @@ inline os_thread os_thread_do(os_thread_func func, void *param)
 
 inline void os_startup(int argc, char **argv)
 {
-	os_linux_executable_name = argv[0];
 }
 
 inline void os_cleanup()
@@ -165,88 +262,45 @@ inline bool os_thread_id_equal(os_thread_id a, os_thread_id b)
 	return pthread_equal(a, b) != 0;
 }
 
-// Macro so the function doesn't get included in the trace
-#define os_capture_stack_trace(trace, count) \
-	backtrace((trace), (count))
-
-#ifdef BUILD_DEBUG
-
-bool os_linux_parse_addr2line(os_symbol_info_writer *w, int i, FILE *input)
+// Reserves a range of address space without any memory behind it
+inline void *os_memory_reserve(size_t size)
 {
-	char line[512];
-
-	if (!fgets(line, sizeof(line), input))
-		return false;
-
-	int function_len = (int)strlen(line) - 1;
-	if (function_len > 0 && line[0] != '?') {
-		if (!os_symbol_writer_set_function(w, i, line, function_len))
-			return false;
-	}
-
-	if (!fgets(line, sizeof(line), input))
-		return false;
-
-	char *filename_end = strchr(line, ':');
-	if (!filename_end) return false;
-
-	int filename_len = (int)(filename_end - line);
-	if (filename_len > 0 && line[0] != '?') {
-
-		int lineno;
-		if (sscanf(filename_end + 1, "%d", &lineno) != 1)
-			return false;
-
-		if (!os_symbol_writer_set_location(w, i, line, filename_len, lineno))
-			return false;
-	}
-
-	return true;
+	void *data = mmap(NULL, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	return data != MAP_FAILED ? data : 0;
 }
 
-os_symbol_info *os_get_address_infos(void **addresses, int count)
+// Makes a page aligned part of a reserved range usable
+inline bool os_memory_commit(void *data, size_t size)
 {
-	os_symbol_info_writer w;
-	os_symbol_writer_begin(&w, count);
-
-	char command[2048];
-	char *ptr = command, *end = command + sizeof(command);
-
-	ptr += snprintf(ptr, end - ptr, "addr2line -Cfe \"%s\"", os_linux_executable_name);
-	if (end - ptr < 1) return 0;
-
-	for (int i = 0; i < count; i++) {
-		ptr += snprintf(ptr, end - ptr, " %llx", (unsigned long long)addresses[i]);
-		if (end - ptr < 1) return 0;
-	}
-
-	FILE *input = popen(command, "r");
-	if (!input)
-		return 0;
-
-	for (int i = 0; i < count; i++) {
-		if (!os_linux_parse_addr2line(&w, i, input)) {
-			pclose(input);
-			return 0;
-		}
-	}
-
-	pclose(input);
-
-	return os_symbol_writer_finish(&w);
+	return mprotect(data, size, PROT_READ | PROT_WRITE) == 0;
 }
 
-#else
+// Returns the memory of a page aligned part of a reserved range to the system
+// but keeps the addresses reserved
+inline void os_memory_decommit(void *data, size_t size)
+{
+	madvise(data, size, MADV_DONTNEED);
+	mprotect(data, size, PROT_NONE);
+}
 
-os_symbol_info *os_get_address_infos(void **addresses, int count)
+inline void os_memory_release(void *data, size_t size)
 {
-	return 0;
+	munmap(data, size);
 }
 
-#endif
+size_t g_os_memory_page_size;
 
-void os_free_address_infos(os_symbol_info* infos)
+// Queried once, racing threads store the same value
+inline size_t os_memory_page_size()
 {
-	free(infos);
+	if (!g_os_memory_page_size)
+		g_os_memory_page_size = (size_t)sysconf(_SC_PAGESIZE);
+	return g_os_memory_page_size;
 }
 
+// Macro so the function doesn't get included in the trace
+#define os_capture_stack_trace(trace, count) \
+	backtrace((trace), (count))
+
+// Symbolization is in platform_linux_symbols.cpp
+
@@ -0,0 +1,1004 @@
+
+// In-process symbolizer for stack traces. The ELF symbol table and the DWARF
+// line tables of the executable are parsed on the first lookup into arrays
+// sorted by address that are kept for the lifetime of the process, so after
+// that resolving an address is two binary searches without any system calls.
+// Only the executable itself is covered, addresses in shared libraries resolve
+// to nothing. Compressed debug sections are not supported.
+
+#if defined(BUILD_DEBUG) || defined(BUILD_ALLOC_PROFILE)
+
+#include <elf.h>
+#include <link.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+struct os_linux_symbol
+{
+	U64 address;
+	U64 size;
+	const char *name;
+};
+
+struct os_linux_line
+{
+	U64 address;
+	U32 file;
+
+	// Zero if the address has no source line, eg. after the end of a sequence
+	U32 line;
+};
+
+// Range of rows of one line program sequence, rows within one are sorted
+struct os_linux_line_sequence
+{
+	U64 address;
+	U32 first, count;
+};
+
+struct os_linux_symbolizer
+{
+	// Difference of the runtime addresses to the ones in the file
+	uintptr_t load_bias;
+	uintptr_t image_begin, image_end;
+
+	os_linux_symbol *symbols;
+	U32 symbol_count;
+
+	os_linux_line *lines;
+	U32 line_count, line_capacity;
+
+	os_linux_line_sequence *sequences;
+	U32 sequence_count, sequence_capacity;
+
+	char **files;
+	U32 file_count, file_capacity;
+};
+
+os_linux_symbolizer os_linux_symbols;
+pthread_once_t os_linux_symbols_once = PTHREAD_ONCE_INIT;
+
+enum
+{
+	OS_DW_LNS_copy = 1,
+	OS_DW_LNS_advance_pc = 2,
+	OS_DW_LNS_advance_line = 3,
+	OS_DW_LNS_set_file = 4,
+	OS_DW_LNS_const_add_pc = 8,
+	OS_DW_LNS_fixed_advance_pc = 9,
+
+	OS_DW_LNE_end_sequence = 1,
+	OS_DW_LNE_set_address = 2,
+
+	OS_DW_LNCT_path = 1,
+	OS_DW_LNCT_directory_index = 2,
+
+	OS_DW_FORM_block = 0x09,
+	OS_DW_FORM_data1 = 0x0b,
+	OS_DW_FORM_data2 = 0x05,
+	OS_DW_FORM_data4 = 0x06,
+	OS_DW_FORM_data8 = 0x07,
+	OS_DW_FORM_data16 = 0x1e,
+	OS_DW_FORM_string = 0x08,
+	OS_DW_FORM_strp = 0x0e,
+	OS_DW_FORM_udata = 0x0f,
+	OS_DW_FORM_line_strp = 0x1f,
+};
+
+struct os_linux_section
+{
+	const U8 *data;
+	size_t size;
+};
+
+struct os_linux_reader
+{
+	const U8 *pos, *end;
+	bool failed;
+};
+
+inline os_linux_reader os_linux_make_reader(const U8 *data, size_t size)
+{
+	os_linux_reader r;
+	r.pos = data;
+	r.end = data + size;
+	r.failed = false;
+	return r;
+}
+
+inline bool os_linux_skip(os_linux_reader *r, U64 size)
+{
+	if ((U64)(r->end - r->pos) < size) {
+		r->pos = r->end;
+		r->failed = true;
+		return false;
+	}
+	r->pos += size;
+	return true;
+}
+
+// Reads a little-endian unsigned integer of `size` bytes
+U64 os_linux_read(os_linux_reader *r, U32 size)
+{
+	const U8 *data = r->pos;
+	if (!os_linux_skip(r, size))
+		return 0;
+
+	U64 value = 0;
+	for (U32 i = 0; i < size; i++) {
+		value |= (U64)data[i] << (i * 8);
+	}
+	return value;
+}
+
+U64 os_linux_read_uleb(os_linux_reader *r)
+{
+	U64 value = 0;
+	U32 shift = 0;
+	while (r->pos < r->end) {
+		U8 byte = *r->pos++;
+		if (shift < 64)
+			value |= (U64)(byte & 0x7f) << shift;
+		shift += 7;
+		if (!(byte & 0x80))
+			return value;
+	}
+	r->failed = true;
+	return 0;
+}
+
+I64 os_linux_read_sleb(os_linux_reader *r)
+{
+	U64 value = 0;
+	U32 shift = 0;
+	while (r->pos < r->end) {
+		U8 byte = *r->pos++;
+		if (shift < 64)
+			value |= (U64)(byte & 0x7f) << shift;
+		shift += 7;
+		if (!(byte & 0x80)) {
+			if (shift < 64 && (byte & 0x40))
+				value |= ~(U64)0 << shift;
+			return (I64)value;
+		}
+	}
+	r->failed = true;
+	return 0;
+}
+
+const char *os_linux_read_string(os_linux_reader *r)
+{
+	const U8 *zero = (const U8*)memchr(r->pos, '\0', r->end - r->pos);
+	if (!zero) {
+		r->pos = r->end;
+		r->failed = true;
+		return 0;
+	}
+	const char *str = (const char*)r->pos;
+	r->pos = zero + 1;
+	return str;
+}
+
+inline const char *os_linux_section_string(os_linux_section *section, U64 offset)
+{
+	if (offset >= section->size)
+		return 0;
+	if (!memchr(section->data + offset, '\0', section->size - offset))
+		return 0;
+	return (const char*)section->data + offset;
+}
+
+// Joins a relative path to a directory, the result is allocated with malloc
+char *os_linux_join_path(const char *directory, const char *path)
+{
+	if (!path)
+		return 0;
+	if (path[0] == '/' || !directory || !directory[0])
+		return strdup(path);
+
+	size_t dir_length = strlen(directory), path_length = strlen(path);
+	char *result = (char*)malloc(dir_length + path_length + 2);
+	if (!result)
+		return 0;
+	memcpy(result, directory, dir_length);
+	result[dir_length] = '/';
+	memcpy(result + dir_length + 1, path, path_length + 1);
+	return result;
+}
+
+bool os_linux_add_file(os_linux_symbolizer *s, char *path)
+{
+	if (s->file_count == s->file_capacity) {
+		U32 new_capacity = max(s->file_capacity * 2, 64);
+		char **files = (char**)realloc(s->files, new_capacity * sizeof(char*));
+		if (!files)
+			return false;
+		s->files = files;
+		s->file_capacity = new_capacity;
+	}
+	s->files[s->file_count++] = path;
+	return true;
+}
+
+bool os_linux_add_line(os_linux_symbolizer *s, U64 address, U32 file, U32 line)
+{
+	if (s->line_count == s->line_capacity) {
+		U32 new_capacity = max(s->line_capacity * 2, 1024);
+		os_linux_line *lines = (os_linux_line*)realloc(s->lines, new_capacity * sizeof(os_linux_line));
+		if (!lines)
+			return false;
+		s->lines = lines;
+		s->line_capacity = new_capacity;
+	}
+
+	os_linux_line *row = &s->lines[s->line_count++];
+	row->address = address;
+	row->file = file;
+	row->line = line;
+	return true;
+}
+
+bool os_linux_add_sequence(os_linux_symbolizer *s, U32 first)
+{
+	if (s->sequence_count == s->sequence_capacity) {
+		U32 new_capacity = max(s->sequence_capacity * 2, 64);
+		os_linux_line_sequence *sequences = (os_linux_line_sequence*)realloc(s->sequences,
+			new_capacity * sizeof(os_linux_line_sequence));
+		if (!sequences)
+			return false;
+		s->sequences = sequences;
+		s->sequence_capacity = new_capacity;
+	}
+
+	os_linux_line_sequence *sequence = &s->sequences[s->sequence_count++];
+	sequence->address = s->lines[first].address;
+	sequence->first = first;
+	sequence->count = s->line_count - first;
+	return true;
+}
+
+struct os_linux_dwarf
+{
+	os_linux_section line;
+	os_linux_section line_str;
+	os_linux_section str;
+};
+
+// Reads one attribute of a directory or file entry, sets either `string` or
+// `value` depending on the form.
+bool os_linux_read_form(os_linux_reader *r, os_linux_dwarf *dwarf, U64 form, bool offset64,
+	const char **string, U64 *value)
+{
+	*string = 0;
+	*value = 0;
+
+	switch (form) {
+	case OS_DW_FORM_string: *string = os_linux_read_string(r); break;
+	case OS_DW_FORM_line_strp:
+		*string = os_linux_section_string(&dwarf->line_str, os_linux_read(r, offset64 ? 8 : 4));
+		break;
+	case OS_DW_FORM_strp:
+		*string = os_linux_section_string(&dwarf->str, os_linux_read(r, offset64 ? 8 : 4));
+		break;
+	case OS_DW_FORM_udata: *value = os_linux_read_uleb(r); break;
+	case OS_DW_FORM_data1: *value = os_linux_read(r, 1); break;
+	case OS_DW_FORM_data2: *value = os_linux_read(r, 2); break;
+	case OS_DW_FORM_data4: *value = os_linux_read(r, 4); break;
+	case OS_DW_FORM_data8: *value = os_linux_read(r, 8); break;
+	case OS_DW_FORM_data16: os_linux_skip(r, 16); break;
+	case OS_DW_FORM_block: os_linux_skip(r, os_linux_read_uleb(r)); break;
+	default: return false;
+	}
+
+	return !r->failed;
+}
+
+// Reads a version 5 directory or file name table into `paths` and `directories`,
+// which are allocated with malloc and have `*count` entries.
+bool os_linux_read_entry_table(os_linux_reader *r, os_linux_dwarf *dwarf, bool offset64,
+	const char ***paths, U64 **directories, U64 *count)
+{
+	U64 formats[16][2];
+	U32 format_count = (U32)os_linux_read(r, 1);
+	if (format_count > Count(formats))
+		return false;
+	for (U32 i = 0; i < format_count; i++) {
+		formats[i][0] = os_linux_read_uleb(r);
+		formats[i][1] = os_linux_read_uleb(r);
+	}
+
+	U64 entry_count = os_linux_read_uleb(r);
+	if (r->failed || entry_count > (U64)(r->end - r->pos))
+		return false;
+
+	*paths = (const char**)calloc(entry_count + 1, sizeof(const char*));
+	*directories = (U64*)calloc(entry_count + 1, sizeof(U64));
+	*count = entry_count;
+	if (!*paths || !*directories)
+		return false;
+
+	for (U64 i = 0; i < entry_count; i++) {
+		for (U32 j = 0; j < format_count; j++) {
+			const char *string;
+			U64 value;
+			if (!os_linux_read_form(r, dwarf, formats[j][1], offset64, &string, &value))
+				return false;
+			if (formats[j][0] == OS_DW_LNCT_path)
+				(*paths)[i] = string;
+			else if (formats[j][0] == OS_DW_LNCT_directory_index)
+				(*directories)[i] = value;
+		}
+	}
+
+	return true;
+}
+
+// Adds the file names of a line program header to the global file list
+bool os_linux_read_line_files(os_linux_symbolizer *s, os_linux_reader *r, os_linux_dwarf *dwarf,
+	U32 version, bool offset64)
+{
+	if (version >= 5) {
+		const char **dir_paths = 0, **file_paths = 0;
+		U64 *dir_indices = 0, *file_dirs = 0;
+		U64 dir_count = 0, file_count = 0;
+
+		bool success = os_linux_read_entry_table(r, dwarf, offset64, &dir_paths, &dir_indices, &dir_count)
+			&& os_linux_read_entry_table(r, dwarf, offset64, &file_paths, &file_dirs, &file_count);
+
+		for (U64 i = 0; success && i < file_count; i++) {
+			// Directories other than the first are relative to the first one
+			const char *directory = file_dirs[i] < dir_count ? dir_paths[file_dirs[i]] : 0;
+			char *full_directory = file_dirs[i] > 0 && dir_count > 0
+				? os_linux_join_path(dir_paths[0], directory) : 0;
+			char *path = os_linux_join_path(full_directory ? full_directory : directory, file_paths[i]);
+			free(full_directory);
+			success = os_linux_add_file(s, path);
+		}
+
+		free(dir_paths);
+		free(dir_indices);
+		free(file_paths);
+		free(file_dirs);
+		return success;
+
+	} else {
+		const char *directories[256];
+		U32 dir_count = 0;
+		for (;;) {
+			const char *directory = os_linux_read_string(r);
+			if (!directory || !directory[0])
+				break;
+			if (dir_count < Count(directories))
+				directories[dir_count++] = directory;
+		}
+
+		for (;;) {
+			const char *name = os_linux_read_string(r);
+			if (!name || !name[0])
+				break;
+			U64 dir = os_linux_read_uleb(r);
+			os_linux_read_uleb(r);
+			os_linux_read_uleb(r);
+
+			const char *directory = dir > 0 && dir <= dir_count ? directories[dir - 1] : 0;
+			if (!os_linux_add_file(s, os_linux_join_path(directory, name)))
+				return false;
+		}
+
+		return !r->failed;
+	}
+}
+
+// Runs the line number program of one unit and adds its rows
+bool os_linux_read_line_unit(os_linux_symbolizer *s, os_linux_reader *unit, os_linux_dwarf *dwarf)
+{
+	bool offset64 = false;
+	U64 unit_length = os_linux_read(unit, 4);
+	if (unit_length == 0xffffffff) {
+		offset64 = true;
+		unit_length = os_linux_read(unit, 8);
+	}
+
+	const U8 *unit_begin = unit->pos;
+	if (!os_linux_skip(unit, unit_length))
+		return false;
+	os_linux_reader r = os_linux_make_reader(unit_begin, unit_length);
+
+	U32 version = (U32)os_linux_read(&r, 2);
+	if (version < 2 || version > 5)
+		return true;
+	if (version >= 5) {
+		U32 address_size = (U32)os_linux_read(&r, 1);
+		os_linux_skip(&r, 1);
+		if (address_size != 8)
+			return true;
+	}
+
+	U64 header_length = os_linux_read(&r, offset64 ? 8 : 4);
+	if (r.failed || header_length > (U64)(r.end - r.pos))
+		return false;
+	const U8 *program = r.pos + header_length;
+
+	U32 min_instruction_length = (U32)os_linux_read(&r, 1);
+	if (version >= 4)
+		os_linux_skip(&r, 1);
+	bool default_is_stmt = os_linux_read(&r, 1) != 0;
+	I32 line_base = (I8)os_linux_read(&r, 1);
+	U32 line_range = (U32)os_linux_read(&r, 1);
+	U32 opcode_base = (U32)os_linux_read(&r, 1);
+	const U8 *opcode_lengths = r.pos;
+	if (!os_linux_skip(&r, opcode_base > 0 ? opcode_base - 1 : 0) || line_range == 0)
+		return false;
+	(void)default_is_stmt;
+
+	// Version 5 numbers files from zero, earlier versions from one
+	U32 file_base = s->file_count;
+	if (!os_linux_read_line_files(s, &r, dwarf, version, offset64))
+		return false;
+	U32 unit_file_count = s->file_count - file_base;
+	U32 first_file = version >= 5 ? 0 : 1;
+
+	r.pos = program;
+
+	U64 address = 0;
+	U64 file = 1;
+	I64 line = 1;
+	U32 sequence_first = s->line_count;
+
+	// Sequences of functions removed by the linker start at address zero
+	bool skip_sequence = false;
+
+	while (r.pos < r.end && !r.failed) {
+		bool emit = false;
+		bool end_sequence = false;
+
+		U32 opcode = (U32)os_linux_read(&r, 1);
+		if (opcode >= opcode_base) {
+			U32 adjusted = opcode - opcode_base;
+			address += (adjusted / line_range) * min_instruction_length;
+			line += line_base + (I32)(adjusted % line_range);
+			emit = true;
+		} else if (opcode == 0) {
+			U64 length = os_linux_read_uleb(&r);
+			const U8 *next = r.pos + length;
+			if (r.failed || length == 0 || length > (U64)(r.end - r.pos))
+				return false;
+
+			U32 extended = (U32)os_linux_read(&r, 1);
+			if (extended == OS_DW_LNE_end_sequence) {
+				emit = true;
+				end_sequence = true;
+			} else if (extended == OS_DW_LNE_set_address && length == 9) {
+				address = os_linux_read(&r, 8);
+				if (s->line_count == sequence_first)
+					skip_sequence = address == 0;
+			}
+			r.pos = next;
+		} else if (opcode == OS_DW_LNS_copy) {
+			emit = true;
+		} else if (opcode == OS_DW_LNS_advance_pc) {
+			address += os_linux_read_uleb(&r) * min_instruction_length;
+		} else if (opcode == OS_DW_LNS_advance_line) {
+			line += os_linux_read_sleb(&r);
+		} else if (opcode == OS_DW_LNS_set_file) {
+			file = os_linux_read_uleb(&r);
+		} else if (opcode == OS_DW_LNS_const_add_pc) {
+			address += ((255 - opcode_base) / line_range) * min_instruction_length;
+		} else if (opcode == OS_DW_LNS_fixed_advance_pc) {
+			address += os_linux_read(&r, 2);
+		} else {
+			// Skip the arguments of opcodes that don't affect the rows
+			for (U32 i = 0; i < opcode_lengths[opcode - 1]; i++)
+				os_linux_read_uleb(&r);
+		}
+
+		if (emit && !skip_sequence) {
+			U32 file_index = file >= first_file && file - first_file < unit_file_count
+				? file_base + (U32)(file - first_file) : UINT32_MAX;
+			U32 row_line = end_sequence || line <= 0 || line > UINT32_MAX ? 0 : (U32)line;
+			if (!os_linux_add_line(s, address, file_index, row_line))
+				return false;
+		}
+
+		if (end_sequence) {
+			if (s->line_count > sequence_first && !os_linux_add_sequence(s, sequence_first))
+				return false;
+			address = 0;
+			file = 1;
+			line = 1;
+			sequence_first = s->line_count;
+			skip_sequence = false;
+		}
+	}
+
+	// Drop the rows of an unterminated sequence
+	s->line_count = sequence_first;
+	return !r.failed;
+}
+
+int os_linux_compare_symbol(const void *a, const void *b)
+{
+	const os_linux_symbol *sa = (const os_linux_symbol*)a, *sb = (const os_linux_symbol*)b;
+	return sa->address < sb->address ? -1 : sa->address > sb->address ? 1 : 0;
+}
+
+int os_linux_compare_sequence(const void *a, const void *b)
+{
+	const os_linux_line_sequence *sa = (const os_linux_line_sequence*)a;
+	const os_linux_line_sequence *sb = (const os_linux_line_sequence*)b;
+	return sa->address < sb->address ? -1 : sa->address > sb->address ? 1 : 0;
+}
+
+// Sorts the rows by address by ordering whole sequences, which keeps the order
+// of rows at the same address within a sequence.
+bool os_linux_sort_lines(os_linux_symbolizer *s)
+{
+	qsort(s->sequences, s->sequence_count, sizeof(os_linux_line_sequence), os_linux_compare_sequence);
+
+	os_linux_line *lines = (os_linux_line*)malloc(max(s->line_count, 1) * sizeof(os_linux_line));
+	if (!lines)
+		return false;
+
+	U32 count = 0;
+	for (U32 i = 0; i < s->sequence_count; i++) {
+		os_linux_line_sequence *sequence = &s->sequences[i];
+		memcpy(lines + count, s->lines + sequence->first, sequence->count * sizeof(os_linux_line));
+		count += sequence->count;
+	}
+
+	free(s->lines);
+	free(s->sequences);
+	s->lines = lines;
+	s->line_count = count;
+	s->line_capacity = count;
+	s->sequences = 0;
+	s->sequence_count = 0;
+	s->sequence_capacity = 0;
+	return true;
+}
+
+bool os_linux_read_symbols(os_linux_symbolizer *s, const U8 *file, size_t file_size,
+	Elf64_Shdr *symtab, Elf64_Shdr *strtab)
+{
+	if (symtab->sh_offset > file_size || symtab->sh_size > file_size - symtab->sh_offset
+		|| strtab->sh_offset > file_size || strtab->sh_size > file_size - strtab->sh_offset)
+		return false;
+
+	os_linux_section names;
+	names.data = file + strtab->sh_offset;
+	names.size = strtab->sh_size;
+
+	const Elf64_Sym *elf_symbols = (const Elf64_Sym*)(file + symtab->sh_offset);
+	size_t elf_symbol_count = symtab->sh_size / sizeof(Elf64_Sym);
+
+	s->symbols = (os_linux_symbol*)malloc(max(elf_symbol_count, 1) * sizeof(os_linux_symbol));
+	if (!s->symbols)
+		return false;
+
+	for (size_t i = 0; i < elf_symbol_count; i++) {
+		const Elf64_Sym *sym = &elf_symbols[i];
+		if (ELF64_ST_TYPE(sym->st_info) != STT_FUNC || sym->st_value == 0)
+			continue;
+		const char *name = os_linux_section_string(&names, sym->st_name);
+		if (!name || !name[0])
+			continue;
+
+		os_linux_symbol *symbol = &s->symbols[s->symbol_count++];
+		symbol->address = sym->st_value;
+		symbol->size = sym->st_size;
+		symbol->name = name;
+	}
+
+	qsort(s->symbols, s->symbol_count, sizeof(os_linux_symbol), os_linux_compare_symbol);
+	return true;
+}
+
+int os_linux_find_executable(struct dl_phdr_info *info, size_t size, void *data)
+{
+	// The executable is always the first object
+	os_linux_symbolizer *s = (os_linux_symbolizer*)data;
+	s->load_bias = (uintptr_t)info->dlpi_addr;
+	s->image_begin = UINTPTR_MAX;
+	s->image_end = 0;
+	for (int i = 0; i < info->dlpi_phnum; i++) {
+		const ElfW(Phdr) *phdr = &info->dlpi_phdr[i];
+		if (phdr->p_type != PT_LOAD)
+			continue;
+		uintptr_t begin = s->load_bias + (uintptr_t)phdr->p_vaddr;
+		s->image_begin = min(s->image_begin, begin);
+		s->image_end = max(s->image_end, begin + (uintptr_t)phdr->p_memsz);
+	}
+	return 1;
+}
+
+// Loads the tables of the executable, the file stays mapped for the names
+void os_linux_load_symbols()
+{
+	os_linux_symbolizer *s = &os_linux_symbols;
+	dl_iterate_phdr(os_linux_find_executable, s);
+
+	int fd = open("/proc/self/exe", O_RDONLY);
+	if (fd < 0)
+		return;
+
+	struct stat st;
+	const U8 *file = 0;
+	size_t file_size = 0;
+	if (!fstat(fd, &st) && st.st_size > 0) {
+		file_size = (size_t)st.st_size;
+		void *map = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		file = map != MAP_FAILED ? (const U8*)map : 0;
+	}
+	close(fd);
+	if (!file)
+		return;
+
+	const Elf64_Ehdr *header = (const Elf64_Ehdr*)file;
+	if (file_size < sizeof(Elf64_Ehdr) || memcmp(header->e_ident, ELFMAG, SELFMAG)
+		|| header->e_ident[EI_CLASS] != ELFCLASS64 || header->e_shentsize != sizeof(Elf64_Shdr)
+		|| header->e_shoff > file_size
+		|| (U64)header->e_shnum * sizeof(Elf64_Shdr) > file_size - header->e_shoff
+		|| header->e_shstrndx >= header->e_shnum)
+		return;
+
+	Elf64_Shdr *sections = (Elf64_Shdr*)(file + header->e_shoff);
+	Elf64_Shdr *names_header = &sections[header->e_shstrndx];
+	if (names_header->sh_offset > file_size || names_header->sh_size > file_size - names_header->sh_offset)
+		return;
+	os_linux_section section_names;
+	section_names.data = file + names_header->sh_offset;
+	section_names.size = names_header->sh_size;
+
+	Elf64_Shdr *symtab = 0, *dynsym = 0;
+	os_linux_dwarf dwarf = { };
+	for (U32 i = 0; i < header->e_shnum; i++) {
+		Elf64_Shdr *section = &sections[i];
+		const char *name = os_linux_section_string(&section_names, section->sh_name);
+		if (!name)
+			continue;
+
+		if (section->sh_type == SHT_SYMTAB) symtab = section;
+		if (section->sh_type == SHT_DYNSYM) dynsym = section;
+
+		if (section->sh_type == SHT_NOBITS || (section->sh_flags & SHF_COMPRESSED)
+			|| section->sh_offset > file_size || section->sh_size > file_size - section->sh_offset)
+			continue;
+
+		os_linux_section data;
+		data.data = file + section->sh_offset;
+		data.size = section->sh_size;
+		if (!strcmp(name, ".debug_line")) dwarf.line = data;
+		if (!strcmp(name, ".debug_line_str")) dwarf.line_str = data;
+		if (!strcmp(name, ".debug_str")) dwarf.str = data;
+	}
+
+	// Stripped executables still have the exported functions
+	Elf64_Shdr *functions = symtab ? symtab : dynsym;
+	if (functions && functions->sh_link < header->e_shnum)
+		os_linux_read_symbols(s, file, file_size, functions, &sections[functions->sh_link]);
+
+	os_linux_reader units = os_linux_make_reader(dwarf.line.data, dwarf.line.size);
+	while (units.pos < units.end) {
+		if (!os_linux_read_line_unit(s, &units, &dwarf))
+			break;
+	}
+	os_linux_sort_lines(s);
+}
+
+// Index of the last symbol starting at or before `address`, or -1
+int os_linux_find_symbol(os_linux_symbolizer *s, U64 address)
+{
+	U32 lo = 0, hi = s->symbol_count;
+	while (lo < hi) {
+		U32 mid = lo + (hi - lo) / 2;
+		if (s->symbols[mid].address <= address) lo = mid + 1; else hi = mid;
+	}
+	return (int)lo - 1;
+}
+
+// Index of the last line row starting at or before `address`, or -1
+int os_linux_find_line(os_linux_symbolizer *s, U64 address)
+{
+	U32 lo = 0, hi = s->line_count;
+	while (lo < hi) {
+		U32 mid = lo + (hi - lo) / 2;
+		if (s->lines[mid].address <= address) lo = mid + 1; else hi = mid;
+	}
+	return (int)lo - 1;
+}
+
+struct os_linux_demangler
+{
+	const char *pos, *end;
+	char *out;
+	int length, capacity;
+
+	// Last name printed, constructors and destructors repeat it
+	const char *last_name;
+	int last_length;
+};
+
+bool os_linux_demangle_append(os_linux_demangler *d, const char *str, int length)
+{
+	if (d->capacity - d->length < length)
+		return false;
+	memcpy(d->out + d->length, str, length);
+	d->length += length;
+	return true;
+}
+
+inline bool os_linux_demangle_is_digit(os_linux_demangler *d)
+{
+	return d->pos < d->end && *d->pos >= '0' && *d->pos <= '9';
+}
+
+bool os_linux_demangle_number(os_linux_demangler *d, U32 *result)
+{
+	if (!os_linux_demangle_is_digit(d))
+		return false;
+	U32 value = 0;
+	while (os_linux_demangle_is_digit(d) && value < 100000) {
+		value = value * 10 + (U32)(*d->pos++ - '0');
+	}
+	*result = value;
+	return true;
+}
+
+// Skips template arguments `I...E` without printing them
+bool os_linux_demangle_skip_template_args(os_linux_demangler *d)
+{
+	int depth = 0;
+	do {
+		if (d->pos >= d->end)
+			return false;
+		char c = *d->pos;
+
+		if (c >= '0' && c <= '9') {
+			// Source names can contain any letters, skip them whole
+			U32 length;
+			if (!os_linux_demangle_number(d, &length) || (U32)(d->end - d->pos) < length)
+				return false;
+			d->pos += length;
+		} else if (c == 'S' || c == 'T' || c == 'A') {
+			// Substitutions, template parameters and array bounds: S[seq]_ T[seq]_ A<n>_
+			d->pos++;
+			if (c == 'S' && d->pos < d->end && *d->pos >= 'a' && *d->pos <= 'z') {
+				d->pos++;
+			} else {
+				while (d->pos < d->end && *d->pos != '_'
+					&& ((*d->pos >= '0' && *d->pos <= '9') || (*d->pos >= 'A' && *d->pos <= 'Z')))
+					d->pos++;
+				if (d->pos >= d->end || *d->pos != '_')
+					return false;
+				d->pos++;
+			}
+		} else if (c == 'L') {
+			// Literals: L <builtin type> [n] <number> E
+			d->pos++;
+			if (d->pos + 1 < d->end && d->pos[0] == '_' && d->pos[1] == 'Z') {
+				d->pos += 2;
+				depth++;
+				continue;
+			}
+			if (d->pos >= d->end || *d->pos < 'a' || *d->pos > 'z')
+				return false;
+			d->pos++;
+			if (d->pos < d->end && *d->pos == 'n')
+				d->pos++;
+			while (os_linux_demangle_is_digit(d))
+				d->pos++;
+			if (d->pos >= d->end || *d->pos != 'E')
+				return false;
+			d->pos++;
+		} else if (c == 'I' || c == 'N' || c == 'X' || c == 'J' || c == 'F') {
+			d->pos++;
+			depth++;
+		} else if (c == 'E') {
+			d->pos++;
+			depth--;
+		} else {
+			d->pos++;
+		}
+	} while (depth > 0);
+
+	return true;
+}
+
+struct os_linux_operator_name
+{
+	char code[3];
+	const char *name;
+};
+
+os_linux_operator_name os_linux_operator_names[] = {
+	"nw", "operator new", "na", "operator new[]", "dl", "operator delete", "da", "operator delete[]",
+	"ps", "operator+", "ng", "operator-", "ad", "operator&", "de", "operator*", "co", "operator~",
+	"pl", "operator+", "mi", "operator-", "ml", "operator*", "dv", "operator/", "rm", "operator%",
+	"an", "operator&", "or", "operator|", "eo", "operator^", "aS", "operator=",
+	"pL", "operator+=", "mI", "operator-=", "mL", "operator*=", "dV", "operator/=",
+	"rM", "operator%=", "aN", "operator&=", "oR", "operator|=", "eO", "operator^=",
+	"ls", "operator<<", "rs", "operator>>", "lS", "operator<<=", "rS", "operator>>=",
+	"eq", "operator==", "ne", "operator!=", "lt", "operator<", "gt", "operator>",
+	"le", "operator<=", "ge", "operator>=", "nt", "operator!", "aa", "operator&&",
+	"oo", "operator||", "pp", "operator++", "mm", "operator--", "cm", "operator,",
+	"pm", "operator->*", "pt", "operator->", "cl", "operator()", "ix", "operator[]",
+};
+
+// Prints one unqualified name: a source name, operator, constructor or destructor
+bool os_linux_demangle_unqualified(os_linux_demangler *d)
+{
+	if (d->pos < d->end && *d->pos == 'L')
+		d->pos++;
+	if (d->pos >= d->end)
+		return false;
+
+	char c = *d->pos;
+	if (c >= '0' && c <= '9') {
+		U32 length;
+		if (!os_linux_demangle_number(d, &length) || (U32)(d->end - d->pos) < length)
+			return false;
+		d->last_name = d->pos;
+		d->last_length = (int)length;
+		d->pos += length;
+		return os_linux_demangle_append(d, d->last_name, d->last_length);
+	}
+
+	if (d->end - d->pos < 2)
+		return false;
+	char next = d->pos[1];
+
+	if (c == 'C' && next >= '1' && next <= '5') {
+		d->pos += 2;
+		return d->last_name && os_linux_demangle_append(d, d->last_name, d->last_length);
+	}
+	if (c == 'D' && next >= '0' && next <= '5') {
+		d->pos += 2;
+		return d->last_name && os_linux_demangle_append(d, "~", 1)
+			&& os_linux_demangle_append(d, d->last_name, d->last_length);
+	}
+
+	for (U32 i = 0; i < Count(os_linux_operator_names); i++) {
+		os_linux_operator_name *op = &os_linux_operator_names[i];
+		if (op->code[0] == c && op->code[1] == next) {
+			d->pos += 2;
+			return os_linux_demangle_append(d, op->name, (int)strlen(op->name));
+		}
+	}
+
+	return false;
+}
+
+// Prints the qualified name of a mangled function without its template and
+// function arguments, eg. `_ZN3foo3barEPKci` becomes `foo::bar`. Returns the
+// length of the name or -1 if it's not a supported mangled name.
+int os_linux_demangle(char *out, int capacity, const char *mangled)
+{
+	os_linux_demangler d;
+	d.pos = mangled;
+	d.end = mangled + strlen(mangled);
+	d.out = out;
+	d.length = 0;
+	d.capacity = capacity;
+	d.last_name = 0;
+	d.last_length = 0;
+
+	if (d.end - d.pos < 3 || d.pos[0] != '_' || d.pos[1] != 'Z')
+		return -1;
+	d.pos += 2;
+
+	if (*d.pos == 'N') {
+		d.pos++;
+		while (d.pos < d.end && (*d.pos == 'r' || *d.pos == 'V' || *d.pos == 'K'
+			|| *d.pos == 'R' || *d.pos == 'O'))
+			d.pos++;
+
+		bool first = true;
+		for (;;) {
+			if (d.pos >= d.end)
+				return -1;
+			char c = *d.pos;
+			if (c == 'E') {
+				d.pos++;
+				break;
+			} else if (c == 'I') {
+				if (!os_linux_demangle_skip_template_args(&d))
+					return -1;
+				continue;
+			} else if (c == 'B') {
+				// ABI tags are not printed
+				d.pos++;
+				U32 length;
+				if (!os_linux_demangle_number(&d, &length) || (U32)(d.end - d.pos) < length)
+					return -1;
+				d.pos += length;
+				continue;
+			}
+
+			if (!first && !os_linux_demangle_append(&d, "::", 2))
+				return -1;
+			if (c == 'S' && d.pos + 1 < d.end && d.pos[1] == 't') {
+				d.pos += 2;
+				if (!os_linux_demangle_append(&d, "std", 3))
+					return -1;
+			} else if (!os_linux_demangle_unqualified(&d)) {
+				return -1;
+			}
+			first = false;
+		}
+	} else {
+		if (d.end - d.pos >= 2 && d.pos[0] == 'S' && d.pos[1] == 't') {
+			d.pos += 2;
+			if (!os_linux_demangle_append(&d, "std::", 5))
+				return -1;
+		}
+		if (!os_linux_demangle_unqualified(&d))
+			return -1;
+	}
+
+	return d.length;
+}
+
+bool os_linux_set_function_name(os_symbol_info_writer *w, int index, const char *name)
+{
+	char demangled[512];
+	int length = os_linux_demangle(demangled, sizeof(demangled), name);
+	if (length > 0)
+		return os_symbol_writer_set_function(w, index, demangled, length);
+	return os_symbol_writer_set_function(w, index, name, (int)strlen(name));
+}
+
+os_symbol_info *os_get_address_infos(void **addresses, int count)
+{
+	pthread_once(&os_linux_symbols_once, os_linux_load_symbols);
+	os_linux_symbolizer *s = &os_linux_symbols;
+
+	os_symbol_info_writer w;
+	if (!os_symbol_writer_begin(&w, count))
+		return 0;
+
+	bool success = true;
+	for (int i = 0; success && i < count; i++) {
+		uintptr_t runtime_address = (uintptr_t)addresses[i];
+		if (runtime_address <= s->image_begin || runtime_address > s->image_end)
+			continue;
+
+		// Stack traces contain return addresses, look up the call instruction
+		U64 address = (U64)(runtime_address - s->load_bias - 1);
+
+		int symbol_index = os_linux_find_symbol(s, address);
+		if (symbol_index >= 0) {
+			os_linux_symbol *symbol = &s->symbols[symbol_index];
+			if (symbol->size == 0 || address < symbol->address + symbol->size)
+				success = os_linux_set_function_name(&w, i, symbol->name);
+		}
+
+		int line_index = os_linux_find_line(s, address);
+		if (success && line_index >= 0) {
+			os_linux_line *row = &s->lines[line_index];
+			const char *file = row->file < s->file_count ? s->files[row->file] : 0;
+			if (row->line > 0 && file)
+				success = os_symbol_writer_set_location(&w, i, file, (int)strlen(file), (int)row->line);
+		}
+	}
+
+	if (!success) {
+		os_symbol_writer_abort(&w);
+		return 0;
+	}
+
+	return os_symbol_writer_finish(&w);
+}
+
+#else
+
+os_symbol_info *os_get_address_infos(void **addresses, int count)
+{
+	return 0;
+}
+
+#endif
+
+void os_free_address_infos(os_symbol_info* infos)
+{
+	free(infos);
+}
@@ -1,4 +1,11 @@
 
+// Buffer for gathered socket sends, see `os_socket_send_gather()`
+struct os_send_buffer
+{
+	const char *data;
+	size_t length;
+};
+
 struct os_symbol_info
 {
 	char *function;
@@ -45,10 +52,8 @@ bool os_symbol_writer_push_string(os_symbol_info_writer *w, const char *str, int
 		void *memory = w->symbols;
 		int new_capacity = w->string_capacity * 2 + copy_length;
 		memory = realloc(memory, sizeof(os_symbol_info) * w->symbol_count + new_capacity);
-		if (!memory) {
-			free(w->symbols);
+		if (!memory)
 			return false;
-		}
 
 		w->symbols = (os_symbol_info*)memory;
 		w->strings = (char*)memory + sizeof(os_symbol_info) * w->symbol_count;
@@ -79,6 +84,13 @@ bool os_symbol_writer_set_function(os_symbol_info_writer *w, int index, const ch
 	return os_symbol_writer_push_string(w, str, length);
 }
 
+// Frees the symbols of a writer that failed, the writer still owns them
+void os_symbol_writer_abort(os_symbol_info_writer *w)
+{
+	free(w->symbols);
+	w->symbols = 0;
+}
+
 os_symbol_info *os_symbol_writer_finish(os_symbol_info_writer *w)
 {
 	int count = w->symbol_count;
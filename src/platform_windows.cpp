@@ -4,7 +4,7 @@
 #include <ws2tcpip.h>
 #include <Windows.h>
 
-#ifdef BUILD_DEBUG
+#if defined(BUILD_DEBUG) || defined(BUILD_ALLOC_PROFILE)
 #include <DbgHelp.h>
 #endif
 
@@ -54,6 +54,29 @@ int os_socket_send(os_socket sock, const char *data, int length)
 	return send(sock, data, length, 0);
 }
 
+// Sends all the buffers in order with as few system calls as possible
+bool os_socket_send_gather(os_socket sock, const os_send_buffer *buffers, int count)
+{
+	WSABUF wsa_buffers[64];
+	int index = 0;
+
+	while (index < count) {
+		DWORD wsa_count = 0;
+		for (; index < count && wsa_count < Count(wsa_buffers); index++) {
+			wsa_buffers[wsa_count].buf = (CHAR*)buffers[index].data;
+			wsa_buffers[wsa_count].len = (ULONG)buffers[index].length;
+			wsa_count++;
+		}
+
+		// Blocking WSASend() always sends all the buffers or fails
+		DWORD sent;
+		if (WSASend(sock, wsa_buffers, wsa_count, &sent, 0, NULL, NULL))
+			return false;
+	}
+
+	return true;
+}
+
 bool os_socket_set_delayed(os_socket sock, bool delayed) {
 	BOOL flag = delayed ? FALSE : TRUE;
 	return setsockopt(sock, IPPROTO_TCP, TCP_NODELAY,
@@ -69,6 +92,15 @@ int os_socket_send_and_flush(os_socket sock, const char *data, int length)
 	return ret;
 }
 
+bool os_socket_send_gather_and_flush(os_socket sock, const os_send_buffer *buffers, int count)
+{
+	bool set = os_socket_set_delayed(sock, false);
+	bool ret = os_socket_send_gather(sock, buffers, count);
+	if (set) os_socket_set_delayed(sock, true);
+
+	return ret;
+}
+
 bool os_socket_set_timeout(os_socket sock, int recv_sec, int send_sec)
 {
 	DWORD recv_time = recv_sec * 1000;
@@ -99,6 +131,24 @@ inline void os_mutex_unlock(os_mutex *mutex)
 	LeaveCriticalSection(mutex);
 }
 
+typedef CONDITION_VARIABLE os_cond;
+
+inline void os_cond_init(os_cond *cond)
+{
+	InitializeConditionVariable(cond);
+}
+
+// Returns false if the wait timed out
+inline bool os_cond_wait(os_cond *cond, os_mutex *mutex, int timeout_seconds)
+{
+	return SleepConditionVariableCS(cond, mutex, timeout_seconds * 1000) != 0;
+}
+
+inline void os_cond_broadcast(os_cond *cond)
+{
+	WakeAllConditionVariable(cond);
+}
+
 inline void os_sleep_seconds(int seconds)
 {
 	Sleep(seconds * 1000);
@@ -106,16 +156,60 @@ inline void os_sleep_seconds(int seconds)
 
 typedef volatile DWORD os_atomic_uint32;
 
-inline void os_atomic_increment(os_atomic_uint32 *value)
+// Returns the incremented value
+inline U32 os_atomic_increment(os_atomic_uint32 *value)
+{
+	return InterlockedIncrement(value);
+}
+
+// Returns the decremented value
+inline U32 os_atomic_decrement(os_atomic_uint32 *value)
+{
+	return InterlockedDecrement(value);
+}
+
+typedef volatile LONG64 os_atomic_uint64;
+
+// Returns the incremented value
+inline U64 os_atomic_increment64(os_atomic_uint64 *value)
 {
-	InterlockedIncrement(value);
+	return (U64)InterlockedIncrement64(value);
 }
 
-inline void os_atomic_decrement(os_atomic_uint32 *value)
+// Returns the value after adding `amount`
+inline U64 os_atomic_add64(os_atomic_uint64 *value, U64 amount)
 {
-	InterlockedDecrement(value);
+	return (U64)InterlockedExchangeAdd64(value, (LONG64)amount) + amount;
 }
 
+// Pointer load and store that order the memory accesses before the store to
+// happen before the ones after the load that sees it.
+//
+// Loads on x86 and x64 already have acquire semantics so only the compiler needs
+// to be kept from reordering, ARM needs an acquiring load or a barrier.
+inline void *os_atomic_load_pointer(void *volatile *pointer)
+{
+#if defined(_M_ARM64)
+	return (void*)__ldar64((unsigned __int64 volatile*)pointer);
+#elif defined(_M_ARM)
+	void *value = *pointer;
+	__dmb(_ARM_BARRIER_ISH);
+	return value;
+#else
+	void *value = *pointer;
+	_ReadWriteBarrier();
+	return value;
+#endif
+}
+
+inline void os_atomic_store_pointer(void *volatile *pointer, void *value)
+{
+	InterlockedExchangePointer(pointer, value);
+}
+
+// Storage class of variables that have a separate instance for every thread
+#define OS_THREAD_LOCAL __declspec(thread)
+
 #define OS_THREAD_ENTRY(function, param) DWORD WINAPI function(void *param)
 #define OS_THREAD_RETURN return 0
 typedef DWORD (WINAPI *os_thread_func)(void*);
@@ -139,7 +233,7 @@ inline void os_startup(int argc, char **argv)
 
 	QueryPerformanceFrequency(&os_windows_performance_counter_freq);
 
-#ifdef BUILD_DEBUG
+#if defined(BUILD_DEBUG) || defined(BUILD_ALLOC_PROFILE)
 	SymSetOptions(SYMOPT_LOAD_LINES);
 	SymInitialize(GetCurrentProcess(), NULL, TRUE);
 #endif
@@ -167,11 +261,48 @@ inline bool os_thread_id_equal(os_thread_id a, os_thread_id b)
 	return a == b;
 }
 
+// Reserves a range of address space without any memory behind it
+inline void *os_memory_reserve(size_t size)
+{
+	return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+// Makes a page aligned part of a reserved range usable
+inline bool os_memory_commit(void *data, size_t size)
+{
+	return VirtualAlloc(data, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+}
+
+// Returns the memory of a page aligned part of a reserved range to the system
+// but keeps the addresses reserved
+inline void os_memory_decommit(void *data, size_t size)
+{
+	VirtualFree(data, size, MEM_DECOMMIT);
+}
+
+inline void os_memory_release(void *data, size_t size)
+{
+	VirtualFree(data, 0, MEM_RELEASE);
+}
+
+size_t g_os_memory_page_size;
+
+// Queried once, racing threads store the same value
+inline size_t os_memory_page_size()
+{
+	if (!g_os_memory_page_size) {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		g_os_memory_page_size = (size_t)info.dwPageSize;
+	}
+	return g_os_memory_page_size;
+}
+
 // Macro so the function doesn't get included in the trace
 #define os_capture_stack_trace(trace, count) \
 	CaptureStackBackTrace(0, (count), (trace), NULL);
 
-#ifdef BUILD_DEBUG
+#if defined(BUILD_DEBUG) || defined(BUILD_ALLOC_PROFILE)
 
 struct os_windows_symbol_info
 {
@@ -187,15 +318,15 @@ os_symbol_info *os_get_address_infos(void **addresses, int count)
 	if (!os_symbol_writer_begin(&w, count))
 		return 0;
 
-	for (int i = 0; i < count; i++) {
+	bool success = true;
+	for (int i = 0; success && i < count; i++) {
 
 		void *address = addresses[i];
 		IMAGEHLP_LINE64 line = { sizeof(line) };
 		DWORD displacement;
 		if (SymGetLineFromAddr64(process, (DWORD64)address, &displacement, &line)) {
 
-			if (!os_symbol_writer_set_location(&w, i, line.FileName, (int)strlen(line.FileName), line.LineNumber))
-				return false;
+			success = os_symbol_writer_set_location(&w, i, line.FileName, (int)strlen(line.FileName), line.LineNumber);
 
 		}
 
@@ -203,14 +334,18 @@ os_symbol_info *os_get_address_infos(void **addresses, int count)
 		symbol_info.info.SizeOfStruct = sizeof(symbol_info.info);
 		symbol_info.info.MaxNameLen = Count(symbol_info.buffer);
 		DWORD64 displacement64;
-		if (SymFromAddr(process, (DWORD64)address, &displacement64, &symbol_info.info)) {
+		if (success && SymFromAddr(process, (DWORD64)address, &displacement64, &symbol_info.info)) {
 
-			if (!os_symbol_writer_set_function(&w, i, symbol_info.info.Name, (int)symbol_info.info.NameLen))
-				return false;
+			success = os_symbol_writer_set_function(&w, i, symbol_info.info.Name, (int)symbol_info.info.NameLen);
 
 		}
 	}
 
+	if (!success) {
+		os_symbol_writer_abort(&w);
+		return 0;
+	}
+
 	return os_symbol_writer_finish(&w);
 }
 
@@ -0,0 +1,256 @@
+
+// Allocator for objects of one fixed size. Every thread keeps its own list of
+// free objects, so allocating and freeing is a pointer push or pop without any
+// locking. Threads only take the lock of the pool to move a batch of objects
+// between their own list and the shared one, which also lets an object be
+// freed on a different thread than the one that allocated it.
+//
+// Objects are carved out of slabs that are only returned to the system when the
+// whole pool is freed, so pools are meant for small objects. A thread must call
+// `pool_thread_flush` before it exits, or its cached objects are lost to the
+// pool. Threads that use more than POOL_THREAD_CACHES pools at once take the
+// lock of the pool for every object of the pools that don't fit.
+
+#define POOL_SLAB_SIZE KB(64)
+
+// Number of objects moved between the thread and shared lists at once
+#define POOL_BATCH 16
+
+// Number of pools a thread can have a free list for at the same time
+#define POOL_THREAD_CACHES 8
+
+struct Pool_Free
+{
+	Pool_Free *next;
+};
+
+struct Pool_Slab
+{
+	Pool_Slab *next;
+};
+
+struct Pool
+{
+	size_t object_size;
+	U32 objects_per_slab;
+	Mem_Tag tag;
+
+	// Unique for every initialized pool, so thread caches left over from a
+	// freed pool are not mistaken for a new pool at the same address
+	U32 id;
+
+	os_mutex lock;
+	Pool_Free *free;
+	Pool_Slab *slabs;
+};
+
+struct Pool_Thread_Cache
+{
+	Pool *pool;
+	U32 pool_id;
+	Pool_Free *free;
+	U32 count;
+};
+
+OS_THREAD_LOCAL Pool_Thread_Cache pool_thread_caches[POOL_THREAD_CACHES];
+os_atomic_uint32 g_pool_next_id;
+
+// Slabs are counted under `tag` whichever thread allocates them
+void pool_init(Pool *pool, size_t object_size, Mem_Tag tag=Mem_Tag_Inherit)
+{
+	// Objects are aligned like M_ALLOC allocations
+	object_size = max(object_size, sizeof(Pool_Free));
+	object_size = (object_size + 15) & ~(size_t)15;
+
+	pool->object_size = object_size;
+	pool->objects_per_slab = (U32)max(POOL_SLAB_SIZE / object_size, (size_t)1);
+#if BUILD_MEM_TAGS
+	pool->tag = mem_tag_resolve(tag);
+#else
+	pool->tag = tag;
+#endif
+	pool->id = os_atomic_increment(&g_pool_next_id);
+	os_mutex_init(&pool->lock);
+	pool->free = 0;
+	pool->slabs = 0;
+}
+
+// The slab header is stored after the objects
+inline char *pool_slab_objects(Pool *pool, Pool_Slab *slab)
+{
+	return (char*)slab - pool->object_size * pool->objects_per_slab;
+}
+
+// Frees all the memory of the pool, including objects that are still in use.
+// Drops the cache of the calling thread, the caches of other threads are left
+// unused and get reclaimed by their next pool.
+void pool_free(Pool *pool)
+{
+	for (U32 i = 0; i < POOL_THREAD_CACHES; i++) {
+		Pool_Thread_Cache *cache = &pool_thread_caches[i];
+		if (cache->pool == pool)
+			cache->pool = 0;
+	}
+
+	Pool_Slab *slab = pool->slabs;
+	while (slab) {
+		Pool_Slab *next = slab->next;
+		M_FREE(pool_slab_objects(pool, slab));
+		slab = next;
+	}
+	pool->slabs = 0;
+	pool->free = 0;
+	pool->id = 0;
+}
+
+// Returns the cache of the calling thread for the pool or null if the thread
+// has no free cache left
+Pool_Thread_Cache *pool_thread_cache(Pool *pool)
+{
+	Pool_Thread_Cache *empty = 0;
+	for (U32 i = 0; i < POOL_THREAD_CACHES; i++) {
+		Pool_Thread_Cache *cache = &pool_thread_caches[i];
+		if (cache->pool == pool) {
+			if (cache->pool_id == pool->id)
+				return cache;
+
+			// Left over from a freed pool at the same address, its objects
+			// are gone with it
+			cache->pool = 0;
+		}
+		if (!cache->pool && !empty)
+			empty = cache;
+	}
+
+	if (!empty)
+		return 0;
+	empty->pool = pool;
+	empty->pool_id = pool->id;
+	empty->free = 0;
+	empty->count = 0;
+	return empty;
+}
+
+// Adds a new slab to the shared list if it's empty, must be called with the
+// pool locked.
+void pool_grow_locked(Pool *pool)
+{
+	if (!pool->free) {
+		size_t objects_size = pool->object_size * pool->objects_per_slab;
+		char *object = (char*)M_ALLOC_RAW_TAGGED(objects_size + sizeof(Pool_Slab), pool->tag);
+		Pool_Slab *slab = (Pool_Slab*)(object + objects_size);
+		slab->next = pool->slabs;
+		pool->slabs = slab;
+
+		for (U32 i = 0; i < pool->objects_per_slab; i++) {
+			Pool_Free *entry = (Pool_Free*)object;
+			entry->next = pool->free;
+			pool->free = entry;
+			object += pool->object_size;
+		}
+	}
+}
+
+// Fills the thread list from the shared list, must be called with the pool
+// locked.
+void pool_refill_locked(Pool *pool, Pool_Thread_Cache *cache)
+{
+	pool_grow_locked(pool);
+	for (U32 i = 0; i < POOL_BATCH && pool->free; i++) {
+		Pool_Free *entry = pool->free;
+		pool->free = entry->next;
+		entry->next = cache->free;
+		cache->free = entry;
+		cache->count++;
+	}
+}
+
+// Moves `count` objects from the thread list to the shared list
+void pool_return(Pool *pool, Pool_Thread_Cache *cache, U32 count)
+{
+	os_mutex_lock(&pool->lock);
+	for (U32 i = 0; i < count && cache->free; i++) {
+		Pool_Free *entry = cache->free;
+		cache->free = entry->next;
+		entry->next = pool->free;
+		pool->free = entry;
+		cache->count--;
+	}
+	os_mutex_unlock(&pool->lock);
+}
+
+void *pool_alloc(Pool *pool)
+{
+	Pool_Thread_Cache *cache = pool_thread_cache(pool);
+	if (!cache) {
+		os_mutex_lock(&pool->lock);
+		pool_grow_locked(pool);
+		Pool_Free *entry = pool->free;
+		pool->free = entry->next;
+		os_mutex_unlock(&pool->lock);
+		return entry;
+	}
+
+	if (!cache->free) {
+		os_mutex_lock(&pool->lock);
+		pool_refill_locked(pool, cache);
+		os_mutex_unlock(&pool->lock);
+	}
+
+	Pool_Free *entry = cache->free;
+	cache->free = entry->next;
+	cache->count--;
+	return entry;
+}
+
+// Puts the object straight back on the shared list without touching the cache
+// of the calling thread. Meant for threads that only ever free one object of
+// the pool, for which filling and flushing a cache would cost more locking.
+void pool_release_shared(Pool *pool, void *object)
+{
+	if (!object)
+		return;
+
+	Pool_Free *entry = (Pool_Free*)object;
+	os_mutex_lock(&pool->lock);
+	entry->next = pool->free;
+	pool->free = entry;
+	os_mutex_unlock(&pool->lock);
+}
+
+void pool_release(Pool *pool, void *object)
+{
+	if (!object)
+		return;
+
+	Pool_Thread_Cache *cache = pool_thread_cache(pool);
+	if (!cache) {
+		pool_release_shared(pool, object);
+		return;
+	}
+
+	Pool_Free *entry = (Pool_Free*)object;
+
+	entry->next = cache->free;
+	cache->free = entry;
+	cache->count++;
+
+	// Threads that free more than they allocate give the objects back
+	if (cache->count >= 2 * POOL_BATCH)
+		pool_return(pool, cache, POOL_BATCH);
+}
+
+// Gives the cached objects of the calling thread back to the pool
+void pool_thread_flush(Pool *pool)
+{
+	for (U32 i = 0; i < POOL_THREAD_CACHES; i++) {
+		Pool_Thread_Cache *cache = &pool_thread_caches[i];
+		if (cache->pool != pool || cache->pool_id != pool->id)
+			continue;
+
+		pool_return(pool, cache, cache->count);
+		cache->pool = 0;
+	}
+}
+
+#define POOL_ALLOC(pool, type) (assert(sizeof(type) <= (pool)->object_size), (type*)pool_alloc(pool))
@@ -0,0 +1,206 @@
+// Compiles the assets under data/ into read-only data in the executable.
+//
+// This is a second pre-compile step that runs after pre_build, since it uses
+// the XML parser of the server which depends on the tables that pre_build
+// generates. The SVGs are parsed at build time and written out as arrays of
+// offsets into one string, so the server can use them without any parsing or
+// string table building at startup. The arrays contain no pointers and need no
+// relocations, the `SVG_Blob` referring to them is filled in by a generated
+// function.
+
+#include "../prelude.h"
+
+#include "../../gen/pre_output.cpp"
+#include "../source_loc.cpp"
+#include "../mem_tags.cpp"
+#include "../debug_alloc.cpp"
+#include "../strings.cpp"
+#include "../memory.cpp"
+#include "../string_table.cpp"
+#include "../scanner.cpp"
+#include "../printer.cpp"
+#include "../xml.cpp"
+#include "../svg.cpp"
+#include "pre_util.cpp"
+
+void pre_asset_error(const char *path, const char *message)
+{
+	fprintf(stderr, "%s: asset error: %s\n", path, message);
+	exit(1);
+}
+
+// Appends `str` to the text of the asset and returns its offset
+U32 pre_asset_text(char_List *text, String str)
+{
+	U32 offset = (U32)text->count;
+	list_push(text, str.data, str.length);
+	return offset;
+}
+
+void pre_write_asset_string(U32 offset, size_t length)
+{
+	fprintf(pre_out, "{ %u, %u }", offset, (U32)length);
+}
+
+void pre_write_asset_index(U32 index)
+{
+	if (index == XML_NO_NODE)
+		fprintf(pre_out, "XML_NO_NODE");
+	else
+		fprintf(pre_out, "%u", index);
+}
+
+void pre_create_svg_asset(const char *data_root, const char *name)
+{
+	char file_name[128];
+	snprintf(file_name, sizeof(file_name), "%s.svg", name);
+	char *path = combine_path(data_root, file_name);
+
+	FILE *file = fopen(path, "rb");
+	if (!file)
+		pre_asset_error(path, "could not open file");
+
+	fseek(file, 0, SEEK_END);
+	size_t size = (size_t)ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *source = M_ALLOC(char, size);
+	size_t num_read = fread(source, 1, size, file);
+	fclose(file);
+
+	SVG_XML svg = { 0 };
+	if (!parse_xml(&svg.xml, source, num_read, XML_Source_Borrow))
+		pre_asset_error(path, "failed to parse XML");
+	if (svg.xml.nodes.count == 0)
+		pre_asset_error(path, "no root element");
+	initialize_id_list(&svg);
+
+	XML *xml = &svg.xml;
+	String_List *names = &xml->string_table.strings;
+
+	// Collect all the strings into one array
+	char_List text = { 0 };
+	U32_List name_offsets = { 0 };
+	U32_List value_offsets = { 0 };
+	U32_List node_text_offsets = { 0 };
+	U32_List id_offsets = { 0 };
+
+	for (size_t i = 0; i < names->count; i++) {
+		U32 offset = pre_asset_text(&text, names->data[i]);
+		list_push(&name_offsets, &offset);
+	}
+	for (size_t i = 0; i < xml->attribute_values.count; i++) {
+		U32 offset = pre_asset_text(&text, xml->attribute_values.data[i]);
+		list_push(&value_offsets, &offset);
+	}
+	for (size_t i = 0; i < xml->nodes.count; i++) {
+		U32 offset = pre_asset_text(&text, xml->nodes.data[i].text);
+		list_push(&node_text_offsets, &offset);
+	}
+	for (size_t i = 0; i < svg.ids.count; i++) {
+		U32 offset = pre_asset_text(&text, svg.ids.data[i].id);
+		list_push(&id_offsets, &offset);
+	}
+
+	char text_name[128], names_name[128], nodes_name[128];
+	char keys_name[128], values_name[128], ids_name[128];
+	snprintf(text_name, sizeof(text_name), "asset_%s_text", name);
+	snprintf(names_name, sizeof(names_name), "asset_%s_names", name);
+	snprintf(nodes_name, sizeof(nodes_name), "asset_%s_nodes", name);
+	snprintf(keys_name, sizeof(keys_name), "asset_%s_attribute_keys", name);
+	snprintf(values_name, sizeof(values_name), "asset_%s_attribute_values", name);
+	snprintf(ids_name, sizeof(ids_name), "asset_%s_ids", name);
+
+	pre_create_loc_comment(make_source_loc(path, 1));
+
+	fprintf(pre_out, "const char %s[%u] =\n", text_name, (U32)text.count + 1);
+	pre_write_string_literal(text.data ? text.data : "", text.count);
+	fprintf(pre_out, ";\n\n");
+
+	fprintf(pre_out, "const XML_Blob_String %s[%u] = {\n", names_name, (U32)names->count);
+	for (size_t i = 0; i < names->count; i++) {
+		fprintf(pre_out, "\t");
+		pre_write_asset_string(name_offsets.data[i], names->data[i].length);
+		fprintf(pre_out, ",\n");
+	}
+	fprintf(pre_out, "};\n\n");
+
+	fprintf(pre_out, "const XML_Blob_Node %s[%u] = {\n", nodes_name, (U32)xml->nodes.count);
+	for (size_t i = 0; i < xml->nodes.count; i++) {
+		XML_Node *node = &xml->nodes.data[i];
+		fprintf(pre_out, "\t{ %u, ", node->tag);
+		pre_write_asset_index(node->parent);
+		fprintf(pre_out, ", ");
+		pre_write_asset_index(node->first_child);
+		fprintf(pre_out, ", ");
+		pre_write_asset_index(node->next_sibling);
+		fprintf(pre_out, ", %u, %u, %u, ", node->first_attribute, node->attribute_count, node->print_size);
+		pre_write_asset_string(node_text_offsets.data[i], node->text.length);
+		fprintf(pre_out, " },\n");
+	}
+	fprintf(pre_out, "};\n\n");
+
+	U32 attribute_count = (U32)xml->attribute_keys.count;
+	if (attribute_count > 0) {
+		pre_create_array_u32(keys_name, xml->attribute_keys.data, attribute_count, SOURCE_LOC);
+
+		fprintf(pre_out, "const XML_Blob_String %s[%u] = {\n", values_name, attribute_count);
+		for (U32 i = 0; i < attribute_count; i++) {
+			fprintf(pre_out, "\t");
+			pre_write_asset_string(value_offsets.data[i], xml->attribute_values.data[i].length);
+			fprintf(pre_out, ",\n");
+		}
+		fprintf(pre_out, "};\n\n");
+	}
+
+	if (svg.ids.count > 0) {
+		fprintf(pre_out, "const SVG_Blob_Id %s[%u] = {\n", ids_name, (U32)svg.ids.count);
+		for (size_t i = 0; i < svg.ids.count; i++) {
+			fprintf(pre_out, "\t{ ");
+			pre_write_asset_string(id_offsets.data[i], svg.ids.data[i].id.length);
+			fprintf(pre_out, ", %u },\n", svg.ids.data[i].node);
+		}
+		fprintf(pre_out, "};\n\n");
+	}
+
+	// The pointers are assigned in code, a static initializer would need a
+	// relocation for each of them.
+	fprintf(pre_out, "void asset_%s_blob(SVG_Blob *blob)\n{\n", name);
+	fprintf(pre_out, "\tblob->xml.text = %s;\n", text_name);
+	fprintf(pre_out, "\tblob->xml.nodes = %s;\n", nodes_name);
+	fprintf(pre_out, "\tblob->xml.node_count = %u;\n", (U32)xml->nodes.count);
+	fprintf(pre_out, "\tblob->xml.attribute_keys = %s;\n", attribute_count ? keys_name : "0");
+	fprintf(pre_out, "\tblob->xml.attribute_values = %s;\n", attribute_count ? values_name : "0");
+	fprintf(pre_out, "\tblob->xml.attribute_count = %u;\n", attribute_count);
+	fprintf(pre_out, "\tblob->xml.names = %s;\n", names_name);
+	fprintf(pre_out, "\tblob->xml.name_count = %u;\n", (U32)names->count);
+	fprintf(pre_out, "\tblob->ids = %s;\n", svg.ids.count ? ids_name : "0");
+	fprintf(pre_out, "\tblob->id_count = %u;\n", (U32)svg.ids.count);
+	fprintf(pre_out, "}\n\n");
+
+	list_free(&text);
+	list_free(&name_offsets);
+	list_free(&value_offsets);
+	list_free(&node_text_offsets);
+	list_free(&id_offsets);
+	list_free(&svg.ids);
+	xml_free(&svg.xml);
+	M_FREE(source);
+	M_FREE(path);
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+		return 1;
+
+	char *path = combine_path(argv[1], "pre_assets.cpp");
+	pre_out = fopen(path, "w");
+
+	pre_create_svg_asset(argv[2], "faces");
+
+	fclose(pre_out);
+	free(path);
+
+	return 0;
+}
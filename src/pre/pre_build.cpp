@@ -1,9 +1,12 @@
 #include "../prelude.h"
 #include "../source_loc.cpp"
+#include "../mem_tags.cpp"
 #include "../debug_alloc.cpp"
 #include "pre_util.cpp"
 #include "pre_deflate.cpp"
 #include "pre_string.cpp"
 #include "pre_utf.cpp"
+#include "pre_float.cpp"
+#include "pre_template.cpp"
 #include "pre_main.cpp"
 
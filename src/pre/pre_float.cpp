@@ -0,0 +1,143 @@
+
+// Minimal big unsigned integer for computing exact powers of ten
+struct Pre_Big
+{
+	U32 limbs[64];
+	int count;
+};
+
+void pre_big_set(Pre_Big *big, U32 value)
+{
+	memset(big, 0, sizeof(Pre_Big));
+	big->limbs[0] = value;
+	big->count = 1;
+}
+
+void pre_big_mul_add(Pre_Big *big, U32 mul, U32 add)
+{
+	U64 carry = add;
+	for (int i = 0; i < big->count; i++) {
+		U64 value = (U64)big->limbs[i] * mul + carry;
+		big->limbs[i] = (U32)value;
+		carry = value >> 32;
+	}
+	if (carry) {
+		assert(big->count < (int)Count(big->limbs));
+		big->limbs[big->count++] = (U32)carry;
+	}
+}
+
+int pre_big_bit_length(Pre_Big *big)
+{
+	int top = big->count - 1;
+	while (top > 0 && !big->limbs[top])
+		top--;
+	int bits = top * 32;
+	for (U32 v = big->limbs[top]; v; v >>= 1)
+		bits++;
+	return bits;
+}
+
+bool pre_big_bit(Pre_Big *big, int bit)
+{
+	int limb = bit / 32;
+	if (limb >= big->count)
+		return false;
+	return (big->limbs[limb] >> (bit % 32) & 1) != 0;
+}
+
+int pre_big_compare(Pre_Big *a, Pre_Big *b)
+{
+	int count = max(a->count, b->count);
+	for (int i = count - 1; i >= 0; i--) {
+		U32 av = i < a->count ? a->limbs[i] : 0;
+		U32 bv = i < b->count ? b->limbs[i] : 0;
+		if (av != bv)
+			return av < bv ? -1 : 1;
+	}
+	return 0;
+}
+
+// a -= b, requires a >= b
+void pre_big_sub(Pre_Big *a, Pre_Big *b)
+{
+	I64 borrow = 0;
+	for (int i = 0; i < a->count; i++) {
+		I64 value = (I64)a->limbs[i] - (i < b->count ? b->limbs[i] : 0) - borrow;
+		borrow = value < 0;
+		a->limbs[i] = (U32)value;
+	}
+}
+
+// Rounds a 65-bit value `high:low` (high is 0 or 1) to 64 bits
+void pre_round_65_bits(U64 *significand, int *exponent, U64 high, U64 low)
+{
+	U64 f = high << 63 | low >> 1;
+	if (low & 1) {
+		f++;
+		if (f == 0) {
+			f = (U64)1 << 63;
+			*exponent += 1;
+		}
+	}
+	*significand = f;
+	*exponent += 1;
+}
+
+// Computes the 64-bit normalized significand and binary exponent of 10^power
+// rounded to nearest, so that 10^power ~= significand * 2^exponent.
+void pre_pow10_diy_fp(U64 *significand, int *exponent, int power)
+{
+	Pre_Big ten;
+	pre_big_set(&ten, 1);
+	for (int i = 0; i < (power < 0 ? -power : power); i++)
+		pre_big_mul_add(&ten, 10, 0);
+
+	int length = pre_big_bit_length(&ten);
+
+	if (power >= 0) {
+		// Take the top 65 bits of 10^power
+		U64 high = 0, low = 0;
+		for (int i = 0; i < 65; i++) {
+			int bit = length - 1 - i;
+			high = high << 1 | low >> 63;
+			low = low << 1 | (bit >= 0 && pre_big_bit(&ten, bit) ? 1 : 0);
+		}
+		*exponent = length - 65;
+		pre_round_65_bits(significand, exponent, high, low);
+	} else {
+		// Long division 2^shift / 10^-power, the quotient has 65 bits
+		int shift = length + 64;
+		Pre_Big rem;
+		pre_big_set(&rem, 0);
+		U64 high = 0, low = 0;
+		for (int bit = shift; bit >= 0; bit--) {
+			pre_big_mul_add(&rem, 2, bit == shift ? 1 : 0);
+			U64 q = 0;
+			if (pre_big_compare(&rem, &ten) >= 0) {
+				pre_big_sub(&rem, &ten);
+				q = 1;
+			}
+			high = high << 1 | low >> 63;
+			low = low << 1 | q;
+		}
+		assert(high <= 1);
+		*exponent = -shift;
+		pre_round_65_bits(significand, exponent, high, low);
+	}
+}
+
+// Cached powers of ten for Grisu float formatting (see printer.cpp), from
+// 10^-348 to 10^340 in steps of 8.
+void make_cached_pow10_table()
+{
+	U64 significands[87];
+	I32 exponents[87];
+
+	for (int i = 0; i < (int)Count(significands); i++) {
+		pre_pow10_diy_fp(&significands[i], &exponents[i], -348 + i * 8);
+	}
+
+	pre_create_array_u64("cached_pow10_significands", significands, Count(significands), SOURCE_LOC);
+	pre_create_array_i32("cached_pow10_exponents", exponents, Count(exponents), SOURCE_LOC);
+}
@@ -1,30 +1,7 @@
 
-char *combine_path(const char *root, const char *path)
-{
-	size_t root_len = strlen(root);
-	size_t path_len = strlen(path);
-
-	char *result_buffer = M_ALLOC(char, root_len + path_len + 2);
-	char *result_ptr = result_buffer;
-
-	memcpy(result_ptr, root, root_len);
-	result_ptr += root_len;
-
-	if (path_len != 0 && result_ptr[-1] == '/') {
-		*result_ptr++ = '/';
-	}
-
-	memcpy(result_ptr, path, path_len);
-	result_ptr += path_len;
-
-	*result_ptr = '\0';
-
-	return result_buffer;
-}
-
 int main(int argc, char** argv)
 {
-	if (argc < 2)
+	if (argc < 3)
 		return 1;
 
 	char *path = combine_path(argv[1], "pre_output.cpp");
@@ -33,7 +10,18 @@ int main(int argc, char** argv)
 	make_crc32_table();
 	make_all_chars_table();
 	make_char_to_digit_table();
+	make_char_class_table();
 	make_utf8_code_extra_table();
+	make_cached_pow10_table();
+
+	fclose(pre_out);
+	free(path);
+
+	path = combine_path(argv[1], "pre_templates.cpp");
+	pre_out = fopen(path, "w");
+
+	make_templates(argv[2], "dorf");
+	make_templates(argv[2], "server");
 
 	fclose(pre_out);
 	free(path);
@@ -28,3 +28,33 @@ void make_char_to_digit_table()
 	pre_create_array_u8("char_to_digit_table", table, Count(table), SOURCE_LOC);
 }
 
+// Character classes used by the scanners. The flags are generated as defines
+// alongside the table so both are always in sync.
+void make_char_class_table()
+{
+	const U8 whitespace = 0x01;
+	const U8 xml_name_start = 0x02;
+	const U8 xml_name = 0x04;
+
+	fprintf(pre_out, "#define CHAR_CLASS_WHITESPACE 0x%02x\n", whitespace);
+	fprintf(pre_out, "#define CHAR_CLASS_XML_NAME_START 0x%02x\n", xml_name_start);
+	fprintf(pre_out, "#define CHAR_CLASS_XML_NAME 0x%02x\n", xml_name);
+	fprintf(pre_out, "\n");
+
+	U8 table[256];
+	memset(table, 0, sizeof(table));
+
+	table[' '] |= whitespace;
+	table['\n'] |= whitespace;
+	table['\r'] |= whitespace;
+	table['\t'] |= whitespace;
+
+	for (int c = 0; c < 256; c++) {
+		bool name_start = c >= 'A' && c <= 'Z' || c >= 'a' && c <= 'z' || c == ':' || c == '_';
+		bool name = name_start || c >= '0' && c <= '9' || c == '-' || c == '.';
+		if (name_start) table[c] |= xml_name_start;
+		if (name) table[c] |= xml_name;
+	}
+
+	pre_create_array_u8("char_class_table", table, Count(table), SOURCE_LOC);
+}
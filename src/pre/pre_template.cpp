@@ -0,0 +1,342 @@
+// Compiles the HTML templates under data/templates/ into C++ functions.
+//
+// A template file contains any number of templates of the form:
+//
+//   @template dwarves_row(u32 id, cstr name)
+//   <tr><td><a href="/entities/{id}">{name}</a></td></tr>
+//   @end
+//
+// Everything outside of `@template` blocks is ignored and can be used for
+// comments. The text of the template is used as-is except for the final line
+// break before `@end`. Holes are written as `{name}` and must refer to one of
+// the parameters of the template, `{{` is a literal `{`. Floats are printed in
+// their shortest form, `f64` holes may also have a fixed precision: `{value:.2}`.
+//
+// Every template compiles into a function `tmpl_<name>(Printer *p, ...)` that
+// returns false if the printer runs out of space. All the static text of a file
+// is stored in one array and the generated code only prints spans of it and
+// calls the typed emitters of printer.cpp, so there is no format string
+// interpretation at runtime.
+
+#include <stdarg.h>
+
+struct Pre_Template_Type
+{
+	const char *name;
+	const char *c_type;
+	const char *emitter;
+	bool has_precision;
+} pre_template_types[] = {
+	{ "u32", "U32", "print_u32", false },
+	{ "i32", "I32", "print_i32", false },
+	{ "u64", "U64", "print_u64", false },
+	{ "chr", "char", "print", false },
+	{ "str", "String", "print_escaped", false },
+	{ "cstr", "const char *", "print_escaped", false },
+	{ "html", "String", "print", false },
+	{ "f32", "float", "print_f32", false },
+	{ "f64", "double", "print_f64", true },
+};
+
+struct Pre_Template_Param
+{
+	char name[64];
+	Pre_Template_Type *type;
+};
+
+// Growable text buffer for collecting generated code before writing it.
+struct Pre_Buffer
+{
+	char *data;
+	size_t length, capacity;
+};
+
+void pre_buffer_append(Pre_Buffer *buf, const char *data, size_t length)
+{
+	if (buf->length + length + 1 > buf->capacity) {
+		size_t new_capacity = max(buf->capacity * 2, buf->length + length + 1);
+		buf->data = M_REALLOC(buf->data, char, new_capacity);
+		buf->capacity = new_capacity;
+	}
+	memcpy(buf->data + buf->length, data, length);
+	buf->length += length;
+	buf->data[buf->length] = '\0';
+}
+
+void pre_buffer_printf(Pre_Buffer *buf, const char *format, ...)
+{
+	char line[1024];
+	va_list args;
+	va_start(args, format);
+	int length = vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
+	assert(length >= 0 && length < (int)sizeof(line));
+	pre_buffer_append(buf, line, length);
+}
+
+void pre_template_error(const char *path, int line, const char *message)
+{
+	fprintf(stderr, "%s:%d: template error: %s\n", path, line, message);
+	exit(1);
+}
+
+Pre_Template_Type *pre_template_find_type(const char *name, size_t length)
+{
+	for (U32 i = 0; i < Count(pre_template_types); i++) {
+		Pre_Template_Type *type = &pre_template_types[i];
+		if (strlen(type->name) == length && !memcmp(type->name, name, length))
+			return type;
+	}
+	return 0;
+}
+
+inline bool pre_is_ident_char(char c)
+{
+	return c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z' || c >= '0' && c <= '9' || c == '_';
+}
+
+const char *pre_skip_spaces(const char *pos)
+{
+	while (*pos == ' ' || *pos == '\t')
+		pos++;
+	return pos;
+}
+
+// Parses the header `name(type name, ...)` of a template into `code` and
+// `params`, returns the parameter count.
+int pre_template_header(Pre_Buffer *code, Pre_Template_Param *params, int max_params,
+	const char *header, const char *path, int line)
+{
+	const char *pos = pre_skip_spaces(header);
+	const char *name = pos;
+	while (pre_is_ident_char(*pos))
+		pos++;
+	int name_length = (int)(pos - name);
+	if (name_length == 0)
+		pre_template_error(path, line, "expected template name");
+
+	pre_buffer_printf(code, "bool tmpl_%.*s(Printer *p", name_length, name);
+
+	int param_count = 0;
+	pos = pre_skip_spaces(pos);
+	if (*pos == '(') {
+		pos = pre_skip_spaces(pos + 1);
+		while (*pos != ')') {
+			if (param_count == max_params)
+				pre_template_error(path, line, "too many parameters");
+
+			const char *type_name = pos;
+			while (pre_is_ident_char(*pos))
+				pos++;
+			Pre_Template_Type *type = pre_template_find_type(type_name, pos - type_name);
+			if (!type)
+				pre_template_error(path, line, "unknown parameter type");
+
+			pos = pre_skip_spaces(pos);
+			const char *param_name = pos;
+			while (pre_is_ident_char(*pos))
+				pos++;
+			size_t param_length = pos - param_name;
+			if (param_length == 0 || param_length >= sizeof(params->name))
+				pre_template_error(path, line, "bad parameter name");
+
+			Pre_Template_Param *param = &params[param_count++];
+			memcpy(param->name, param_name, param_length);
+			param->name[param_length] = '\0';
+			param->type = type;
+
+			const char *space = type->c_type[strlen(type->c_type) - 1] == '*' ? "" : " ";
+			pre_buffer_printf(code, ", %s%s%s", type->c_type, space, param->name);
+
+			pos = pre_skip_spaces(pos);
+			if (*pos == ',') {
+				pos = pre_skip_spaces(pos + 1);
+			} else if (*pos != ')') {
+				pre_template_error(path, line, "expected ',' or ')'");
+			}
+		}
+	}
+
+	pre_buffer_printf(code, ")\n{\n");
+	return param_count;
+}
+
+// Compiles the body of one template. Static text is appended to `text` and
+// referenced by offset from the generated code.
+void pre_template_body(Pre_Buffer *code, Pre_Buffer *text, const char *text_name,
+	Pre_Template_Param *params, int param_count,
+	const char *body, const char *body_end, const char *path, int line)
+{
+	int emit_count = 0;
+	size_t span_start = text->length;
+
+	const char *pos = body;
+	while (pos != body_end) {
+		if (pos[0] == '{' && pos + 1 == body_end)
+			pre_template_error(path, line, "unterminated hole");
+		bool hole = pos[0] == '{' && pos[1] != '{';
+
+		if (!hole) {
+			if (*pos == '\n')
+				line++;
+			pre_buffer_append(text, pos, 1);
+			pos += *pos == '{' ? 2 : 1;
+			continue;
+		}
+
+		// Flush the static text before the hole
+		if (text->length > span_start) {
+			pre_buffer_printf(code, "\t%s print(p, to_string(%s + %u, %u))\n",
+				emit_count++ ? "\t&&" : "return",
+				text_name, (U32)span_start, (U32)(text->length - span_start));
+		}
+
+		const char *name = ++pos;
+		while (pos != body_end && pre_is_ident_char(*pos))
+			pos++;
+		size_t name_length = pos - name;
+
+		int precision = -1;
+		if (pos != body_end && *pos == ':') {
+			if (pos + 1 == body_end || pos[1] != '.')
+				pre_template_error(path, line, "expected '.' in hole format");
+			pos += 2;
+			precision = 0;
+			while (pos != body_end && *pos >= '0' && *pos <= '9')
+				precision = precision * 10 + (*pos++ - '0');
+		}
+		if (pos == body_end || *pos != '}')
+			pre_template_error(path, line, "unterminated hole");
+		pos++;
+
+		Pre_Template_Param *param = 0;
+		for (int i = 0; i < param_count; i++) {
+			if (strlen(params[i].name) == name_length && !memcmp(params[i].name, name, name_length))
+				param = &params[i];
+		}
+		if (!param)
+			pre_template_error(path, line, "hole does not name a parameter");
+
+		const char *prefix = emit_count++ ? "\t&&" : "return";
+		if (precision >= 0) {
+			if (!param->type->has_precision)
+				pre_template_error(path, line, "precision on a non-float hole");
+			pre_buffer_printf(code, "\t%s %s_fixed(p, %s, %d)\n",
+				prefix, param->type->emitter, param->name, precision);
+		} else {
+			pre_buffer_printf(code, "\t%s %s(p, %s)\n",
+				prefix, param->type->emitter, param->name);
+		}
+
+		span_start = text->length;
+	}
+
+	if (text->length > span_start) {
+		pre_buffer_printf(code, "\t%s print(p, to_string(%s + %u, %u))\n",
+			emit_count++ ? "\t&&" : "return",
+			text_name, (U32)span_start, (U32)(text->length - span_start));
+	}
+
+	if (emit_count == 0) {
+		pre_buffer_printf(code, "\treturn true;\n}\n\n");
+	} else {
+		// Replace the final newline with the end of the statement
+		code->length--;
+		pre_buffer_printf(code, ";\n}\n\n");
+	}
+}
+
+void make_templates(const char *data_root, const char *name)
+{
+	char file_name[128];
+	snprintf(file_name, sizeof(file_name), "templates/%s.tmpl", name);
+	char *path = combine_path(data_root, file_name);
+
+	FILE *file = fopen(path, "rb");
+	if (!file)
+		pre_template_error(path, 0, "could not open file");
+
+	fseek(file, 0, SEEK_END);
+	size_t size = (size_t)ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *source = M_ALLOC(char, size + 1);
+	size_t num_read = fread(source, 1, size, file);
+	source[num_read] = '\0';
+	fclose(file);
+
+	char text_name[128];
+	snprintf(text_name, sizeof(text_name), "tmpl_%s_text", name);
+
+	Pre_Buffer code = { 0 };
+	Pre_Buffer text = { 0 };
+
+	const char *pos = source;
+	int line = 1;
+	while (*pos) {
+		const char *line_end = strchr(pos, '\n');
+		if (!line_end) line_end = pos + strlen(pos);
+		const char *next = *line_end ? line_end + 1 : line_end;
+
+		if (strncmp(pos, "@template ", 10)) {
+			pos = next;
+			line++;
+			continue;
+		}
+
+		int header_line = line;
+		char header[512];
+		size_t header_length = line_end - (pos + 10);
+		if (header_length >= sizeof(header))
+			pre_template_error(path, line, "header too long");
+		memcpy(header, pos + 10, header_length);
+		header[header_length] = '\0';
+
+		// Find the matching `@end` line
+		const char *body = next;
+		const char *end = body;
+		int body_lines = 0;
+		for (;;) {
+			if (!*end)
+				pre_template_error(path, header_line, "missing @end");
+			if (!strncmp(end, "@end", 4) && (end[4] == '\n' || end[4] == '\r' || !end[4]))
+				break;
+			const char *body_line_end = strchr(end, '\n');
+			if (!body_line_end)
+				pre_template_error(path, header_line, "missing @end");
+			end = body_line_end + 1;
+			body_lines++;
+		}
+
+		// The line break before `@end` is not part of the template
+		const char *body_end = end;
+		if (body_end > body && body_end[-1] == '\n') body_end--;
+		if (body_end > body && body_end[-1] == '\r') body_end--;
+
+		char loc_comment[256];
+		snprintf(loc_comment, sizeof(loc_comment), "// Generated from %s:%d\n", path, header_line);
+		pre_buffer_append(&code, loc_comment, strlen(loc_comment));
+
+		Pre_Template_Param params[16];
+		int param_count = pre_template_header(&code, params, Count(params), header, path, header_line);
+		pre_template_body(&code, &text, text_name, params, param_count,
+			body, body_end, path, header_line + 1);
+
+		pos = strchr(end, '\n');
+		pos = pos ? pos + 1 : end + strlen(end);
+		line = header_line + body_lines + 2;
+	}
+
+	pre_create_loc_comment(make_source_loc(path, 1));
+	fprintf(pre_out, "const char %s[%u] =\n", text_name, (U32)text.length + 1);
+	pre_write_string_literal(text.data ? text.data : "", text.length);
+	fprintf(pre_out, ";\n\n");
+
+	if (code.data)
+		fwrite(code.data, 1, code.length, pre_out);
+
+	M_FREE(code.data);
+	M_FREE(text.data);
+	M_FREE(source);
+	M_FREE(path);
+}
@@ -40,3 +40,84 @@ void pre_create_array_u32(const char *name, U32 *values, U32 count, Source_Loc l
 	fprintf(pre_out, "};\n\n");
 }
 
+void pre_create_array_u64(const char *name, U64 *values, U32 count, Source_Loc loc)
+{
+	pre_create_loc_comment(loc);
+
+	fprintf(pre_out, "const uint64_t %s[%u] = {\n", name, count);
+	U32 index = 0;
+	while (index < count) {
+		fprintf(pre_out, "\t");
+		for (uint32_t i = index; i < min(index + 4, count); i++) {
+			fprintf(pre_out, "0x%016llx, ", (unsigned long long)values[i]);
+		}
+		index += 4;
+		fprintf(pre_out, "\n");
+	}
+	fprintf(pre_out, "};\n\n");
+}
+
+void pre_create_array_i32(const char *name, I32 *values, U32 count, Source_Loc loc)
+{
+	pre_create_loc_comment(loc);
+
+	fprintf(pre_out, "const int32_t %s[%u] = {\n", name, count);
+	U32 index = 0;
+	while (index < count) {
+		fprintf(pre_out, "\t");
+		for (uint32_t i = index; i < min(index + 8, count); i++) {
+			fprintf(pre_out, "%d, ", values[i]);
+		}
+		index += 8;
+		fprintf(pre_out, "\n");
+	}
+	fprintf(pre_out, "};\n\n");
+}
+
+char *combine_path(const char *root, const char *path)
+{
+	size_t root_len = strlen(root);
+	size_t path_len = strlen(path);
+
+	char *result_buffer = M_ALLOC(char, root_len + path_len + 2);
+	char *result_ptr = result_buffer;
+
+	memcpy(result_ptr, root, root_len);
+	result_ptr += root_len;
+
+	if (path_len != 0 && result_ptr[-1] != '/') {
+		*result_ptr++ = '/';
+	}
+
+	memcpy(result_ptr, path, path_len);
+	result_ptr += path_len;
+
+	*result_ptr = '\0';
+
+	return result_buffer;
+}
+
+// Writes `data` as a string literal split at line breaks
+void pre_write_string_literal(const char *data, size_t length)
+{
+	fprintf(pre_out, "\t\"");
+	for (size_t i = 0; i < length; i++) {
+		U8 c = (U8)data[i];
+		if (c == '\n') {
+			fprintf(pre_out, "\\n\"");
+			if (i + 1 < length)
+				fprintf(pre_out, "\n\t\"");
+			else
+				return;
+		} else if (c == '"' || c == '\\') {
+			fprintf(pre_out, "\\%c", c);
+		} else if (c < 0x20 || c >= 0x7F || c == '?') {
+			// Octal escapes have a fixed length unlike hex ones, also escape
+			// '?' to avoid accidental trigraphs.
+			fprintf(pre_out, "\\%03o", c);
+		} else {
+			fputc(c, pre_out);
+		}
+	}
+	fprintf(pre_out, "\"");
+}
@@ -15,6 +15,11 @@ typedef int32_t I32;
 typedef uint32_t U32;
 typedef int64_t I64;
 typedef uint64_t U64;
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BUILD_SSE2 1
+#endif
+
 #define Count(array) (sizeof(array)/sizeof(*(array)))
 
 #define min(a, b) ((a) < (b) ? (a) : (b))
@@ -23,6 +28,46 @@ typedef uint64_t U64;
 #define KB(amount) ((amount) * 1024)
 #define MB(amount) (KB(amount) * 1024)
 
+// Index of the lowest set bit, `value` must not be zero
+#ifdef _MSC_VER
+#include <intrin.h>
+inline U32 count_trailing_zeros(U32 value)
+{
+	unsigned long index;
+	_BitScanForward(&index, value);
+	return (U32)index;
+}
+#else
+inline U32 count_trailing_zeros(U32 value)
+{
+	return (U32)__builtin_ctz(value);
+}
+#endif
+
+// Keeps a function out of its callers, eg. so it shows up in stack traces
+#ifdef _MSC_VER
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+
+// Alignment of a type, VS2013 doesn't have the C++11 keyword yet
+#ifdef _MSC_VER
+#define ALIGNOF(type) __alignof(type)
+#else
+#define ALIGNOF(type) alignof(type)
+#endif
+
+// Aligns a struct to its own cache lines, so neighbouring elements of an array
+// don't share any. Used for shards that are written by different threads.
+// MSVC warns about the padding this adds (C4324), build.bat disables it.
+#define CACHE_LINE_SIZE 64
+#ifdef _MSC_VER
+#define CACHE_ALIGNED __declspec(align(64))
+#else
+#define CACHE_ALIGNED __attribute__((aligned(64)))
+#endif
+
 #ifndef UINT32_MAX
 #define UINT32_MAX 0xFFFFFFFF
 #endif
@@ -1,4 +1,3 @@
-
 struct Printer
 {
 	char *pos;
@@ -28,8 +27,604 @@ inline bool print(Printer *p, const char* str)
 	return print(p, c_string(str));
 }
 
-inline bool print(Printer *p, Interned_String str)
+
+// HTML escaping: `<>&"'` are replaced with entities so the text is safe to
+// place both in elements and in quoted attribute values.
+
+inline bool html_needs_escape(char c)
+{
+	return c == '<' || c == '>' || c == '&' || c == '"' || c == '\'';
+}
+
+String html_escape_entity(char c)
+{
+	switch (c) {
+	case '<': return to_string("&lt;", 4);
+	case '>': return to_string("&gt;", 4);
+	case '&': return to_string("&amp;", 5);
+	case '"': return to_string("&quot;", 6);
+	case '\'': return to_string("&#39;", 5);
+	}
+	return char_string(c);
+}
+
+// Returns the first character in [pos, end) that needs escaping or `end`
+inline const char *html_escape_find(const char *pos, const char *end)
+{
+#if BUILD_SSE2
+	const __m128i lt = _mm_set1_epi8('<');
+	const __m128i gt = _mm_set1_epi8('>');
+	const __m128i amp = _mm_set1_epi8('&');
+	const __m128i quot = _mm_set1_epi8('"');
+	const __m128i apos = _mm_set1_epi8('\'');
+
+	while (end - pos >= 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)pos);
+		__m128i match = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, lt), _mm_cmpeq_epi8(chunk, gt)),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, amp),
+				_mm_or_si128(_mm_cmpeq_epi8(chunk, quot), _mm_cmpeq_epi8(chunk, apos))));
+		int mask = _mm_movemask_epi8(match);
+		if (mask)
+			return pos + count_trailing_zeros((U32)mask);
+		pos += 16;
+	}
+#endif
+
+	for (; pos != end; pos++) {
+		if (html_needs_escape(*pos))
+			return pos;
+	}
+	return end;
+}
+
+// Prints `str` HTML escaped, the runs between escaped characters are copied
+// as whole.
+bool print_escaped(Printer *p, String str)
+{
+	const char *pos = str.data;
+	const char *end = pos + str.length;
+
+	for (;;) {
+		const char *run_end = html_escape_find(pos, end);
+		if (!print(p, to_string(pos, run_end)))
+			return false;
+		if (run_end == end)
+			return true;
+		if (!print(p, html_escape_entity(*run_end)))
+			return false;
+		pos = run_end + 1;
+	}
+}
+
+inline bool print_escaped(Printer *p, const char *str)
+{
+	return print_escaped(p, c_string(str));
+}
+
+// Length of `str` after HTML escaping
+size_t escaped_length(String str)
+{
+	const char *pos = str.data;
+	const char *end = pos + str.length;
+
+	size_t length = str.length;
+	for (;;) {
+		pos = html_escape_find(pos, end);
+		if (pos == end)
+			return length;
+		length += html_escape_entity(*pos).length - 1;
+		pos++;
+	}
+}
+
+// Copies `str` HTML escaped to `dst` without bounds checks, the space must be
+// reserved using `escaped_length`. Returns the end of the written text.
+char *copy_escaped(char *dst, String str)
+{
+	const char *pos = str.data;
+	const char *end = pos + str.length;
+
+	for (;;) {
+		const char *run_end = html_escape_find(pos, end);
+		memcpy(dst, pos, run_end - pos);
+		dst += run_end - pos;
+		if (run_end == end)
+			return dst;
+		String entity = html_escape_entity(*run_end);
+		memcpy(dst, entity.data, entity.length);
+		dst += entity.length;
+		pos = run_end + 1;
+	}
+}
+
+inline Printer make_printer(char *buffer, size_t size)
+{
+	Printer p;
+	p.pos = buffer;
+	p.end = buffer + size;
+	return p;
+}
+
+// Reserves `size` bytes to be written directly, returns null if there is not
+// enough space left.
+inline char *print_reserve(Printer *p, size_t size)
+{
+	if ((size_t)(p->end - p->pos) < size)
+		return 0;
+	char *dst = p->pos;
+	p->pos += size;
+	return dst;
+}
+
+bool print_u64(Printer *p, U64 value)
+{
+	// Write the digits backwards to the end of a local buffer
+	char digits[20];
+	char *end = digits + sizeof(digits);
+	char *ptr = end;
+	do {
+		*--ptr = (char)('0' + value % 10);
+		value /= 10;
+	} while (value);
+
+	return print(p, to_string(ptr, end));
+}
+
+inline bool print_u32(Printer *p, U32 value)
+{
+	return print_u64(p, value);
+}
+
+inline bool print_i32(Printer *p, I32 value)
+{
+	if (value < 0) {
+		return print(p, '-') && print_u64(p, (U64)-(I64)value);
+	}
+	return print_u64(p, (U64)value);
+}
+
+// Floating point formatting using the Grisu2 algorithm by Florian Loitsch,
+// "Printing Floating-Point Numbers Quickly and Accurately with Integers".
+// It produces the shortest (in all but rare cases) decimal digits that still
+// round-trip to the same value using only 64-bit integer arithmetic.
+
+// Floating point number `f * 2^e` with a 64-bit significand
+struct Diy_Fp
+{
+	U64 f;
+	int e;
+};
+
+inline Diy_Fp diy_fp(U64 f, int e)
+{
+	Diy_Fp result = { f, e };
+	return result;
+}
+
+inline Diy_Fp diy_fp_normalize(Diy_Fp v)
+{
+	while (!(v.f & (U64)1 << 63)) {
+		v.f <<= 1;
+		v.e--;
+	}
+	return v;
+}
+
+// Upper 64 bits of the 128-bit product, rounded
+inline Diy_Fp diy_fp_multiply(Diy_Fp x, Diy_Fp y)
+{
+	U64 a = x.f >> 32, b = x.f & 0xFFFFFFFF;
+	U64 c = y.f >> 32, d = y.f & 0xFFFFFFFF;
+	U64 ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+	U64 mid = (bd >> 32) + (ad & 0xFFFFFFFF) + (bc & 0xFFFFFFFF);
+	mid += (U64)1 << 31;
+	return diy_fp(ac + (ad >> 32) + (bc >> 32) + (mid >> 32), x.e + y.e + 64);
+}
+
+// Returns a cached power of ten `c` and its decimal exponent `k` so that the
+// binary exponent of `c * 2^e` is within [-60, -32]. The table generated by
+// pre/pre_float.cpp starts from 10^-348 with a stride of 8.
+inline Diy_Fp cached_pow10(int e, int *k)
+{
+	// ceil((-61 - e) * log10(2)) offset by 348 to keep it positive
+	double dk = (-61 - e) * 0.30102999566398114 + 347;
+	int index = (int)dk;
+	if (dk - index > 0.0) index++;
+	index = (index >> 3) + 1;
+
+	*k = -(-348 + index * 8);
+	return diy_fp(cached_pow10_significands[index], cached_pow10_exponents[index]);
+}
+
+const U32 pow10_u32_table[] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+// Nudge the last digit towards `w` while the result stays within the bounds
+inline void grisu_round(char *digits, int length, U64 delta, U64 rest, U64 ten_kappa, U64 wp_w)
+{
+	while (rest < wp_w && delta - rest >= ten_kappa
+		&& (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+		digits[length - 1]--;
+		rest += ten_kappa;
+	}
+}
+
+// Generates the shortest digits of `w` that are within the bounds, where `mp`
+// is the upper bound and `delta` the distance to the lower one.
+int grisu_digit_gen(char *digits, int *k, Diy_Fp w, Diy_Fp mp, U64 delta)
+{
+	Diy_Fp one = diy_fp((U64)1 << -mp.e, mp.e);
+	U64 wp_w = mp.f - w.f;
+	U32 p1 = (U32)(mp.f >> -one.e);
+	U64 p2 = mp.f & (one.f - 1);
+
+	int kappa = 1;
+	while (kappa < 10 && p1 >= pow10_u32_table[kappa])
+		kappa++;
+
+	int length = 0;
+	while (kappa > 0) {
+		U32 divisor = pow10_u32_table[kappa - 1];
+		U32 d = p1 / divisor;
+		p1 %= divisor;
+		if (d || length)
+			digits[length++] = (char)('0' + d);
+		kappa--;
+
+		U64 rest = ((U64)p1 << -one.e) + p2;
+		if (rest <= delta) {
+			*k += kappa;
+			grisu_round(digits, length, delta, rest, (U64)pow10_u32_table[kappa] << -one.e, wp_w);
+			return length;
+		}
+	}
+
+	for (;;) {
+		p2 *= 10;
+		delta *= 10;
+		char d = (char)(p2 >> -one.e);
+		if (d || length)
+			digits[length++] = (char)('0' + d);
+		p2 &= one.f - 1;
+		kappa--;
+		if (p2 < delta) {
+			*k += kappa;
+			int index = -kappa;
+			grisu_round(digits, length, delta, p2, one.f, wp_w * (index < 10 ? pow10_u32_table[index] : 0));
+			return length;
+		}
+	}
+}
+
+// Writes the shortest digits of the positive number `f * 2^e` to `digits` so
+// that value = digits * 10^k. `hidden_bit` is the implicit leading bit of the
+// source format, which determines the rounding boundaries.
+int grisu2(char *digits, int *k, U64 f, int e, U64 hidden_bit)
+{
+	Diy_Fp v = diy_fp(f, e);
+
+	// The boundaries are halfway to the neighbouring representable values,
+	// the lower one is closer when `v` is an exact power of two.
+	Diy_Fp plus = diy_fp_normalize(diy_fp((v.f << 1) + 1, v.e - 1));
+	Diy_Fp minus = v.f == hidden_bit
+		? diy_fp((v.f << 2) - 1, v.e - 2)
+		: diy_fp((v.f << 1) - 1, v.e - 1);
+	minus.f <<= minus.e - plus.e;
+	minus.e = plus.e;
+
+	Diy_Fp c = cached_pow10(plus.e, k);
+	Diy_Fp w = diy_fp_multiply(diy_fp_normalize(v), c);
+	Diy_Fp wp = diy_fp_multiply(plus, c);
+	Diy_Fp wm = diy_fp_multiply(minus, c);
+
+	// Shrink the range by one unit to stay conservative about the rounding
+	// error of the multiplications.
+	wm.f++;
+	wp.f--;
+	return grisu_digit_gen(digits, k, w, wp, wp.f - wm.f);
+}
+
+// Decimal digits of a float: value = digits * 10^exponent
+struct Float_Digits
+{
+	char digits[20];
+	int length;
+	int exponent;
+};
+
+// Returns false for infinities and NaNs
+bool float_digits_f64(Float_Digits *result, double value)
+{
+	U64 bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	int biased_e = (int)(bits >> 52 & 0x7FF);
+	U64 significand = bits & (((U64)1 << 52) - 1);
+	if (biased_e == 0x7FF)
+		return false;
+
+	if (biased_e == 0 && significand == 0) {
+		result->digits[0] = '0';
+		result->length = 1;
+		result->exponent = 0;
+		return true;
+	}
+
+	U64 hidden_bit = (U64)1 << 52;
+	if (biased_e != 0) {
+		result->length = grisu2(result->digits, &result->exponent,
+			significand + hidden_bit, biased_e - 1075, hidden_bit);
+	} else {
+		result->length = grisu2(result->digits, &result->exponent,
+			significand, 1 - 1075, hidden_bit);
+	}
+	return true;
+}
+
+bool float_digits_f32(Float_Digits *result, float value)
+{
+	U32 bits;
+	memcpy(&bits, &value, sizeof(bits));
+
+	int biased_e = (int)(bits >> 23 & 0xFF);
+	U64 significand = bits & ((1U << 23) - 1);
+	if (biased_e == 0xFF)
+		return false;
+
+	if (biased_e == 0 && significand == 0) {
+		result->digits[0] = '0';
+		result->length = 1;
+		result->exponent = 0;
+		return true;
+	}
+
+	U64 hidden_bit = (U64)1 << 23;
+	if (biased_e != 0) {
+		result->length = grisu2(result->digits, &result->exponent,
+			significand + hidden_bit, biased_e - 150, hidden_bit);
+	} else {
+		result->length = grisu2(result->digits, &result->exponent,
+			significand, 1 - 150, hidden_bit);
+	}
+	return true;
+}
+
+// Prints the digits in the shortest notation: plain decimal for reasonable
+// magnitudes and scientific notation (1.5e-7) otherwise.
+bool print_float_digits(Printer *p, Float_Digits *d)
 {
-	return print(p, str.string);
+	char buffer[48];
+	char *ptr = buffer;
+
+	int length = d->length;
+	int point = length + d->exponent;
+
+	if (d->exponent >= 0 && point <= 16) {
+		// 1234000
+		memcpy(ptr, d->digits, length);
+		ptr += length;
+		memset(ptr, '0', d->exponent);
+		ptr += d->exponent;
+	} else if (point > 0 && point <= 16) {
+		// 12.34
+		memcpy(ptr, d->digits, point);
+		ptr += point;
+		*ptr++ = '.';
+		memcpy(ptr, d->digits + point, length - point);
+		ptr += length - point;
+	} else if (point > -4 && point <= 0) {
+		// 0.001234
+		*ptr++ = '0';
+		*ptr++ = '.';
+		memset(ptr, '0', -point);
+		ptr += -point;
+		memcpy(ptr, d->digits, length);
+		ptr += length;
+	} else {
+		// 1.234e-7
+		*ptr++ = d->digits[0];
+		if (length > 1) {
+			*ptr++ = '.';
+			memcpy(ptr, d->digits + 1, length - 1);
+			ptr += length - 1;
+		}
+		*ptr++ = 'e';
+		int exponent = point - 1;
+		if (exponent < 0) {
+			*ptr++ = '-';
+			exponent = -exponent;
+		}
+		char exponent_digits[4];
+		int count = 0;
+		do {
+			exponent_digits[count++] = (char)('0' + exponent % 10);
+			exponent /= 10;
+		} while (exponent);
+		while (count > 0)
+			*ptr++ = exponent_digits[--count];
+	}
+
+	return print(p, to_string(buffer, ptr));
+}
+
+bool print_float_special(Printer *p, double value)
+{
+	if (value != value)
+		return print(p, "nan");
+	return print(p, value < 0 ? "-inf" : "inf");
+}
+
+// Prints the shortest representation that parses back to the same double
+bool print_f64(Printer *p, double value)
+{
+	Float_Digits digits;
+	if (!float_digits_f64(&digits, value))
+		return print_float_special(p, value);
+	if (signbit(value) && !print(p, '-'))
+		return false;
+	return print_float_digits(p, &digits);
+}
+
+// Prints the shortest representation that parses back to the same float
+bool print_f32(Printer *p, float value)
+{
+	Float_Digits digits;
+	if (!float_digits_f32(&digits, value))
+		return print_float_special(p, value);
+	if (signbit(value) && !print(p, '-'))
+		return false;
+	return print_float_digits(p, &digits);
 }
 
+// Unsigned integer of 32-bit limbs, least significant first, large enough for
+// the scaled values of `print_f64_fixed`: below 2^70 * 10^20 < 2^137.
+#define FIXED_LIMBS 5
+
+struct Fixed_Big
+{
+	U32 limbs[FIXED_LIMBS];
+};
+
+void fixed_big_multiply(Fixed_Big *big, U32 factor)
+{
+	U64 carry = 0;
+	for (int i = 0; i < FIXED_LIMBS; i++) {
+		U64 product = (U64)big->limbs[i] * factor + carry;
+		big->limbs[i] = (U32)product;
+		carry = product >> 32;
+	}
+	assert(carry == 0);
+}
+
+inline bool fixed_big_bit(Fixed_Big *big, int bit)
+{
+	return bit < FIXED_LIMBS * 32 && (big->limbs[bit / 32] >> (bit % 32) & 1) != 0;
+}
+
+// Shifts right by `shift` bits rounding half to even like printf does
+void fixed_big_shift_round(Fixed_Big *big, int shift)
+{
+	if (shift <= 0)
+		return;
+	if (shift > FIXED_LIMBS * 32) {
+		// The value is below 2^137, less than half of the unit
+		memset(big->limbs, 0, sizeof(big->limbs));
+		return;
+	}
+
+	bool half = fixed_big_bit(big, shift - 1);
+	bool below_half = false;
+	for (int bit = 0; bit < shift - 1 && !below_half; bit++) {
+		below_half = fixed_big_bit(big, bit);
+	}
+
+	Fixed_Big result = { };
+	for (int bit = shift; bit < FIXED_LIMBS * 32; bit++) {
+		if (fixed_big_bit(big, bit))
+			result.limbs[(bit - shift) / 32] |= 1U << ((bit - shift) % 32);
+	}
+
+	bool round_up = half && (below_half || (result.limbs[0] & 1));
+	for (int i = 0; round_up && i < FIXED_LIMBS; i++) {
+		round_up = ++result.limbs[i] == 0;
+	}
+	*big = result;
+}
+
+void fixed_big_shift_left(Fixed_Big *big, int shift)
+{
+	Fixed_Big result = { };
+	for (int bit = 0; bit + shift < FIXED_LIMBS * 32; bit++) {
+		if (fixed_big_bit(big, bit))
+			result.limbs[(bit + shift) / 32] |= 1U << ((bit + shift) % 32);
+	}
+	*big = result;
+}
+
+// Divides by 10^9 in place and returns the remainder
+U32 fixed_big_divide_1e9(Fixed_Big *big)
+{
+	U64 remainder = 0;
+	for (int i = FIXED_LIMBS - 1; i >= 0; i--) {
+		U64 current = remainder << 32 | big->limbs[i];
+		big->limbs[i] = (U32)(current / 1000000000);
+		remainder = current % 1000000000;
+	}
+	return (U32)remainder;
+}
+
+inline bool fixed_big_zero(Fixed_Big *big)
+{
+	for (int i = 0; i < FIXED_LIMBS; i++) {
+		if (big->limbs[i]) return false;
+	}
+	return true;
+}
+
+// Prints the value with exactly `precision` decimals like "%.*f". The digits
+// are rounded from the exact binary value, halfway cases to even.
+bool print_f64_fixed(Printer *p, double value, int precision)
+{
+	assert(precision >= 0 && precision <= 20);
+
+	if (!isfinite(value))
+		return print_float_special(p, value);
+
+	// Huge values would need a lot of digits, fall back to the shortest form
+	if (fabs(value) >= 1e21)
+		return print_f64(p, value);
+
+	U64 bits;
+	memcpy(&bits, &value, sizeof(bits));
+	int biased_e = (int)(bits >> 52 & 0x7FF);
+	U64 significand = bits & (((U64)1 << 52) - 1);
+	int e = biased_e != 0 ? biased_e - 1075 : 1 - 1075;
+	if (biased_e != 0)
+		significand += (U64)1 << 52;
+
+	// value * 10^precision = significand * 10^precision * 2^e
+	Fixed_Big scaled = { };
+	scaled.limbs[0] = (U32)significand;
+	scaled.limbs[1] = (U32)(significand >> 32);
+	for (int i = 0; i < precision; i++) {
+		fixed_big_multiply(&scaled, 10);
+	}
+	if (e >= 0) {
+		fixed_big_shift_left(&scaled, e);
+	} else {
+		fixed_big_shift_round(&scaled, -e);
+	}
+
+	// Decimal digits of the scaled value, least significant first
+	char digits[48];
+	int length = 0;
+	for (;;) {
+		U32 part = fixed_big_divide_1e9(&scaled);
+		bool last = fixed_big_zero(&scaled);
+
+		// Leading zeros are only needed within the number
+		for (int i = 0; i < 9 && (!last || part); i++) {
+			digits[length++] = (char)('0' + part % 10);
+			part /= 10;
+		}
+		if (last)
+			break;
+	}
+	while (length <= precision)
+		digits[length++] = '0';
+
+	char buffer[64];
+	char *ptr = buffer;
+
+	if (signbit(value))
+		*ptr++ = '-';
+	for (int i = length - 1; i >= 0; i--) {
+		if (i == precision - 1)
+			*ptr++ = '.';
+		*ptr++ = digits[i];
+	}
+
+	return print(p, to_string(buffer, ptr));
+}
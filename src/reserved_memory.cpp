@@ -0,0 +1,201 @@
+
+// Push allocator backed by one reserved range of address space. Memory is
+// committed from the start of the range as the allocator grows, so everything
+// stays in place: pointers are never invalidated and streams grow without
+// copying their prefix into a new page. The functions overload the ones of
+// `Push_Allocator` so the PUSH_* and STREAM_* macros work on both, and like
+// with `Push_Allocator` pushes never fail: running out of the reserved range
+// aborts the process, so the range must be sized for the worst case.
+
+// Memory is committed in steps of this size to avoid a system call per push
+#define RESERVED_COMMIT_STEP KB(64)
+
+// `push_allocator_reset` keeps this much memory committed for the next use
+#define RESERVED_KEEP_COMMITTED MB(4)
+
+struct Reserved_Allocator
+{
+	char *base;
+	size_t position;
+	size_t committed;
+	size_t reserved;
+
+	// Committed memory is counted under this tag
+	Mem_Tag tag;
+};
+
+struct Reserved_Stream
+{
+	Reserved_Allocator *allocator;
+	size_t start;
+};
+
+inline size_t reserved_align_commit(size_t size)
+{
+	size_t step = max(os_memory_page_size(), (size_t)RESERVED_COMMIT_STEP);
+	return (size + step - 1) / step * step;
+}
+
+// Reserves `size` bytes of address space, no memory is used until it's pushed
+bool reserved_allocator_init(Reserved_Allocator *allocator, size_t size, Mem_Tag tag=Mem_Tag_Inherit)
+{
+	size = reserved_align_commit(size);
+
+	allocator->base = (char*)os_memory_reserve(size);
+	allocator->position = 0;
+	allocator->committed = 0;
+	allocator->reserved = allocator->base ? size : 0;
+#if BUILD_MEM_TAGS
+	allocator->tag = mem_tag_resolve(tag);
+#else
+	allocator->tag = tag;
+#endif
+	return allocator->base != 0;
+}
+
+inline void reserved_count_commit(Reserved_Allocator *allocator, size_t old_committed)
+{
+#if BUILD_MEM_TAGS
+	if (allocator->committed > old_committed)
+		mem_tag_count_alloc(allocator->tag, allocator->committed - old_committed);
+	else
+		mem_tag_count_free(allocator->tag, old_committed - allocator->committed);
+#endif
+}
+
+NOINLINE void reserved_allocator_fail(Reserved_Allocator *allocator, size_t size, const char *reason)
+{
+	fprintf(stderr, "Reserved allocator %s: pushing %llu bytes with %llu of %llu in use\n",
+		reason, (unsigned long long)size, (unsigned long long)allocator->position,
+		(unsigned long long)allocator->reserved);
+	abort();
+}
+
+inline void *push_allocator_push(Reserved_Allocator *allocator, size_t size)
+{
+	if (allocator->reserved - allocator->position < size)
+		reserved_allocator_fail(allocator, size, "exhausted");
+
+	size_t end = allocator->position + size;
+	if (end > allocator->committed) {
+		size_t new_committed = min(reserved_align_commit(end), allocator->reserved);
+		if (!os_memory_commit(allocator->base + allocator->committed,
+			new_committed - allocator->committed))
+			reserved_allocator_fail(allocator, size, "failed to commit");
+		size_t old_committed = allocator->committed;
+		allocator->committed = new_committed;
+		reserved_count_commit(allocator, old_committed);
+	}
+
+	void *data = allocator->base + allocator->position;
+	allocator->position = end;
+	return data;
+}
+
+// The range starts at a page boundary so the position alone decides alignment
+inline void *push_allocator_push_aligned(Reserved_Allocator *allocator, size_t size, size_t alignment)
+{
+	size_t padding = align_padding((void*)allocator->position, alignment);
+	char *data = (char*)push_allocator_push(allocator, padding + size);
+	return data + padding;
+}
+
+inline void *push_allocator_copy(Reserved_Allocator *allocator, size_t size, void *src)
+{
+	void *dst = push_allocator_push(allocator, size);
+	memcpy(dst, src, size);
+	return dst;
+}
+
+inline void *push_allocator_copy_aligned(Reserved_Allocator *allocator, size_t size, size_t alignment, void *src)
+{
+	void *dst = push_allocator_push_aligned(allocator, size, alignment);
+	memcpy(dst, src, size);
+	return dst;
+}
+
+void push_allocator_free(Reserved_Allocator *allocator)
+{
+	if (allocator->base)
+		os_memory_release(allocator->base, allocator->reserved);
+	size_t old_committed = allocator->committed;
+	allocator->base = 0;
+	allocator->position = 0;
+	allocator->committed = 0;
+	reserved_count_commit(allocator, old_committed);
+	allocator->reserved = 0;
+}
+
+inline Push_Marker push_allocator_mark(Reserved_Allocator *allocator)
+{
+	Push_Marker marker;
+	marker.buffer = allocator->base;
+	marker.position = allocator->position;
+	return marker;
+}
+
+inline void push_allocator_rewind(Reserved_Allocator *allocator, Push_Marker marker)
+{
+	assert(marker.buffer == allocator->base && marker.position <= allocator->position);
+	allocator->position = marker.position;
+}
+
+// Releases everything in the allocator and returns the memory over
+// RESERVED_KEEP_COMMITTED to the system.
+void push_allocator_reset(Reserved_Allocator *allocator)
+{
+	allocator->position = 0;
+
+	size_t keep = min(reserved_align_commit(RESERVED_KEEP_COMMITTED), allocator->committed);
+	if (allocator->committed > keep) {
+		os_memory_decommit(allocator->base + keep, allocator->committed - keep);
+		size_t old_committed = allocator->committed;
+		allocator->committed = keep;
+		reserved_count_commit(allocator, old_committed);
+	}
+}
+
+inline Reserved_Stream start_push_stream(Reserved_Allocator *allocator, size_t alignment=PUSH_STREAM_ALIGNMENT)
+{
+	push_allocator_push_aligned(allocator, 0, alignment);
+
+	Reserved_Stream stream;
+	stream.allocator = allocator;
+	stream.start = allocator->position;
+	return stream;
+}
+
+inline Data_Slice finish_push_stream(Reserved_Stream *stream)
+{
+	Data_Slice slice;
+	slice.data = stream->allocator->base + stream->start;
+	slice.length = stream->allocator->position - stream->start;
+	return slice;
+}
+
+inline String finish_push_stream_string(Reserved_Stream *stream)
+{
+	Data_Slice slice = finish_push_stream(stream);
+	return to_string((char*)slice.data, slice.length);
+}
+
+// The stream always continues in place, so nothing pushed to it ever moves
+inline void *push_stream_push(Reserved_Stream *stream, size_t size)
+{
+	return push_allocator_push(stream->allocator, size);
+}
+
+inline void *push_stream_push_aligned(Reserved_Stream *stream, size_t size, size_t alignment)
+{
+	return push_allocator_push_aligned(stream->allocator, size, alignment);
+}
+
+inline void *push_stream_copy(Reserved_Stream *stream, size_t size, void *src)
+{
+	return push_allocator_copy(stream->allocator, size, src);
+}
+
+inline void *push_stream_copy_aligned(Reserved_Stream *stream, size_t size, size_t alignment, void *src)
+{
+	return push_allocator_copy_aligned(stream->allocator, size, alignment, src);
+}
@@ -6,16 +6,39 @@ struct Scanner
 
 inline bool is_whitespace(char c)
 {
-	return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+	return (char_class_table[(U8)c] & CHAR_CLASS_WHITESPACE) != 0;
 }
 
+// The scanning loops below test 16 bytes at a time with SSE2 and finish the
+// remaining tail a byte at a time.
+
 inline void accept_whitespace(Scanner *s)
 {
 	const char *pos = s->pos;
-	char const *end = s->end;
+	const char *end = s->end;
+
+#if BUILD_SSE2
+	const __m128i space = _mm_set1_epi8(' ');
+	const __m128i newline = _mm_set1_epi8('\n');
+	const __m128i carriage = _mm_set1_epi8('\r');
+	const __m128i tab = _mm_set1_epi8('\t');
+
+	while (end - pos >= 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)pos);
+		__m128i match = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, space), _mm_cmpeq_epi8(chunk, newline)),
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, carriage), _mm_cmpeq_epi8(chunk, tab)));
+		U32 mask = ~(U32)_mm_movemask_epi8(match) & 0xFFFF;
+		if (mask) {
+			s->pos = pos + count_trailing_zeros(mask);
+			return;
+		}
+		pos += 16;
+	}
+#endif
 
 	while (pos != end && is_whitespace(*pos)) {
-		*pos++;
+		pos++;
 	}
 	s->pos = pos;
 }
@@ -28,38 +51,62 @@ inline bool scanner_skip(Scanner *s, size_t amount)
 	return true;
 }
 
+// Returns the first occurrence of `a` or `b` in [pos, end) or `end`
+inline const char *scan_find(const char *pos, const char *end, char a, char b)
+{
+#if BUILD_SSE2
+	const __m128i va = _mm_set1_epi8(a);
+	const __m128i vb = _mm_set1_epi8(b);
+
+	while (end - pos >= 16) {
+		__m128i chunk = _mm_loadu_si128((const __m128i*)pos);
+		__m128i match = _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb));
+		int mask = _mm_movemask_epi8(match);
+		if (mask)
+			return pos + count_trailing_zeros((U32)mask);
+		pos += 16;
+	}
+#endif
+
+	for (; pos != end; pos++) {
+		if (*pos == a || *pos == b)
+			return pos;
+	}
+	return end;
+}
+
 inline bool balance_accept(Scanner *s, char up, char down, int initial=1)
 {
 	const char *pos = s->pos;
 	const char *end = s->end;
 
 	int level = initial;
-	for (; pos != end; pos++) {
-		char c = *pos;
-		if (c == up) {
+	for (;;) {
+		pos = scan_find(pos, end, up, down);
+		if (pos == end)
+			return false;
+
+		if (*pos == up) {
 			level++;
-		} else if (c == down) {
+		} else {
 			level--;
 		}
+		pos++;
+
 		if (level == 0) {
-			s->pos = pos + 1;
+			s->pos = pos;
 			return true;
 		}
 	}
-	return false;
 }
 
 inline bool skip_accept(Scanner *s, char c)
 {
-	const char *pos = s->pos;
-	const char *end = s->end;
-	for (; pos != end; pos++) {
-		if (*pos == c) {
-			s->pos = pos + 1;
-			return true;
-		}
-	}
-	return false;
+	const char *pos = scan_find(s->pos, s->end, c, c);
+	if (pos == s->end)
+		return false;
+	s->pos = pos + 1;
+	return true;
 }
 
 inline bool skip_accept(Scanner *s, String str)
@@ -67,6 +114,8 @@ inline bool skip_accept(Scanner *s, String str)
 	// The string is invalid
 	if (str.length == 0)
 		return false;
+	if (str.length == 1)
+		return skip_accept(s, str.data[0]);
 
 	const char *pos = s->pos;
 	const char *end = s->end;
@@ -75,13 +124,42 @@ inline bool skip_accept(Scanner *s, String str)
 	if ((size_t)(end - pos) < str.length)
 		return false;
 
+	// Last position the string can start at
+	const char *last = end - str.length;
+
 	char first = str.data[0];
-	for (; pos != end; pos++) {
-		if (*pos != first)
+	char second = str.data[1];
+	String rest = substring(str, 2);
+
+#if BUILD_SSE2
+	// Anchor on the first two characters of the string, which rules out most
+	// false candidates before comparing the rest.
+	const __m128i vfirst = _mm_set1_epi8(first);
+	const __m128i vsecond = _mm_set1_epi8(second);
+
+	while (last - pos >= 16) {
+		__m128i chunk0 = _mm_loadu_si128((const __m128i*)pos);
+		__m128i chunk1 = _mm_loadu_si128((const __m128i*)(pos + 1));
+		__m128i match = _mm_and_si128(
+			_mm_cmpeq_epi8(chunk0, vfirst), _mm_cmpeq_epi8(chunk1, vsecond));
+		U32 mask = (U32)_mm_movemask_epi8(match);
+		while (mask) {
+			const char *candidate = pos + count_trailing_zeros(mask);
+			if (!memcmp(candidate + 2, rest.data, rest.length)) {
+				s->pos = candidate + str.length;
+				return true;
+			}
+			mask &= mask - 1;
+		}
+		pos += 16;
+	}
+#endif
+
+	for (; pos <= last; pos++) {
+		if (pos[0] != first || pos[1] != second)
 			continue;
 
-		String suffix = substring(str, 1);
-		if (!memcmp(pos + 1, suffix.data, suffix.length)) {
+		if (!memcmp(pos + 2, rest.data, rest.length)) {
 			s->pos = pos + str.length;
 			return true;
 		}
@@ -1,186 +1,210 @@
+LIST_STRUCT(String);
+
+// Handle to a string in a `String_Table`, the index of the string in the order
+// it was first interned. Equal strings in the same table have equal ids and the
+// string is resolved with `intern_string` when needed. The empty string is
+// always `INTERN_ID_EMPTY`.
+typedef U32 Intern_Id;
+LIST_STRUCT(Intern_Id);
+
+#define INTERN_ID_EMPTY 0
+#define INTERN_ID_NONE UINT32_MAX
+
+// Open addressing slot packed into 16 bytes so a probe touches one cache line.
+// The string itself is only looked up by `id` when the hash and length match.
+// Empty slots have zero length, empty strings are never stored.
+struct String_Table_Slot
+{
+	U32 hash;
+	U32 length;
+	U32 id;
+
+	// Distance from the slot the hash maps to
+	U32 distance;
+};
+
+// Robin Hood hash table: on insertion an entry takes the slot of any entry
+// that is closer to its home slot, which keeps the probe sequences short and
+// lets unsuccessful lookups stop early.
 struct String_Table
 {
 	Push_Allocator alloc;
-	U32 *hashes;
-	U32 *lengths;
-	char **datas;
+	String_Table_Slot *slots;
 	size_t count;
 	size_t size;
 
-#ifdef BUILD_DEBUG
-	void *debug_table_id;
-#endif
+	// Interned strings in order of insertion, indexed by id
+	String_List strings;
 };
 
 void string_table_free(String_Table *table)
 {
 	push_allocator_free(&table->alloc);
-	M_FREE(table->hashes);
-	M_FREE(table->lengths);
-	M_FREE(table->datas);
+	M_FREE(table->slots);
+	list_free(&table->strings);
 }
 
-struct Interned_String
-{
-	String string;
-#ifdef BUILD_DEBUG
-	void *debug_table_id;
-#endif
-};
-
+// Hashes 8 bytes at a time with a multiply-xorshift step per word and a final
+// avalanche, so all the bits of the result are usable as the table index.
 U32 string_hash(String str)
 {
-	U32 hash = 0;
-	for (size_t i = 0; i < str.length; i++) {
-		hash = hash * 123 + str.data[i];
+	const U64 k = 0x9E3779B97F4A7C15ull;
+
+	const char *pos = str.data;
+	size_t left = str.length;
+	U64 hash = (U64)str.length * k;
+
+	while (left >= 8) {
+		U64 word;
+		memcpy(&word, pos, 8);
+		hash = (hash ^ word) * k;
+		hash ^= hash >> 29;
+		pos += 8;
+		left -= 8;
+	}
+	if (left > 0) {
+		U64 word = 0;
+		memcpy(&word, pos, left);
+		hash = (hash ^ word) * k;
+		hash ^= hash >> 29;
 	}
-	return hash;
+
+	hash ^= hash >> 32;
+	hash *= 0xD6E8FEB86659FD93ull;
+	hash ^= hash >> 32;
+	return (U32)hash;
 }
 
-#define wrap_advance(x, cap) (((x) + 1) % (cap))
+// Places `slot` into the table, moving entries that are closer to their home
+// slot further along.
+void string_table_place(String_Table_Slot *slots, size_t size, String_Table_Slot slot)
+{
+	size_t mask = size - 1;
+	size_t index = slot.hash & mask;
+	slot.distance = 0;
+
+	for (;;) {
+		String_Table_Slot *existing = &slots[index];
+		if (existing->length == 0) {
+			*existing = slot;
+			return;
+		}
+		if (existing->distance < slot.distance) {
+			String_Table_Slot displaced = *existing;
+			*existing = slot;
+			slot = displaced;
+		}
+		index = (index + 1) & mask;
+		slot.distance++;
+	}
+}
 
 void string_table_rehash(String_Table *table)
 {
-	// TODO: Prime table sizes?
 	size_t old_size = table->size;
 	size_t new_size = max(old_size * 2, 8);
 
-	U32 *old_hashes = table->hashes;
-	U32 *old_lengths = table->lengths;
-	char **old_datas = table->datas;
-
-	// TODO: Compound allocation?
-	U32 *new_hashes = M_ALLOC_ZERO(U32, new_size);
-	U32 *new_lengths = M_ALLOC_ZERO(U32, new_size);
-	char **new_datas = M_ALLOC_ZERO(char*, new_size);
+	String_Table_Slot *old_slots = table->slots;
+	String_Table_Slot *new_slots = M_ALLOC_ZERO_TAGGED(String_Table_Slot, new_size, Mem_Tag_Strings);
 
-	for (size_t old_index = 0; old_index < old_size; old_index++) {
-		size_t new_index = old_hashes[old_index] % new_size;
-		while (new_datas[new_index]) {
-			new_index = wrap_advance(new_index, new_size);
-		}
-		new_hashes[new_index] = old_hashes[old_index];
-		new_lengths[new_index] = old_lengths[old_index];
-		new_datas[new_index] = old_datas[old_index];
+	for (size_t i = 0; i < old_size; i++) {
+		if (old_slots[i].length != 0)
+			string_table_place(new_slots, new_size, old_slots[i]);
 	}
 
-	M_FREE(old_hashes);
-	M_FREE(old_lengths);
-	M_FREE(old_datas);
-
-#ifdef BUILD_DEBUG
-	if (!table->debug_table_id) {
-		table->debug_table_id = new_hashes;
-	}
-#endif
+	M_FREE(old_slots);
 
-	table->hashes = new_hashes;
-	table->lengths = new_lengths;
-	table->datas = new_datas;
+	table->slots = new_slots;
 	table->size = new_size;
 }
 
 void free_string_table(String_Table *table)
 {
-	push_allocator_free(&table->alloc);
-	M_FREE(table->hashes);
-	M_FREE(table->lengths);
-	M_FREE(table->datas);
+	string_table_free(table);
 }
 
-struct String_Table_Position
-{
-	size_t index;
-	U32 hash;
-	bool exists;
-};
-
-String_Table_Position string_table_find(String_Table *table, String str)
+// Returns the id of `str` or INTERN_ID_NONE if it's not in the table
+Intern_Id string_table_find(String_Table *table, String str, U32 hash)
 {
 	assert(str.length <= UINT32_MAX);
 
-	U32 hash = string_hash(str);
-	size_t index = hash % table->size;
-
-	U32 *hashes = table->hashes;
-	U32 *lengths = table->lengths;
-	char **datas = table->datas;
-	size_t size = table->size;
-
-	size_t length;
-	while (length = lengths[index]) {
-		if (hashes[index] == hash
-			&& length == str.length
-			&& !memcmp(datas[index], str.data, length)) {
-			String_Table_Position result;
-			result.index = index;
-			result.hash = hash;
-			result.exists = true;
-			return result;
+	if (str.length == 0)
+		return table->strings.count > 0 ? INTERN_ID_EMPTY : INTERN_ID_NONE;
+	if (table->size == 0)
+		return INTERN_ID_NONE;
+
+	String_Table_Slot *slots = table->slots;
+	size_t mask = table->size - 1;
+	size_t index = hash & mask;
+
+	for (U32 distance = 0; ; distance++) {
+		String_Table_Slot *slot = &slots[index];
+
+		// Robin Hood ordering: the string would have displaced this entry
+		if (slot->length == 0 || slot->distance < distance)
+			return INTERN_ID_NONE;
+
+		if (slot->hash == hash && slot->length == str.length) {
+			String candidate = table->strings.data[slot->id];
+			if (!memcmp(candidate.data, str.data, str.length))
+				return slot->id;
 		}
-		index = wrap_advance(index, size);
+		index = (index + 1) & mask;
 	}
-	String_Table_Position result;
-	result.index = index;
-	result.hash = hash;
-	result.exists = false;
-	return result;
 }
 
-Interned_String intern(String_Table *table, String str)
+// Returns the id of `str`, inserting it if it's not there yet
+Intern_Id intern(String_Table *table, String str)
 {
+	// The empty string is always the first one
+	if (table->strings.count == 0) {
+		// Reallocations keep the tag of the first allocation
+		table->alloc.tag = Mem_Tag_Strings;
+		if (!table->strings.data) {
+			table->strings.data = M_ALLOC_TAGGED(String, 16, Mem_Tag_Strings);
+			table->strings.capacity = 16;
+		}
+		String empty = empty_string();
+		list_push(&table->strings, &empty);
+	}
+
+	U32 hash = string_hash(str);
+	Intern_Id id = string_table_find(table, str, hash);
+	if (id != INTERN_ID_NONE)
+		return id;
+
 	if (table->count >= table->size * 3 / 4) {
 		string_table_rehash(table);
 	}
 
-	// Note: This has to be after the rehashing so that interning and empty
-	// string to an empty table has the correct `debug_table_id` set up.
-	if (str.length == 0) {
-		Interned_String empty;
-		empty.string = empty_string();
-#ifdef BUILD_DEBUG
-		empty.debug_table_id = table->debug_table_id;
-#endif
-		return empty;
-	}
+	String copy = PUSH_COPY_STR(&table->alloc, str);
+	id = (Intern_Id)table->strings.count;
+	list_push(&table->strings, &copy);
 
-	String_Table_Position pos = string_table_find(table, str);
-	if (!pos.exists) {
-		String copy = PUSH_COPY_STR(&table->alloc, str);
-		table->hashes[pos.index] = pos.hash;
-		table->lengths[pos.index] = (U32)copy.length;
-		table->datas[pos.index] = copy.data;
-		table->count++;
-	}
-	Interned_String result;
-	result.string = to_string(table->datas[pos.index], table->lengths[pos.index]);
-#ifdef BUILD_DEBUG
-	result.debug_table_id = table->debug_table_id;
-#endif
-	return result;
+	String_Table_Slot slot;
+	slot.hash = hash;
+	slot.length = (U32)copy.length;
+	slot.id = id;
+	slot.distance = 0;
+	string_table_place(table->slots, table->size, slot);
+	table->count++;
+
+	return id;
 }
 
-bool intern_if_not_new(Interned_String *result, String_Table *table, String str)
+// Finds the id of `str` without adding it to the table
+bool intern_if_not_new(Intern_Id *result, String_Table *table, String str)
 {
-	String_Table_Position pos = string_table_find(table, str);
-	if (!pos.exists)
+	Intern_Id id = string_table_find(table, str, string_hash(str));
+	if (id == INTERN_ID_NONE)
 		return false;
 
-	result->string = to_string(table->datas[pos.index], table->lengths[pos.index]);
-#ifdef BUILD_DEBUG
-	result->debug_table_id = table->debug_table_id;
-#endif
+	*result = id;
 	return true;
 }
 
-bool operator==(Interned_String a, Interned_String b) {
-#if BUILD_DEBUG
-	assert(a.debug_table_id == b.debug_table_id);
-#endif
-	return a.string.data == b.string.data;
-}
-
-bool operator!=(Interned_String a, Interned_String b) {
-	return !(a == b);
+inline String intern_string(String_Table *table, Intern_Id id)
+{
+	assert(id < table->strings.count);
+	return table->strings.data[id];
 }
-
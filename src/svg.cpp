@@ -1,82 +1,101 @@
 
 struct Id_To_XML_Node
 {
-	Interned_String id;
-	XML_Node *node;
+	String id;
+	U32 node;
 };
-LIST_STRUCT(Id_To_XML_Node);
+typedef Dyn_Array<Id_To_XML_Node, 16> Id_To_XML_Node_List;
+
+int compare_id_string(String a, String b)
+{
+	int diff = memcmp(a.data, b.data, min(a.length, b.length));
+	if (diff != 0) return diff;
+	if (a.length < b.length) return -1;
+	if (a.length > b.length) return 1;
+	return 0;
+}
 
 int compare_id_to_xml(const void *av, const void *bv)
 {
 	Id_To_XML_Node *a = (Id_To_XML_Node*)av;
 	Id_To_XML_Node *b = (Id_To_XML_Node*)bv;
-
-	ptrdiff_t diff = a->id.string.data - b->id.string.data;
-	if (diff < 0) return -1;
-	if (diff > 0) return 1;
-	return 0;
+	return compare_id_string(a->id, b->id);
 }
 
 int compare_id_key_to_xml(const void *keyv, const void *elemv)
 {
-	Interned_String *key = (Interned_String*)keyv;
+	String *key = (String*)keyv;
 	Id_To_XML_Node *elem = (Id_To_XML_Node*)elemv;
-
-	ptrdiff_t diff = key->string.data - elem->id.string.data;
-	if (diff < 0) return -1;
-	if (diff > 0) return 1;
-	return 0;
+	return compare_id_string(*key, elem->id);
 }
 
+// SVG document with its `id` attributes sorted for lookup
 struct SVG_XML
 {
-	String_Table id_table;
 	XML xml;
 	Id_To_XML_Node_List ids;
 };
 
-void svg_walk_xml(SVG_XML *svg, XML_Node *node, Interned_String id_key)
+// Read-only SVG compiled into the executable by pre_assets
+struct SVG_Blob_Id
+{
+	XML_Blob_String id;
+	U32 node;
+};
+
+struct SVG_Blob
 {
-	for (U32 i = 0; i < node->attribute_count; i++) {
-		XML_Attribute attrib = node->attributes[i];
+	XML_Blob xml;
+	const SVG_Blob_Id *ids;
+	U32 id_count;
+};
 
-		if (attrib.key == id_key) {
+// The nodes are stored in a flat array so they can be scanned without
+// walking the tree.
+void svg_walk_xml(SVG_XML *svg, U32 id_key)
+{
+	XML *xml = &svg->xml;
+	for (U32 index = 0; index < xml->nodes.count; index++) {
+		String id;
+		if (xml_find_attribute(&id, xml, index, id_key)) {
 			Id_To_XML_Node id_to_xml;
-			id_to_xml.id = intern(&svg->id_table, attrib.value);
-			id_to_xml.node = node;
+			id_to_xml.id = id;
+			id_to_xml.node = index;
 
 			list_push(&svg->ids, &id_to_xml);
-			break;
 		}
 	}
-
-	XML_Node *child = node->children;
-	while (child) {
-		svg_walk_xml(svg, child, id_key);
-		child = child->next;
-	}
 }
 
 void initialize_id_list(SVG_XML *svg)
 {
-	Interned_String id_key = intern(&svg->xml.string_table, c_string("id"));
-	svg_walk_xml(svg, svg->xml.root, id_key);
+	Intern_Id id_key = intern(&svg->xml.string_table, c_string("id"));
+	svg_walk_xml(svg, id_key);
 
 	qsort(svg->ids.data, svg->ids.count, sizeof(*svg->ids.data), compare_id_to_xml);
 }
 
-XML_Node *svg_find_by_id(SVG_XML *svg, String id)
+// Sets up `svg` from `blob`, see `xml_from_blob`. The ids are already sorted.
+void svg_from_blob(SVG_XML *svg, const SVG_Blob *blob)
 {
-	Interned_String id_key;
-	if (!intern_if_not_new(&id_key, &svg->id_table, id))
-		return 0;
+	xml_from_blob(&svg->xml, &blob->xml);
 
-	Id_To_XML_Node *id_to_xml = (Id_To_XML_Node*)bsearch(&id_key,
+	memset(&svg->ids, 0, sizeof(svg->ids));
+	Id_To_XML_Node *ids = list_push(&svg->ids, blob->id_count);
+	for (U32 i = 0; i < blob->id_count; i++) {
+		ids[i].id = xml_blob_string(&blob->xml, blob->ids[i].id);
+		ids[i].node = blob->ids[i].node;
+	}
+}
+
+U32 svg_find_by_id(SVG_XML *svg, String id)
+{
+	Id_To_XML_Node *id_to_xml = (Id_To_XML_Node*)bsearch(&id,
 		svg->ids.data, svg->ids.count, sizeof(*svg->ids.data),
 		compare_id_key_to_xml);
 
-	assert(id_to_xml && id_to_xml->node);
+	if (!id_to_xml)
+		return XML_NO_NODE;
 
 	return id_to_xml->node;
 }
-
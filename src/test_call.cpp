@@ -26,23 +26,24 @@ size_t test_identity(char *out_buffer, const char* in_buffer, size_t length)
 	return length;
 }
 
-size_t write_xml(char *buffer, XML_Node *node)
+size_t write_xml(char *buffer, XML *xml, U32 index)
 {
+	XML_Node *node = xml_node(xml, index);
 	char *ptr = buffer;
 	ptr += sprintf(ptr, "<") + 1;
-	ptr += print_string(ptr, node->tag.string) + 1;
-	for (size_t i = 0; i < node->attribute_count; i++) {
-		XML_Attribute *attr = &node->attributes[i];
-		ptr += print_string(ptr, attr->key.string) + 1;
-		ptr += print_string(ptr, attr->value) + 1;
+	ptr += print_string(ptr, xml_name(xml, node->tag)) + 1;
+	for (U32 i = 0; i < node->attribute_count; i++) {
+		U32 attr = node->first_attribute + i;
+		ptr += print_string(ptr, xml_name(xml, xml->attribute_keys.data[attr])) + 1;
+		ptr += print_string(ptr, xml->attribute_values.data[attr]) + 1;
 	}
 	ptr += sprintf(ptr, ">") + 1;
 	if (node->text.length > 0) {
 		ptr += sprintf(ptr, "#") + 1;
 		ptr += print_string(ptr, node->text) + 1;
 	}
-	for (XML_Node *child = node->children; child; child = child->next) {
-		ptr += write_xml(ptr, child);
+	for (U32 child = node->first_child; child != XML_NO_NODE; child = xml_node(xml, child)->next_sibling) {
+		ptr += write_xml(ptr, xml, child);
 	}
 	ptr += sprintf(ptr, "/") + 1;
 	return ptr - buffer;
@@ -62,9 +63,9 @@ size_t test_xml(char *out_buffer, const char* in_buffer, size_t length)
 	// Overwrite the buffer with a detectable bit pattern to catch errors
 	memset(read_buffer, 0xD0, length);
 
-	if (!xml.root)
+	if (xml_root(&xml) == XML_NO_NODE)
 		return 0;
-	size_t written = write_xml(out_buffer, xml.root);
+	size_t written = write_xml(out_buffer, &xml, xml_root(&xml));
 
 	xml_free(&xml);
 	M_FREE(read_buffer);
@@ -72,6 +73,381 @@ size_t test_xml(char *out_buffer, const char* in_buffer, size_t length)
 	return written;
 }
 
+size_t test_xml_borrow(char *out_buffer, const char* in_buffer, size_t length)
+{
+	char *read_buffer = M_ALLOC(char, length);
+	memcpy(read_buffer, in_buffer, length);
+
+	XML xml = { 0 };
+	size_t written = 0;
+	if (parse_xml(&xml, read_buffer, length, XML_Source_Borrow) && xml_root(&xml) != XML_NO_NODE) {
+		written = write_xml(out_buffer, &xml, xml_root(&xml));
+	}
+
+	xml_free(&xml);
+	M_FREE(read_buffer);
+
+	return written;
+}
+
+// Feeds the XML to the streaming parser a few bytes at a time
+size_t test_xml_chunked(char *out_buffer, const char* in_buffer, size_t length)
+{
+	XML xml = { 0 };
+	XML_Builder builder;
+	xml_builder_init(&builder, &xml, 0, 0);
+
+	XML_Parser parser;
+	xml_parser_init(&parser, &xml.string_table, xml_builder_handler(&builder));
+
+	bool success = true;
+	for (size_t pos = 0; success && pos < length; pos += 7) {
+		success = xml_parser_feed(&parser, in_buffer + pos, min(length - pos, (size_t)7));
+	}
+	success = success && xml_parser_finish(&parser);
+	xml_parser_free(&parser);
+
+	size_t written = 0;
+	if (success && xml_root(&xml) != XML_NO_NODE) {
+		written = write_xml(out_buffer, &xml, xml_root(&xml));
+	}
+
+	xml_free(&xml);
+	return written;
+}
+
+// Feeds the XML after the chunk size on the first line and reports where the
+// parser failed and how much input it held back at most
+size_t test_xml_chunked_error(char *out_buffer, const char* in_buffer, size_t length)
+{
+	Scanner s;
+	s.pos = in_buffer;
+	s.end = in_buffer + length;
+	U64 chunk;
+	if (!accept_int(&chunk, &s, 10) || chunk == 0 || !accept(&s, '\n'))
+		return 0;
+	in_buffer = s.pos;
+	length = s.end - s.pos;
+
+	String_Table names = { 0 };
+	XML_Handler handler = { 0 };
+	XML_Parser parser;
+	xml_parser_init(&parser, &names, handler);
+
+	bool success = true;
+	size_t pos = 0;
+	size_t max_pending = 0;
+	for (; success && pos < length; pos += chunk) {
+		success = xml_parser_feed(&parser, in_buffer + pos, min(length - pos, (size_t)chunk));
+		max_pending = max(max_pending, parser.pending.count);
+	}
+	bool finished = success && xml_parser_finish(&parser);
+	xml_parser_free(&parser);
+	string_table_free(&names);
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	if (finished) {
+		print(&p, "ok");
+	} else if (success) {
+		print(&p, "failed at finish");
+	} else {
+		print(&p, "failed at ");
+		print_u64(&p, (U64)(pos - chunk));
+	}
+	print(&p, ", pending ");
+	print_u64(&p, (U64)max_pending);
+	print(&p, "\n");
+	return p.pos - out_buffer;
+}
+
+#define TEST_MAX_THREADS 16
+
+typedef void (*test_thread_func)(void *work);
+
+struct Test_Threads
+{
+	test_thread_func func;
+	char *work;
+	size_t work_size;
+
+	os_mutex lock;
+	os_cond cond;
+	U32 done_count;
+};
+
+struct Test_Thread
+{
+	Test_Threads *threads;
+	U32 index;
+};
+
+OS_THREAD_ENTRY(test_thread_entry, param)
+{
+	Test_Thread *thread = (Test_Thread*)param;
+	Test_Threads *threads = thread->threads;
+	threads->func(threads->work + thread->index * threads->work_size);
+
+	os_mutex_lock(&threads->lock);
+	threads->done_count++;
+	os_cond_broadcast(&threads->cond);
+	os_mutex_unlock(&threads->lock);
+
+	OS_THREAD_RETURN;
+}
+
+// Runs `func` on a thread for every element of the `work` array at once and
+// waits for all of them to finish
+void test_run_threads(test_thread_func func, void *work, size_t work_size, U32 count)
+{
+	assert(count <= TEST_MAX_THREADS);
+
+	Test_Threads threads;
+	threads.func = func;
+	threads.work = (char*)work;
+	threads.work_size = work_size;
+	os_mutex_init(&threads.lock);
+	os_cond_init(&threads.cond);
+	threads.done_count = 0;
+
+	Test_Thread thread[TEST_MAX_THREADS];
+	for (U32 i = 0; i < count; i++) {
+		thread[i].threads = &threads;
+		thread[i].index = i;
+		os_thread_do(test_thread_entry, &thread[i]);
+	}
+
+	os_mutex_lock(&threads.lock);
+	while (threads.done_count < count)
+		os_cond_wait(&threads.cond, &threads.lock, 10);
+	os_mutex_unlock(&threads.lock);
+}
+
+#define TEST_RUN_THREADS(func, work) test_run_threads((func), (work), sizeof(*(work)), Count(work))
+
+#define TEST_INTERN_THREADS 4
+
+struct Test_Concurrent_Intern
+{
+	Concurrent_String_Table *table;
+	String *words;
+	U32 word_count;
+	bool reverse;
+	Interned_String *results;
+};
+
+void test_concurrent_intern_thread(void *param)
+{
+	Test_Concurrent_Intern *work = (Test_Concurrent_Intern*)param;
+
+	for (U32 n = 0; n < work->word_count; n++) {
+		U32 i = work->reverse ? work->word_count - 1 - n : n;
+		work->results[i] = intern(work->table, work->words[i]);
+	}
+}
+
+// Interns whitespace separated words from multiple threads at once and prints
+// the number of words that didn't intern to the same string on every thread.
+size_t test_concurrent_intern(char *out_buffer, const char* in_buffer, size_t length)
+{
+	String *words = M_ALLOC(String, length + 1);
+	U32 word_count = 0;
+
+	Scanner s;
+	s.pos = in_buffer;
+	s.end = in_buffer + length;
+	accept_whitespace(&s);
+	while (!scanner_end(&s)) {
+		const char *begin = s.pos;
+		while (!scanner_end(&s) && !is_whitespace(*s.pos))
+			s.pos++;
+		words[word_count++] = to_string(begin, s.pos);
+		accept_whitespace(&s);
+	}
+
+	Concurrent_String_Table table;
+	concurrent_string_table_init(&table);
+
+	Interned_String *results = M_ALLOC(Interned_String, TEST_INTERN_THREADS * (word_count + 1));
+	Test_Concurrent_Intern work[TEST_INTERN_THREADS];
+	for (U32 i = 0; i < TEST_INTERN_THREADS; i++) {
+		work[i].table = &table;
+		work[i].words = words;
+		work[i].word_count = word_count;
+		work[i].reverse = i % 2 == 1;
+		work[i].results = results + i * (word_count + 1);
+	}
+	TEST_RUN_THREADS(test_concurrent_intern_thread, work);
+
+	U32 mismatches = 0;
+	for (U32 i = 0; i < word_count; i++) {
+		Interned_String first = work[0].results[i];
+		bool match = first.string.length == words[i].length
+			&& !memcmp(first.string.data, words[i].data, words[i].length);
+
+		Interned_String found;
+		match = match && intern_if_not_new(&found, &table, words[i]) && found == first;
+		for (U32 t = 1; t < TEST_INTERN_THREADS; t++) {
+			match = match && work[t].results[i] == first;
+		}
+		if (!match)
+			mismatches++;
+	}
+
+	concurrent_string_table_free(&table);
+	M_FREE(results);
+	M_FREE(words);
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	print(&p, "mismatches: ");
+	print_u32(&p, mismatches);
+	print(&p, "\n");
+	return p.pos - out_buffer;
+}
+
+// Collects the tag names, attribute names and attribute values of an XML
+// document in document order as a realistic interning workload.
+struct Test_Bench_Names
+{
+	String_Table *xml_names;
+	String_List names;
+	Push_Allocator alloc;
+};
+
+bool test_bench_names_start(void *user, Intern_Id tag, XML_Sax_Attribute *attrs, U32 attr_count)
+{
+	Test_Bench_Names *bench = (Test_Bench_Names*)user;
+
+	String name = intern_string(bench->xml_names, tag);
+	list_push(&bench->names, &name);
+	for (U32 i = 0; i < attr_count; i++) {
+		String key = intern_string(bench->xml_names, attrs[i].key);
+		String value = PUSH_COPY_STR(&bench->alloc, attrs[i].value);
+		list_push(&bench->names, &key);
+		list_push(&bench->names, &value);
+	}
+	return true;
+}
+
+// Measures interning the names of the posted XML document into a fresh table
+// and looking them up again.
+size_t test_bench_intern(char *out_buffer, const char* in_buffer, size_t length)
+{
+	String_Table xml_names = { 0 };
+	Test_Bench_Names bench = { 0 };
+	bench.xml_names = &xml_names;
+
+	XML_Handler handler = { 0 };
+	handler.user = &bench;
+	handler.start = test_bench_names_start;
+
+	XML_Parser parser;
+	xml_parser_init(&parser, &xml_names, handler);
+	bool success = xml_parser_feed(&parser, in_buffer, length)
+		&& xml_parser_finish(&parser);
+	xml_parser_free(&parser);
+
+	const U32 rounds = 200;
+	U32 interned = 0;
+	os_timer_mark begin = os_get_timer();
+	for (U32 round = 0; success && round < rounds; round++) {
+		String_Table table = { 0 };
+		for (size_t i = 0; i < bench.names.count; i++) {
+			if (bench.names.data[i].length == 0)
+				continue;
+			intern(&table, bench.names.data[i]);
+			interned++;
+		}
+		for (size_t i = 0; i < bench.names.count; i++) {
+			Intern_Id result;
+			intern_if_not_new(&result, &table, bench.names.data[i]);
+		}
+		string_table_free(&table);
+	}
+	float ms = os_timer_delta_ms(begin, os_get_timer());
+
+	list_free(&bench.names);
+	push_allocator_free(&bench.alloc);
+	string_table_free(&xml_names);
+
+	if (!success)
+		return 0;
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	print(&p, "interns: ");
+	print_u32(&p, interned);
+	print(&p, "\nns per intern and lookup: ");
+	print_f64_fixed(&p, interned ? (double)ms * 1000000.0 / interned : 0.0, 1);
+	print(&p, "\n");
+	return p.pos - out_buffer;
+}
+
+// Interns whitespace separated words and prints their ids
+size_t test_intern(char *out_buffer, const char* in_buffer, size_t length)
+{
+	String_Table table = { 0 };
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+
+	Scanner s;
+	s.pos = in_buffer;
+	s.end = in_buffer + length;
+
+	accept_whitespace(&s);
+	while (!scanner_end(&s)) {
+		const char *begin = s.pos;
+		while (!scanner_end(&s) && !is_whitespace(*s.pos))
+			s.pos++;
+		String word = to_string(begin, s.pos);
+		accept_whitespace(&s);
+
+		Intern_Id id = intern(&table, word);
+		Intern_Id found_id;
+		bool found = intern_if_not_new(&found_id, &table, word);
+		String interned = intern_string(&table, id);
+
+		bool success = found && found_id == id
+			&& interned.length == word.length
+			&& !memcmp(interned.data, word.data, word.length);
+
+		if (!(success && print_u32(&p, id) && print(&p, ' ')))
+			break;
+	}
+
+	string_table_free(&table);
+	return p.pos - out_buffer;
+}
+
+// Checks that the string table of the compiled faces asset finds and interns
+// every name of the blob under its original id.
+size_t test_blob_names(char *out_buffer, const char* in_buffer, size_t length)
+{
+	SVG_Blob blob;
+	asset_faces_blob(&blob);
+
+	XML xml;
+	xml_from_blob(&xml, &blob.xml);
+
+	U32 mismatches = 0;
+	for (U32 i = 0; i < blob.xml.name_count; i++) {
+		String name = xml_blob_string(&blob.xml, blob.xml.names[i]);
+		Intern_Id found_id;
+		if (!intern_if_not_new(&found_id, &xml.string_table, name) || found_id != i)
+			mismatches++;
+		if (intern(&xml.string_table, name) != i)
+			mismatches++;
+	}
+	bool same_count = xml.string_table.strings.count == blob.xml.name_count;
+
+	xml_free(&xml);
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	print(&p, "names: ");
+	print_u32(&p, blob.xml.name_count);
+	print(&p, same_count ? "\nmismatches: " : "\ngrown, mismatches: ");
+	print_u32(&p, mismatches);
+	print(&p, "\n");
+	return p.pos - out_buffer;
+}
+
 size_t test_utf8_decode(char *out_buffer, const char* in_buffer, size_t length)
 {
 	const char *ptr = in_buffer;
@@ -107,13 +483,504 @@ size_t test_utf8_encode(char *out_buffer, const char* in_buffer, size_t length)
 	return out_ptr - out_buffer;
 }
 
+enum Test_Float_Format
+{
+	Test_Float_F64,
+	Test_Float_F32,
+	Test_Float_F64_Fixed2,
+};
+
+// Parses whitespace separated numbers and prints them back separated by spaces
+size_t test_print_floats(char *out_buffer, const char* in_buffer, size_t length,
+	Test_Float_Format format)
+{
+	char *text = M_ALLOC(char, length + 1);
+	memcpy(text, in_buffer, length);
+	text[length] = '\0';
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+
+	char *pos = text;
+	for (;;) {
+		char *end;
+		double value = strtod(pos, &end);
+		if (end == pos)
+			break;
+		pos = end;
+
+		bool success;
+		switch (format) {
+		case Test_Float_F64: success = print_f64(&p, value); break;
+		case Test_Float_F32: success = print_f32(&p, (float)value); break;
+		case Test_Float_F64_Fixed2: success = print_f64_fixed(&p, value, 2); break;
+		default: success = false;
+		}
+		if (!success || !print(&p, ' '))
+			break;
+	}
+
+	M_FREE(text);
+	return p.pos - out_buffer;
+}
+
+size_t test_print_f64(char *out_buffer, const char* in_buffer, size_t length)
+{
+	return test_print_floats(out_buffer, in_buffer, length, Test_Float_F64);
+}
+
+size_t test_print_f32(char *out_buffer, const char* in_buffer, size_t length)
+{
+	return test_print_floats(out_buffer, in_buffer, length, Test_Float_F32);
+}
+
+size_t test_print_f64_fixed2(char *out_buffer, const char* in_buffer, size_t length)
+{
+	return test_print_floats(out_buffer, in_buffer, length, Test_Float_F64_Fixed2);
+}
+
+size_t test_html_escape(char *out_buffer, const char* in_buffer, size_t length)
+{
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	if (!print_escaped(&p, to_string(in_buffer, length)))
+		return 0;
+	return p.pos - out_buffer;
+}
+
+// Pushes blocks of the whitespace separated sizes between markers and checks
+// that rewinding releases them without disturbing what was pushed before.
+size_t test_push_rewind(char *out_buffer, const char* in_buffer, size_t length)
+{
+	Push_Allocator alloc = { 0 };
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+
+	String kept = PUSH_COPY_STR(&alloc, c_string("kept"));
+
+	Scanner s;
+	s.pos = in_buffer;
+	s.end = in_buffer + length;
+
+	U32 reused = 0;
+	bool intact = true;
+	for (;;) {
+		accept_whitespace(&s);
+		U64 size;
+		if (!accept_int(&size, &s, 10))
+			break;
+
+		Push_Marker marker = push_allocator_mark(&alloc);
+		char *first = PUSH_ALLOC_N(&alloc, char, (size_t)size);
+		memset(first, 0xCD, (size_t)size);
+		push_allocator_rewind(&alloc, marker);
+
+		char *second = PUSH_ALLOC_N(&alloc, char, (size_t)size);
+		memset(second, 0xAB, (size_t)size);
+		if (second == first)
+			reused++;
+		push_allocator_rewind(&alloc, marker);
+
+		intact = intact && kept.length == 4 && !memcmp(kept.data, "kept", 4);
+	}
+
+	push_allocator_reset(&alloc);
+	bool reset = alloc.page.position == 0 && !alloc.page.previous;
+	push_allocator_free(&alloc);
+
+	print(&p, "reused: ");
+	print_u32(&p, reused);
+	print(&p, intact ? "\nintact\n" : "\ncorrupt\n");
+	print(&p, reset ? "reset\n" : "no reset\n");
+	return p.pos - out_buffer;
+}
+
+// Streams the input into a reserved allocator a few bytes at a time and checks
+// that the stream never moves while it grows.
+size_t test_reserved_stream(char *out_buffer, const char* in_buffer, size_t length)
+{
+	Reserved_Allocator alloc;
+	if (!reserved_allocator_init(&alloc, MB(64)))
+		return 0;
+
+	PUSH_COPY_STR(&alloc, c_string("prefix"));
+	Reserved_Stream stream = start_push_stream(&alloc);
+
+	char *first = 0;
+	bool stable = true;
+	for (size_t pos = 0; pos < length; pos += 7) {
+		String chunk = to_string(in_buffer + pos, min(length - pos, (size_t)7));
+		String copy = STREAM_COPY_STR(&stream, chunk);
+		if (!first)
+			first = copy.data;
+		stable = stable && copy.data == first + pos;
+	}
+
+	String result = finish_push_stream_string(&stream);
+	bool equal = result.length == length && !memcmp(result.data, in_buffer, length);
+
+	push_allocator_free(&alloc);
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	print(&p, stable ? "stable\n" : "moved\n");
+	print(&p, equal ? "equal\n" : "different\n");
+	return p.pos - out_buffer;
+}
+
+// Interleaves the whitespace separated words with aligned pushes and counts the
+// pushes that end up misaligned, both directly and in a stream that moves.
+size_t test_push_aligned(char *out_buffer, const char* in_buffer, size_t length)
+{
+	Push_Allocator alloc = { 0 };
+	Push_Allocator stream_alloc = { 0 };
+	Push_Stream stream = start_push_stream(&stream_alloc, 64);
+	Push_Allocator default_alloc = { 0 };
+	Push_Stream default_stream = start_push_stream(&default_alloc);
+
+	Scanner s;
+	s.pos = in_buffer;
+	s.end = in_buffer + length;
+
+	U32 misaligned = 0;
+	U32 stream_misaligned = 0;
+	size_t stream_offsets[64];
+	size_t default_offsets[64];
+	U32 stream_offset_count = 0;
+
+	accept_whitespace(&s);
+	while (!scanner_end(&s)) {
+		const char *begin = s.pos;
+		while (!scanner_end(&s) && !is_whitespace(*s.pos))
+			s.pos++;
+		String word = to_string(begin, s.pos);
+		accept_whitespace(&s);
+
+		PUSH_COPY_STR(&alloc, word);
+		U64 *value = PUSH_ALLOC(&alloc, U64);
+		float *simd16 = PUSH_ALLOC_16(&alloc, float, 4);
+		float *simd32 = PUSH_ALLOC_32(&alloc, float, 8);
+		char *line64 = PUSH_ALLOC_64(&alloc, char, 64);
+		misaligned += align_padding(value, ALIGNOF(U64)) != 0;
+		misaligned += align_padding(simd16, 16) != 0;
+		misaligned += align_padding(simd32, 32) != 0;
+		misaligned += align_padding(line64, 64) != 0;
+
+		STREAM_COPY_STR(&stream, word);
+		float *streamed = (float*)push_stream_push_aligned(&stream, 4 * sizeof(float), 16);
+		STREAM_COPY_STR(&default_stream, word);
+		U64 *default_streamed = STREAM_ALLOC(&default_stream, U64);
+		if (stream_offset_count < Count(stream_offsets)) {
+			stream_offsets[stream_offset_count] = (char*)streamed - (char*)finish_push_stream(&stream).data;
+			default_offsets[stream_offset_count] = (char*)default_streamed - (char*)finish_push_stream(&default_stream).data;
+			stream_offset_count++;
+		}
+	}
+
+	// The stream may have moved, check the final addresses
+	Data_Slice slice = finish_push_stream(&stream);
+	stream_misaligned += align_padding(slice.data, 64) != 0;
+	Data_Slice default_slice = finish_push_stream(&default_stream);
+	for (U32 i = 0; i < stream_offset_count; i++) {
+		stream_misaligned += align_padding((char*)slice.data + stream_offsets[i], 16) != 0;
+		stream_misaligned += align_padding((char*)default_slice.data + default_offsets[i], ALIGNOF(U64)) != 0;
+	}
+
+	push_allocator_free(&alloc);
+	push_allocator_free(&stream_alloc);
+	push_allocator_free(&default_alloc);
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	print(&p, "misaligned: ");
+	print_u32(&p, misaligned);
+	print(&p, "\nstream misaligned: ");
+	print_u32(&p, stream_misaligned);
+	print(&p, "\n");
+	return p.pos - out_buffer;
+}
+
+#define TEST_POOL_THREADS 4
+
+struct Test_Pool_Work
+{
+	Pool *pool;
+	U64 **objects;
+	U32 count;
+};
+
+// Frees the objects given to the thread, every other one directly to the shared
+// list, and allocates the same amount back
+void test_pool_thread(void *param)
+{
+	Test_Pool_Work *work = (Test_Pool_Work*)param;
+
+	for (U32 i = 0; i < work->count; i++) {
+		if (i % 2 == 0)
+			pool_release_shared(work->pool, work->objects[i]);
+		else
+			pool_release(work->pool, work->objects[i]);
+	}
+	for (U32 i = 0; i < work->count; i++) {
+		work->objects[i] = POOL_ALLOC(work->pool, U64);
+	}
+	pool_thread_flush(work->pool);
+}
+
+int compare_test_pool_object(const void *a, const void *b)
+{
+	U64 *pa = *(U64**)a, *pb = *(U64**)b;
+	return pa < pb ? -1 : pa > pb ? 1 : 0;
+}
+
+// Allocates the given number of objects, frees and reallocates them from other
+// threads, and counts the objects that were handed out twice.
+size_t test_pool(char *out_buffer, const char* in_buffer, size_t length)
+{
+	Scanner s;
+	s.pos = in_buffer;
+	s.end = in_buffer + length;
+	U64 count;
+	if (!accept_int(&count, &s, 10))
+		return 0;
+
+	Pool pool;
+	pool_init(&pool, sizeof(U64));
+
+	U32 total = (U32)count * TEST_POOL_THREADS;
+	U64 **objects = M_ALLOC(U64*, total);
+	for (U32 i = 0; i < total; i++) {
+		objects[i] = POOL_ALLOC(&pool, U64);
+	}
+	pool_thread_flush(&pool);
+
+	Test_Pool_Work work[TEST_POOL_THREADS];
+	for (U32 i = 0; i < TEST_POOL_THREADS; i++) {
+		work[i].pool = &pool;
+		work[i].objects = objects + i * (U32)count;
+		work[i].count = (U32)count;
+	}
+	TEST_RUN_THREADS(test_pool_thread, work);
+
+	// Every object must be distinct
+	U32 duplicates = 0;
+	qsort(objects, total, sizeof(U64*), compare_test_pool_object);
+	for (U32 i = 1; i < total; i++) {
+		if (objects[i] == objects[i - 1])
+			duplicates++;
+	}
+
+	M_FREE(objects);
+	pool_free(&pool);
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	print(&p, "duplicates: ");
+	print_u32(&p, duplicates);
+	print(&p, "\n");
+	return p.pos - out_buffer;
+}
+
+#define TEST_POOL_COUNT (POOL_THREAD_CACHES + 4)
+
+// Returns true if `object` is in one of the slabs of the pool
+bool test_pool_owns(Pool *pool, void *object)
+{
+	size_t objects_size = pool->object_size * pool->objects_per_slab;
+	for (Pool_Slab *slab = pool->slabs; slab; slab = slab->next) {
+		char *objects = pool_slab_objects(pool, slab);
+		if ((char*)object >= objects && (char*)object < objects + objects_size)
+			return true;
+	}
+	return false;
+}
+
+// Uses more pools at once than a thread has caches for, then frees them without
+// flushing and initializes new pools in their place. Counts the objects that
+// don't belong to the pool they were allocated from.
+size_t test_pool_caches(char *out_buffer, const char* in_buffer, size_t length)
+{
+	Scanner s;
+	s.pos = in_buffer;
+	s.end = in_buffer + length;
+	U64 count;
+	if (!accept_int(&count, &s, 10))
+		return 0;
+
+	Pool pools[TEST_POOL_COUNT];
+	U64 **objects = M_ALLOC(U64*, (U32)count);
+	U32 foreign = 0;
+
+	for (U32 round = 0; round < 2; round++) {
+		for (U32 i = 0; i < TEST_POOL_COUNT; i++) {
+			pool_init(&pools[i], sizeof(U64));
+		}
+
+		for (U32 i = 0; i < TEST_POOL_COUNT; i++) {
+			for (U32 j = 0; j < (U32)count; j++) {
+				objects[j] = POOL_ALLOC(&pools[i], U64);
+			}
+			for (U32 j = 0; j < (U32)count; j += 2) {
+				pool_release(&pools[i], objects[j]);
+			}
+			for (U32 j = 0; j < (U32)count; j += 2) {
+				objects[j] = POOL_ALLOC(&pools[i], U64);
+			}
+			for (U32 j = 0; j < (U32)count; j++) {
+				foreign += !test_pool_owns(&pools[i], objects[j]);
+			}
+		}
+
+		for (U32 i = 0; i < TEST_POOL_COUNT; i++) {
+			pool_free(&pools[i]);
+		}
+	}
+
+	M_FREE(objects);
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	print(&p, "foreign: ");
+	print_u32(&p, foreign);
+	print(&p, "\n");
+	return p.pos - out_buffer;
+}
+
+// Not inlined so it has a frame of its own in the trace
+NOINLINE U32 test_symbolize_capture(void **trace, U32 count)
+{
+	return (U32)os_capture_stack_trace(trace, (int)count);
+}
+
+// Symbolizes a stack trace captured in `test_symbolize_capture` and prints the
+// function and the source file of the frames in this file.
+size_t test_symbolize(char *out_buffer, const char* in_buffer, size_t length)
+{
+	void *trace[8];
+	U32 count = test_symbolize_capture(trace, Count(trace));
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+
+	os_symbol_info *symbols = os_get_address_infos(trace, (int)count);
+	if (!symbols)
+		return 0;
+
+	for (U32 i = 0; i < count; i++) {
+		os_symbol_info *symbol = &symbols[i];
+		if (!symbol->function || !symbol->filename || symbol->line <= 0)
+			continue;
+
+		String file = to_string(symbol->filename, symbol->filename_length);
+		String name = c_string("test_call.cpp");
+		if (file.length < name.length
+			|| memcmp(file.data + file.length - name.length, name.data, name.length))
+			continue;
+
+		print(&p, to_string(symbol->function, symbol->function_length));
+		print(&p, " test_call.cpp\n");
+	}
+
+	os_free_address_infos(symbols);
+	return p.pos - out_buffer;
+}
+
+// Checks that allocations are counted under their tag: explicitly tagged ones,
+// ones inheriting the thread tag and the pages of a tagged push allocator.
+size_t test_mem_tags(char *out_buffer, const char* in_buffer, size_t length)
+{
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	const Mem_Tag tag = Mem_Tag_Gzip;
+	U64 base = mem_tag_total(tag).live_bytes;
+
+	char *tagged = (char*)M_ALLOC_RAW_TAGGED(1000, tag);
+	print(&p, "tagged: ");
+	print_u64(&p, mem_tag_total(tag).live_bytes - base);
+
+	tagged = (char*)M_REALLOC_RAW(tagged, 3000);
+	print(&p, "\nrealloc: ");
+	print_u64(&p, mem_tag_total(tag).live_bytes - base);
+
+	Mem_Tag previous = mem_tag_set_thread(tag);
+	U64 *inherited = M_ALLOC(U64, 100);
+	mem_tag_set_thread(previous);
+	print(&p, "\ninherited: ");
+	print_u64(&p, mem_tag_total(tag).live_bytes - base);
+
+	Push_Allocator alloc = { 0 };
+	alloc.tag = tag;
+	PUSH_ALLOC_STR(&alloc, 10000);
+	print(&p, "\npush: ");
+	print(&p, mem_tag_total(tag).live_bytes - base >= 3000 + 800 + 10000 ? "yes" : "no");
+
+	push_allocator_free(&alloc);
+	M_FREE(inherited);
+	M_FREE(tagged);
+	print(&p, "\nfreed: ");
+	print_u64(&p, mem_tag_total(tag).live_bytes - base);
+	print(&p, "\n");
+	return p.pos - out_buffer;
+}
+
+// Pushes the given number of values into an array with inline storage, once
+// backed by the heap and once by an arena, and checks where the data lives.
+size_t test_dyn_array(char *out_buffer, const char* in_buffer, size_t length)
+{
+	Scanner s;
+	s.pos = in_buffer;
+	s.end = in_buffer + length;
+	U64 count;
+	if (!accept_int(&count, &s, 10))
+		return 0;
+
+	Push_Allocator arena = { 0 };
+	Dyn_Array<U32, 4> heap_array = { 0 };
+	Dyn_Array<U32, 4> arena_array = { 0 };
+	arena_array.arena = &arena;
+
+	for (U32 i = 0; i < (U32)count; i++) {
+		list_push(&heap_array, &i);
+		list_push(&arena_array, &i);
+	}
+
+	bool intact = heap_array.count == count && arena_array.count == count;
+	for (U32 i = 0; intact && i < (U32)count; i++) {
+		intact = heap_array.data[i] == i && arena_array.data[i] == i;
+	}
+
+	Printer p = make_printer(out_buffer, TEST_BUFFER_SIZE);
+	// Empty arrays have no data yet, which counts as inline
+	bool heap_inline = !heap_array.data || heap_array.data == heap_array.inline_data;
+	bool arena_inline = !arena_array.data || arena_array.data == arena_array.inline_data;
+	print(&p, heap_inline ? "inline" : "heap");
+	print(&p, " ");
+	print(&p, arena_inline ? "inline" : "arena");
+	print(&p, intact ? " intact\n" : " broken\n");
+
+	list_free(&heap_array);
+	list_free(&arena_array);
+	push_allocator_free(&arena);
+	return p.pos - out_buffer;
+}
+
 Test_Def test_defs[] = {
 	"crc32", test_crc32,
 	"gzip", test_gzip,
 	"identity", test_identity,
 	"xml", test_xml,
+	"xml_borrow", test_xml_borrow,
+	"xml_chunked", test_xml_chunked,
+	"xml_chunked_error", test_xml_chunked_error,
+	"intern", test_intern,
+	"blob_names", test_blob_names,
+	"bench_intern", test_bench_intern,
+	"concurrent_intern", test_concurrent_intern,
 	"utf8_decode", test_utf8_decode,
 	"utf8_encode", test_utf8_encode,
+	"print_f64", test_print_f64,
+	"print_f32", test_print_f32,
+	"print_f64_fixed2", test_print_f64_fixed2,
+	"html_escape", test_html_escape,
+	"push_rewind", test_push_rewind,
+	"reserved_stream", test_reserved_stream,
+	"push_aligned", test_push_aligned,
+	"pool", test_pool,
+	"pool_caches", test_pool_caches,
+	"symbolize", test_symbolize,
+	"mem_tags", test_mem_tags,
+	"dyn_array", test_dyn_array,
 };
 
 size_t test_call(const char *name, char *out_buffer,
@@ -124,30 +991,24 @@ size_t test_call(const char *name, char *out_buffer,
 			continue;
 
 #if BUILD_DEBUG
-		Debug_Alloc_Snapshot *begin = debug_thread_memory_snapshot();
+		U64 begin_serial = debug_alloc_current_serial();
 #endif
 
 		size_t size = test_defs[i].func(out_buffer, in_buffer, in_length);
 
 #if BUILD_DEBUG
-		Debug_Alloc_Snapshot *end = debug_thread_memory_snapshot();
-		Debug_Alloc_Snapshot *leaked = debug_snapshot_new_allocations(begin, end);
+		// Everything the test allocated and didn't free is leaked
+		Debug_Alloc_Snapshot leaked = debug_thread_allocations_since(begin_serial);
 
 		if (leak_amount) {
-			if (leaked) {
-				size_t amount = 0;
-				for (Debug_Alloc_Snapshot *alloc = leaked; alloc; alloc = alloc->next) {
-					amount += (size_t)alloc->header.size;
-				}
-				*leak_amount = amount;
-			} else {
-				*leak_amount = 0;
+			size_t amount = 0;
+			for (U32 j = 0; j < leaked.count; j++) {
+				amount += (size_t)leaked.allocations[j].size;
 			}
+			*leak_amount = amount;
 		}
 
-		debug_alloc_snapshot_free(begin);
-		debug_alloc_snapshot_free(end);
-		debug_alloc_snapshot_free(leaked);
+		debug_alloc_snapshot_free(&leaked);
 #endif
 
 		return size;
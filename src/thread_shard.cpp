@@ -0,0 +1,17 @@
+
+// Sharded structures like the debug allocator and the memory tag counters give
+// every thread a shard of its own where possible. Threads are numbered in the
+// order they first ask for a shard and keep the number for all the structures.
+
+os_atomic_uint32 g_thread_shard_counter;
+
+// Number of the calling thread, zero if not assigned yet
+OS_THREAD_LOCAL U32 g_thread_shard_number;
+
+// Returns the shard of the calling thread out of `shard_count`
+inline U32 thread_shard(U32 shard_count)
+{
+	if (!g_thread_shard_number)
+		g_thread_shard_number = os_atomic_increment(&g_thread_shard_counter);
+	return (g_thread_shard_number - 1) % shard_count;
+}
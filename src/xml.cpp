@@ -1,61 +1,276 @@
-struct XML_Attribute
+#define XML_NO_NODE UINT32_MAX
+
+#define XML_ENTITY_EMPTY UINT32_MAX
+
+struct XML_Entity
 {
-	Interned_String key;
+	Intern_Id key;
 	String value;
 };
 
-struct XML_Entity
+#define XML_ENTITY_INLINE_SLOTS 8
+
+// Open addressing map from the string ids of entity names to their values. The
+// predefined entities fit in the inline slots, so only documents that declare
+// their own entities allocate. The map must not be moved once it's in use.
+struct XML_Entity_Map
 {
-	Interned_String key;
-	String value;
+	XML_Entity *slots;
+	U32 count;
+	U32 capacity;
+	XML_Entity inline_slots[XML_ENTITY_INLINE_SLOTS];
 };
-LIST_STRUCT(XML_Entity);
 
+inline U32 xml_entity_slot(Intern_Id key, U32 capacity)
+{
+	return (key * 2654435769u) & (capacity - 1);
+}
+
+void xml_entity_map_grow(XML_Entity_Map *map)
+{
+	U32 old_capacity = map->capacity;
+	XML_Entity *old_slots = map->slots;
+
+	U32 new_capacity = max(old_capacity * 2, (U32)XML_ENTITY_INLINE_SLOTS);
+	XML_Entity *new_slots = old_slots ? M_ALLOC(XML_Entity, new_capacity) : map->inline_slots;
+	for (U32 i = 0; i < new_capacity; i++) {
+		new_slots[i].key = XML_ENTITY_EMPTY;
+	}
+
+	for (U32 i = 0; i < old_capacity; i++) {
+		if (old_slots[i].key == XML_ENTITY_EMPTY)
+			continue;
+		U32 slot = xml_entity_slot(old_slots[i].key, new_capacity);
+		while (new_slots[slot].key != XML_ENTITY_EMPTY)
+			slot = (slot + 1) & (new_capacity - 1);
+		new_slots[slot] = old_slots[i];
+	}
+
+	if (old_slots != map->inline_slots)
+		M_FREE(old_slots);
+	map->slots = new_slots;
+	map->capacity = new_capacity;
+}
+
+// Adds an entity unless it's already defined, the first definition is binding
+void xml_entity_map_insert(XML_Entity_Map *map, Intern_Id key, String value)
+{
+	if (map->count >= map->capacity * 3 / 4)
+		xml_entity_map_grow(map);
+
+	U32 mask = map->capacity - 1;
+	U32 slot = xml_entity_slot(key, map->capacity);
+	while (map->slots[slot].key != XML_ENTITY_EMPTY) {
+		if (map->slots[slot].key == key)
+			return;
+		slot = (slot + 1) & mask;
+	}
+
+	map->slots[slot].key = key;
+	map->slots[slot].value = value;
+	map->count++;
+}
+
+bool xml_entity_map_find(String *value, XML_Entity_Map *map, Intern_Id key)
+{
+	if (map->count == 0)
+		return false;
+
+	U32 mask = map->capacity - 1;
+	U32 slot = xml_entity_slot(key, map->capacity);
+	while (map->slots[slot].key != XML_ENTITY_EMPTY) {
+		if (map->slots[slot].key == key) {
+			*value = map->slots[slot].value;
+			return true;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return false;
+}
+
+void xml_entity_map_free(XML_Entity_Map *map)
+{
+	if (map->slots != map->inline_slots)
+		M_FREE(map->slots);
+}
+
+// Nodes refer to each other by index into `XML.nodes`, tags are string ids of
+// `XML.string_table`. The attributes of a node are `attribute_count` entries
+// starting from `first_attribute` in the attribute arrays of the XML.
 struct XML_Node
 {
-	Interned_String tag;
+	Intern_Id tag;
+	U32 parent;
+	U32 first_child;
+	U32 next_sibling;
 
-	XML_Attribute *attributes;
+	U32 first_attribute;
 	U32 attribute_count;
 
-	XML_Node *parent;
-	XML_Node *children;
-	XML_Node *prev;
-	XML_Node *next;
+	// Size of the subtree when printed with `print_xml`
+	U32 print_size;
 
 	String text;
 };
+typedef Dyn_Array<XML_Node, 8> XML_Node_List;
+typedef Dyn_Array<U32, 16> U32_List;
+
+// How `parse_xml` treats its input: text without entities is returned as
+// slices of the source, so the source must stay alive as long as the XML.
+// With `XML_Source_Copy` the XML keeps a private copy of the source.
+enum XML_Source
+{
+	XML_Source_Borrow,
+	XML_Source_Copy,
+};
 
 struct XML
 {
-	Push_Allocator attribute_alloc;
-	Push_Allocator node_alloc;
+	char *owned_source;
+
 	Push_Allocator text_alloc;
 
 	String_Table string_table;
 
-	XML_Entity_List entities;
+	// Nodes in document order, so the root is the first node and the subtree
+	// of a node is a contiguous range after it.
+	XML_Node_List nodes;
+
+	// Keys and values of the attributes of all the nodes
+	Dyn_Array<Intern_Id, 8> attribute_keys;
+	Dyn_Array<String, 8> attribute_values;
 
-	XML_Node *root;
 };
 
 void xml_free(XML *xml)
 {
-	push_allocator_free(&xml->attribute_alloc);
-	push_allocator_free(&xml->node_alloc);
+	M_FREE(xml->owned_source);
 	push_allocator_free(&xml->text_alloc);
 	string_table_free(&xml->string_table);
-	list_free(&xml->entities);
+	list_free(&xml->nodes);
+	list_free(&xml->attribute_keys);
+	list_free(&xml->attribute_values);
+}
+
+inline U32 xml_root(XML *xml)
+{
+	return xml->nodes.count > 0 ? 0 : XML_NO_NODE;
+}
+
+inline XML_Node *xml_node(XML *xml, U32 index)
+{
+	assert(index < xml->nodes.count);
+	return &xml->nodes.data[index];
+}
+
+inline String xml_name(XML *xml, Intern_Id id)
+{
+	return intern_string(&xml->string_table, id);
+}
+
+bool xml_find_attribute(String *value, XML *xml, U32 node_index, Intern_Id key)
+{
+	XML_Node *node = xml_node(xml, node_index);
+	Intern_Id *keys = xml->attribute_keys.data + node->first_attribute;
+	for (U32 i = 0; i < node->attribute_count; i++) {
+		if (keys[i] == key) {
+			*value = xml->attribute_values.data[node->first_attribute + i];
+			return true;
+		}
+	}
+	return false;
+}
+
+// Read-only DOM compiled into the executable by pre_assets, see
+// src/pre/pre_assets.cpp. The arrays hold no pointers, strings are offsets into
+// `text`, so the data needs no relocations when the executable is loaded. Names
+// are indexed by the string ids of the nodes.
+struct XML_Blob_String
+{
+	U32 offset;
+	U32 length;
+};
+
+struct XML_Blob_Node
+{
+	Intern_Id tag;
+	U32 parent;
+	U32 first_child;
+	U32 next_sibling;
+
+	U32 first_attribute;
+	U32 attribute_count;
+
+	U32 print_size;
+
+	XML_Blob_String text;
+};
+
+// Filled in by the generated `asset_*_blob` functions
+struct XML_Blob
+{
+	const char *text;
+
+	const XML_Blob_Node *nodes;
+	U32 node_count;
+
+	const Intern_Id *attribute_keys;
+	const XML_Blob_String *attribute_values;
+	U32 attribute_count;
+
+	const XML_Blob_String *names;
+	U32 name_count;
+};
+
+inline String xml_blob_string(const XML_Blob *blob, XML_Blob_String str)
+{
+	return to_string(blob->text + str.offset, str.length);
+}
+
+// Resolves the offsets of `blob` into `xml` without any parsing. The node text
+// and attribute values point into the blob, the arrays and the string table
+// are allocated and freed with `xml_free`.
+void xml_from_blob(XML *xml, const XML_Blob *blob)
+{
+	memset(xml, 0, sizeof(XML));
+
+	XML_Node *nodes = list_push(&xml->nodes, blob->node_count);
+	for (U32 i = 0; i < blob->node_count; i++) {
+		const XML_Blob_Node *src = &blob->nodes[i];
+		XML_Node *node = &nodes[i];
+		node->tag = src->tag;
+		node->parent = src->parent;
+		node->first_child = src->first_child;
+		node->next_sibling = src->next_sibling;
+		node->first_attribute = src->first_attribute;
+		node->attribute_count = src->attribute_count;
+		node->print_size = src->print_size;
+		node->text = xml_blob_string(blob, src->text);
+	}
+
+	Intern_Id *keys = list_push(&xml->attribute_keys, blob->attribute_count);
+	String *values = list_push(&xml->attribute_values, blob->attribute_count);
+	for (U32 i = 0; i < blob->attribute_count; i++) {
+		keys[i] = blob->attribute_keys[i];
+		values[i] = xml_blob_string(blob, blob->attribute_values[i]);
+	}
+
+	// The names were saved in order of id, so interning them in order gives
+	// them the same ids and the table works for later lookups and interning.
+	for (U32 i = 0; i < blob->name_count; i++) {
+		Intern_Id id = intern(&xml->string_table, xml_blob_string(blob, blob->names[i]));
+		assert(id == i);
+	}
 }
 
 inline bool xml_name_start_char(char c)
 {
-	return c >= 'A' && c <= 'Z' || c >= 'a' && c <= 'z' || c == ':' || c == '_';
+	return (char_class_table[(U8)c] & CHAR_CLASS_XML_NAME_START) != 0;
 }
 
 inline bool xml_name_char(char c)
 {
-	return xml_name_start_char(c) || c >= '0' && c <= '9' || c == '-' || c == '.';
+	return (char_class_table[(U8)c] & CHAR_CLASS_XML_NAME) != 0;
 }
 
 bool accept_xml_name(String *name, Scanner *s)
@@ -79,6 +294,15 @@ bool accept_xml_name(String *name, Scanner *s)
 	return true;
 }
 
+// Fails a construct that runs past the end of the input. The parser tells
+// these apart from syntax errors by the scanner being at the end, see
+// `xml_step_fail`.
+inline bool xml_need_input(Scanner *s)
+{
+	s->pos = s->end;
+	return false;
+}
+
 inline bool accept_xml_whitespace(Scanner *s)
 {
 	for (;;) {
@@ -86,47 +310,164 @@ inline bool accept_xml_whitespace(Scanner *s)
 		if (!accept(s, to_string("<!--", 4)))
 			break;
 		if (!skip_accept(s, to_string("-->", 3)))
-			return false;
+			return xml_need_input(s);
 	}
 
 	return true;
 }
 
-bool xml_get_entity(String *value, XML *xml, Interned_String key)
+// Streaming XML parser
+//
+// The parser reports the document as start element, text and end element
+// events to a handler without building any tree. Input can be fed in chunks
+// of any size: a construct that is cut off at the end of a chunk is kept and
+// parsed again when more data arrives, so memory use is bounded by the largest
+// single tag or text run instead of the size of the document. Constructs
+// longer than `XML_MAX_TOKEN_SIZE` are rejected, as are syntax errors as soon
+// as the offending construct has been fed.
+//
+// Strings passed to the handler are only valid during the callback, except
+// when the whole document is fed in one chunk, then text without entities
+// points into the fed data.
+
+struct XML_Sax_Attribute
 {
-	XML_Entity_List entities = xml->entities;
-	for (size_t i = 0; i < entities.count; i++) {
-		if (entities.data[i].key == key) {
-			*value = entities.data[i].value;
-			return true;
-		}
-	}
+	Intern_Id key;
+	String value;
+};
+typedef Dyn_Array<XML_Sax_Attribute, 8> XML_Sax_Attribute_List;
 
-	return false;
+// Handler callbacks, returning false stops the parsing. Tag and attribute
+// names are string ids of the name table of the parser. Empty elements report
+// both a start and an end event.
+typedef bool (*xml_start_func)(void *user, Intern_Id tag, XML_Sax_Attribute *attrs, U32 attr_count);
+typedef bool (*xml_text_func)(void *user, String text);
+typedef bool (*xml_end_func)(void *user, Intern_Id tag);
+
+struct XML_Handler
+{
+	void *user;
+	xml_start_func start;
+	xml_text_func text;
+	xml_end_func end;
+};
+
+// Text scanned by the parser: either a slice of the input or decoded text in
+// the scratch buffer of the parser, which may move while a construct is parsed.
+struct XML_Text_Span
+{
+	const char *source;
+	size_t scratch_offset;
+	size_t length;
+};
+typedef Dyn_Array<XML_Text_Span, 8> XML_Text_Span_List;
+typedef Dyn_Array<char, 256> char_List;
+
+struct XML_Parser
+{
+	XML_Handler handler;
+	String_Table *names;
+
+	XML_Entity_Map entities;
+
+	// Values of the entities declared in the DTD
+	Push_Allocator entity_alloc;
+
+	// Names of the currently open elements
+	Dyn_Array<Intern_Id, 16> open_tags;
+
+	// Input left over from the previous chunk
+	char_List pending;
+
+	// Decoded text and attributes of the construct being parsed
+	char_List scratch;
+	XML_Text_Span_List attribute_spans;
+	Dyn_Array<Intern_Id, 8> attribute_keys;
+	XML_Sax_Attribute_List attributes;
+
+	bool failed;
+};
+
+// Largest construct that may be cut off between chunks
+#define XML_MAX_TOKEN_SIZE KB(64)
+
+enum XML_Step
+{
+	XML_Step_Ok,
+	XML_Step_Incomplete,
+	XML_Step_Error,
+	XML_Step_Abort,
+};
+
+void xml_parser_init(XML_Parser *parser, String_Table *names, XML_Handler handler)
+{
+	memset(parser, 0, sizeof(XML_Parser));
+	parser->handler = handler;
+	parser->names = names;
+
+	XML_Entity_Map *entities = &parser->entities;
+	xml_entity_map_insert(entities, intern(names, c_string("lt")), char_string('<'));
+	xml_entity_map_insert(entities, intern(names, c_string("gt")), char_string('>'));
+	xml_entity_map_insert(entities, intern(names, c_string("amp")), char_string('&'));
+	xml_entity_map_insert(entities, intern(names, c_string("apos")), char_string('\''));
+	xml_entity_map_insert(entities, intern(names, c_string("quot")), char_string('"'));
 }
 
-bool xml_text_until(String *text, XML *xml, Scanner *s, String suffix)
+void xml_parser_free(XML_Parser *parser)
 {
-	if (suffix.length == 0) return false;
-	char suffix_start = suffix.data[0];
+	xml_entity_map_free(&parser->entities);
+	push_allocator_free(&parser->entity_alloc);
+	list_free(&parser->open_tags);
+	list_free(&parser->pending);
+	list_free(&parser->scratch);
+	list_free(&parser->attribute_spans);
+	list_free(&parser->attribute_keys);
+	list_free(&parser->attributes);
+}
 
-	Push_Stream stream = start_push_stream(&xml->text_alloc);
+// Looks up an entity by name, unknown names are not added to the name table
+bool xml_get_entity(String *value, XML_Parser *parser, String name)
+{
+	Intern_Id key;
+	if (!intern_if_not_new(&key, parser->names, name))
+		return false;
+	return xml_entity_map_find(value, &parser->entities, key);
+}
 
-	const char *pos = s->pos;
-	const char *end = s->end;
+inline String xml_text_resolve(XML_Parser *parser, XML_Text_Span span)
+{
+	if (span.source)
+		return to_string(span.source, span.length);
+	return to_string(parser->scratch.data + span.scratch_offset, span.length);
+}
 
-	if ((size_t)(end - pos) < suffix.length)
+// Scans text up to `terminator` decoding any entities on the way. Text
+// without entities is returned as a slice of the input, otherwise the decoded
+// text is appended to the scratch buffer. Leaves the scanner at the
+// terminator.
+bool xml_text_until(XML_Text_Span *text, XML_Parser *parser, Scanner *s, char terminator)
+{
+	const char *begin = s->pos;
+
+	// Fast path: find the terminator without any entities before it
+	const char *pos = scan_find(s->pos, s->end, terminator, '&');
+	s->pos = pos;
+	if (pos == s->end)
 		return false;
+	if (*pos == terminator) {
+		text->source = begin;
+		text->scratch_offset = 0;
+		text->length = pos - begin;
+		return true;
+	}
 
-	while (!scanner_end(s)) {
+	char_List *scratch = &parser->scratch;
+	size_t offset = scratch->count;
+	list_push(scratch, begin, pos - begin);
 
-		Scanner es = *s;
-		if (accept(&es, suffix_start)) {
-			if (accept(&es, substring(suffix, 1))) {
-				*text = finish_push_stream_string(&stream);
-				return true;
-			}
-		} else if (accept(s, '&')) {
+	while (!scanner_end(s)) {
+		const char *entity_start = s->pos;
+		if (accept(s, '&')) {
 
 			if (accept(s, '#')) {
 				int base = 10;
@@ -138,34 +479,45 @@ bool xml_text_until(String *text, XML *xml, Scanner *s, String suffix)
 				if (!accept(s, ';')) return false;
 
 				// @Unicode(xml)
-				if (code > 0xFF) return false;
+				if (code > 0xFF) {
+					// Point at the reference so this is not taken for missing input
+					s->pos = entity_start;
+					return false;
+				}
 
 				char ch = (char)code;
-				STREAM_COPY(&stream, char, &ch);
+				list_push(scratch, &ch);
 			} else {
-				const char *begin = s->pos;
-				if (!skip_accept(s, ';')) return false;
+				const char *entity_begin = s->pos;
+				if (!skip_accept(s, ';')) return xml_need_input(s);
 
-				Interned_String entity_key = intern(&xml->string_table, to_string(begin, s->pos - 1));
 				String entity_value;
-				if (xml_get_entity(&entity_value, xml, entity_key)) {
-					STREAM_COPY_STR(&stream, entity_value);
+				if (xml_get_entity(&entity_value, parser, to_string(entity_begin, s->pos - 1))) {
+					list_push(scratch, entity_value.data, entity_value.length);
 				} else {
-					STREAM_COPY_STR(&stream, to_string(begin - 1, s->pos));
+					list_push(scratch, entity_begin - 1, s->pos - (entity_begin - 1));
 				}
 			}
+		} else if (*s->pos == terminator) {
+			text->source = 0;
+			text->scratch_offset = offset;
+			text->length = scratch->count - offset;
+			return true;
 		} else {
-			char c = next_char(s);
-			STREAM_COPY(&stream, char, &c);
+			// Copy the whole run up to the next special character
+			const char *run_end = scan_find(s->pos, s->end, terminator, '&');
+			list_push(scratch, s->pos, run_end - s->pos);
+			s->pos = run_end;
 		}
 	}
 
 	return false;
 }
 
-bool parse_xml_attributes(XML_Attribute **attrs, U32 *attr_count, XML *xml, Scanner *s)
+bool parse_xml_attributes(XML_Parser *parser, Scanner *s)
 {
-	Push_Stream attr_stream = start_push_stream(&xml->attribute_alloc);
+	parser->attribute_spans.count = 0;
+	parser->attribute_keys.count = 0;
 
 	String attr_name;
 	while (accept_xml_name(&attr_name, s)) {
@@ -175,8 +527,8 @@ bool parse_xml_attributes(XML_Attribute **attrs, U32 *attr_count, XML *xml, Scan
 		char quote = accept_any(s, "\"'", 2);
 		if (!quote) return false;
 
-		String text;
-		if (!xml_text_until(&text, xml, s, char_string(quote)))
+		XML_Text_Span text;
+		if (!xml_text_until(&text, parser, s, quote))
 			return false;
 
 		// xml_text_until already matched the ending quote
@@ -184,147 +536,511 @@ bool parse_xml_attributes(XML_Attribute **attrs, U32 *attr_count, XML *xml, Scan
 
 		if (!accept_xml_whitespace(s)) return false;
 
-		XML_Attribute *attr = STREAM_ALLOC(&attr_stream, XML_Attribute);
-		attr->key = intern(&xml->string_table, attr_name);
-		attr->value = text;
+		Intern_Id key = intern(parser->names, attr_name);
+		list_push(&parser->attribute_keys, &key);
+		list_push(&parser->attribute_spans, &text);
 	}
 
-	// @Cleanup: This is too low-level code for here
-	Data_Slice attr_data = finish_push_stream(&attr_stream);
-	*attrs = (XML_Attribute*)attr_data.data;
-	*attr_count = (U32)(attr_data.length / sizeof(XML_Attribute));
+	// Resolve the values now that the scratch buffer won't move anymore
+	U32 count = (U32)parser->attribute_keys.count;
+	parser->attributes.count = 0;
+	XML_Sax_Attribute *attrs = list_push(&parser->attributes, count);
+	for (U32 i = 0; i < count; i++) {
+		attrs[i].key = parser->attribute_keys.data[i];
+		attrs[i].value = xml_text_resolve(parser, parser->attribute_spans.data[i]);
+	}
 
 	return true;
 }
 
-bool parse_xml(XML *xml, const char *data, size_t length)
+bool xml_skip_literal(Scanner *s)
 {
-	Scanner scanner;
-	scanner.pos = data;
-	scanner.end = data + length;
-	Scanner *s = &scanner;
-
-	const XML_Entity default_entities[] = {
-		{ intern(&xml->string_table, c_string("lt")), char_string('<') },
-		{ intern(&xml->string_table, c_string("gt")), char_string('>') },
-		{ intern(&xml->string_table, c_string("amp")), char_string('&') },
-		{ intern(&xml->string_table, c_string("apos")), char_string('\'') },
-		{ intern(&xml->string_table, c_string("quot")), char_string('"') },
-	};
-
-	list_push(&xml->entities, default_entities, Count(default_entities));
-
-	XML_Node *prev = 0;
-	XML_Node *parent = 0;
+	char quote = accept_any(s, "\"'", 2);
+	if (!quote) return false;
+	if (!skip_accept(s, quote)) return xml_need_input(s);
+	return true;
+}
 
+// Skips the rest of a markup declaration up to and including its `>`
+bool xml_skip_decl(Scanner *s)
+{
 	while (!scanner_end(s)) {
-		if (!accept_xml_whitespace(s)) return false;
+		char c = *s->pos;
+		if (c == '"' || c == '\'') {
+			if (!xml_skip_literal(s)) return false;
+		} else if (c == '>') {
+			scanner_skip(s, 1);
+			return true;
+		} else {
+			scanner_skip(s, 1);
+		}
+	}
+	return false;
+}
 
-		if (scanner_end(s))
-			break;
+// Parses an entity declaration after `<!ENTITY`. Only internal general
+// entities are stored, parameter and external entities are skipped. The
+// value is decoded when declared so it can be substituted as-is.
+bool parse_xml_entity_decl(XML_Parser *parser, Scanner *s)
+{
+	if (!accept_xml_whitespace(s)) return false;
+	if (accept(s, '%')) return xml_skip_decl(s);
 
-		if (accept(s, '<')) {
-			if (accept(s, '?')) {
-				if (!skip_accept(s, to_string("?>", 2)))
-					return false;
-			} else if (accept(s, '!')) {
-				if (!balance_accept(s, '<', '>'))
-					return false;
-			} else if (accept(s, '/')) {
-				if (!parent) {
-					return false;
-				}
-				if (!accept(s, parent->tag.string)) return false;
-				if (!accept(s, '>')) return false;
-				prev = parent;
-				parent = parent->parent;
-			} else {
-				String tag_name;
-				if (!accept_xml_name(&tag_name, s)) {
-					return false;
-				}
+	String name;
+	if (!accept_xml_name(&name, s)) return false;
+	if (!accept_xml_whitespace(s)) return false;
 
-				if (!accept_xml_whitespace(s)) return false;
+	char quote = accept_any(s, "\"'", 2);
+	if (quote) {
+		XML_Text_Span span;
+		if (!xml_text_until(&span, parser, s, quote))
+			return false;
+		scanner_skip(s, 1);
 
-				XML_Node *new_node = PUSH_ALLOC(&xml->node_alloc, XML_Node);
-				new_node->tag = intern(&xml->string_table, tag_name);
+		// Note: If the DTD is cut off by the end of a chunk this is parsed
+		// again, which is fine since the first definition of an entity wins.
+		String value = xml_text_resolve(parser, span);
+		if (value.length > 0)
+			value = PUSH_COPY_STR(&parser->entity_alloc, value);
+		xml_entity_map_insert(&parser->entities, intern(parser->names, name), value);
+	}
 
-				XML_Attribute *attrs;
-				U32 attr_count;
+	return xml_skip_decl(s);
+}
 
-				if (!parse_xml_attributes(&attrs, &attr_count, xml, s)) return false;
+// Parses a document type declaration after `<!DOCTYPE`
+bool parse_xml_doctype(XML_Parser *parser, Scanner *s)
+{
+	// Skip the name and external id up to the internal subset
+	for (;;) {
+		accept_whitespace(s);
+		if (scanner_end(s)) return false;
+		if (accept(s, '>')) return true;
+		if (accept(s, '[')) break;
 
-				new_node->attributes = attrs;
-				new_node->attribute_count = attr_count;
+		char c = *s->pos;
+		if (c == '"' || c == '\'') {
+			if (!xml_skip_literal(s)) return false;
+		} else {
+			scanner_skip(s, 1);
+		}
+	}
 
-				new_node->parent = parent;
-				new_node->prev = prev;
+	for (;;) {
+		if (!accept_xml_whitespace(s)) return false;
+		if (accept(s, ']')) break;
+
+		if (accept(s, to_string("<!ENTITY", 8))) {
+			if (!parse_xml_entity_decl(parser, s)) return false;
+		} else if (accept(s, to_string("<?", 2))) {
+			if (!skip_accept(s, to_string("?>", 2))) return xml_need_input(s);
+		} else if (accept(s, to_string("<!", 2))) {
+			if (!xml_skip_decl(s)) return false;
+		} else if (accept(s, '%')) {
+			// Parameter entity reference
+			if (!skip_accept(s, ';')) return xml_need_input(s);
+		} else if (s->end - s->pos == 1 && *s->pos == '<') {
+			// A lone `<` could still start any of the declarations
+			return xml_need_input(s);
+		} else {
+			return false;
+		}
+	}
 
-				new_node->children = 0;
-				new_node->next = 0;
+	accept_whitespace(s);
+	return accept(s, '>');
+}
 
-				new_node->text = empty_string();
+// A construct that failed with all of the input scanned may still be completed
+// by the next chunk, anything else is a syntax error.
+inline XML_Step xml_step_fail(Scanner *s)
+{
+	return scanner_end(s) ? XML_Step_Incomplete : XML_Step_Error;
+}
 
-				if (parent && !parent->children)
-					parent->children = new_node;
-				if (prev) prev->next = new_node;
-				if (!parent && !prev) {
-					xml->root = new_node;
-				}
+// Like `xml_step_fail` for a failed `accept(s, str)`, which doesn't advance
+inline XML_Step xml_step_fail_accept(Scanner *s, String str)
+{
+	size_t left = s->end - s->pos;
+	if (left < str.length && !memcmp(s->pos, str.data, left))
+		return XML_Step_Incomplete;
+	return XML_Step_Error;
+}
 
-				if (accept(s, '/')) {
-					if (!accept(s, '>')) return false;
-					prev = new_node;
-				} else if (accept(s, '>')) {
-					prev = 0;
-					parent = new_node;
-				}
+// Parses one construct from the scanner. Returns `XML_Step_Incomplete` if the
+// construct doesn't fit in the input, which is an error if the input is final,
+// and `XML_Step_Error` if the input can't be valid whatever follows it.
+XML_Step xml_parse_step(XML_Parser *parser, Scanner *s)
+{
+	XML_Handler *handler = &parser->handler;
+	parser->scratch.count = 0;
+
+	if (!accept_xml_whitespace(s)) return xml_step_fail(s);
+
+	if (scanner_end(s))
+		return XML_Step_Ok;
+
+	if (accept(s, '<')) {
+		if (accept(s, '?')) {
+			if (!skip_accept(s, to_string("?>", 2)))
+				return XML_Step_Incomplete;
+		} else if (accept(s, '!')) {
+			if (accept(s, to_string("DOCTYPE", 7))) {
+				if (!parse_xml_doctype(parser, s))
+					return xml_step_fail(s);
+			} else if (!balance_accept(s, '<', '>')) {
+				return XML_Step_Incomplete;
 			}
+		} else if (accept(s, '/')) {
+			Dyn_Array<Intern_Id, 16> *open_tags = &parser->open_tags;
+			if (open_tags->count == 0)
+				return XML_Step_Error;
+			Intern_Id tag = open_tags->data[open_tags->count - 1];
+			String tag_name = intern_string(parser->names, tag);
+			if (!accept(s, tag_name)) return xml_step_fail_accept(s, tag_name);
+			if (!accept(s, '>')) return xml_step_fail(s);
+
+			open_tags->count--;
+			if (handler->end && !handler->end(handler->user, tag))
+				return XML_Step_Abort;
 		} else {
-			String text;
-			if (!xml_text_until(&text, xml, s, to_string("<", 1)))
-				return false;
-			if (parent) {
-				parent->text = text;
+			String tag_name;
+			if (!accept_xml_name(&tag_name, s))
+				return xml_step_fail(s);
+
+			if (!accept_xml_whitespace(s)) return xml_step_fail(s);
+			if (!parse_xml_attributes(parser, s)) return xml_step_fail(s);
+
+			bool empty;
+			if (accept(s, '/')) {
+				if (!accept(s, '>')) return xml_step_fail(s);
+				empty = true;
+			} else if (accept(s, '>')) {
+				empty = false;
+			} else {
+				return xml_step_fail(s);
+			}
+
+			Intern_Id tag = intern(parser->names, tag_name);
+			XML_Sax_Attribute_List *attrs = &parser->attributes;
+			if (handler->start && !handler->start(handler->user, tag, attrs->data, (U32)attrs->count))
+				return XML_Step_Abort;
+
+			if (empty) {
+				if (handler->end && !handler->end(handler->user, tag))
+					return XML_Step_Abort;
+			} else {
+				list_push(&parser->open_tags, &tag);
 			}
 		}
+	} else {
+		XML_Text_Span text;
+		if (!xml_text_until(&text, parser, s, '<'))
+			return xml_step_fail(s);
+		if (handler->text && !handler->text(handler->user, xml_text_resolve(parser, text)))
+			return XML_Step_Abort;
+	}
+
+	return XML_Step_Ok;
+}
+
+// Parses all the complete constructs in `data` and returns how much of it
+// was consumed in `consumed`.
+bool xml_parser_run(XML_Parser *parser, const char *data, size_t length, bool final, size_t *consumed)
+{
+	Scanner s;
+	s.pos = data;
+	s.end = data + length;
+
+	while (!scanner_end(&s)) {
+		Scanner step = s;
+		XML_Step result = xml_parse_step(parser, &step);
+		if (result == XML_Step_Abort || result == XML_Step_Error)
+			return false;
+		if (result == XML_Step_Incomplete) {
+			if (final)
+				return false;
+			break;
+		}
+		s = step;
 	}
 
+	*consumed = s.pos - data;
 	return true;
 }
 
-bool print_xml(Printer *p, XML_Node *node)
+// Stops the parser for good and drops the input held back
+bool xml_parser_fail(XML_Parser *parser)
 {
-	bool success;
+	parser->failed = true;
+	list_free(&parser->pending);
+	return false;
+}
+
+bool xml_parser_feed(XML_Parser *parser, const char *data, size_t length)
+{
+	if (parser->failed)
+		return false;
+
+	char_List *pending = &parser->pending;
+	size_t consumed;
+
+	if (pending->count == 0) {
+		// Parse directly from the input and keep only the unfinished tail
+		if (!xml_parser_run(parser, data, length, false, &consumed)
+			|| length - consumed > XML_MAX_TOKEN_SIZE) {
+			return xml_parser_fail(parser);
+		}
+		list_push(pending, data + consumed, length - consumed);
+	} else {
+		list_push(pending, data, length);
+		if (!xml_parser_run(parser, pending->data, pending->count, false, &consumed)
+			|| pending->count - consumed > XML_MAX_TOKEN_SIZE) {
+			return xml_parser_fail(parser);
+		}
+		memmove(pending->data, pending->data + consumed, pending->count - consumed);
+		pending->count -= consumed;
+	}
+
+	return true;
+}
+
+// Parses the rest of the input, fails if anything is left unfinished
+bool xml_parser_finish(XML_Parser *parser)
+{
+	if (parser->failed)
+		return false;
+
+	char_List *pending = &parser->pending;
+	size_t consumed;
+	if (!xml_parser_run(parser, pending->data, pending->count, true, &consumed))
+		return xml_parser_fail(parser);
+	pending->count = 0;
+	return true;
+}
 
-	success =
-		print(p, '<') &&
-		print(p, node->tag);
-	if (!success) return false;
+// Printing is done in two passes: the size of every subtree is computed when
+// the DOM is built, so printing can reserve the exact space up front and copy
+// the text without any further bounds checks.
 
+size_t xml_open_tag_size(XML *xml, XML_Node *node)
+{
+	size_t size = 2 + xml_name(xml, node->tag).length;
 	for (U32 i = 0; i < node->attribute_count; i++) {
-		XML_Attribute attr = node->attributes[i];
-		success =
-			print(p, ' ') &&
-			print(p, attr.key) &&
-			print(p, "=\"") &&
-			print(p, attr.value) &&
-			print(p, '"');
-		if (!success) return false;
+		U32 attr = node->first_attribute + i;
+		size += 4 + xml_name(xml, xml->attribute_keys.data[attr]).length;
+		size += escaped_length(xml->attribute_values.data[attr]);
+	}
+	return size;
+}
+
+inline size_t xml_close_tag_size(XML *xml, XML_Node *node)
+{
+	return 3 + xml_name(xml, node->tag).length;
+}
+
+// Computes the printed size of a node from the cached sizes of its children
+U32 xml_print_size(XML *xml, U32 index)
+{
+	XML_Node *node = xml_node(xml, index);
+	size_t size = xml_open_tag_size(xml, node) + xml_close_tag_size(xml, node);
+	for (U32 child = node->first_child; child != XML_NO_NODE; child = xml_node(xml, child)->next_sibling) {
+		size += xml_node(xml, child)->print_size;
+	}
+	assert(size <= UINT32_MAX);
+	return (U32)size;
+}
+
+// DOM builder
+
+struct XML_Builder
+{
+	XML *xml;
+
+	// Text that points into the source can be stored without copying
+	const char *source;
+	size_t source_length;
+
+	U32 prev;
+	U32 parent;
+};
+
+inline String xml_builder_keep_text(XML_Builder *builder, String text)
+{
+	if (text.length == 0)
+		return empty_string();
+	if (text.data >= builder->source && text.data + text.length <= builder->source + builder->source_length)
+		return text;
+	return PUSH_COPY_STR(&builder->xml->text_alloc, text);
+}
+
+bool xml_builder_start(void *user, Intern_Id tag, XML_Sax_Attribute *attrs, U32 attr_count)
+{
+	XML_Builder *builder = (XML_Builder*)user;
+	XML *xml = builder->xml;
+
+	U32 first_attr = (U32)xml->attribute_keys.count;
+	for (U32 i = 0; i < attr_count; i++) {
+		String value = xml_builder_keep_text(builder, attrs[i].value);
+		list_push(&xml->attribute_keys, &attrs[i].key);
+		list_push(&xml->attribute_values, &value);
 	}
 
-	if (!print(p, '>')) return false;
+	U32 index = (U32)xml->nodes.count;
+	XML_Node *node = list_push(&xml->nodes);
+	node->tag = tag;
+	node->parent = builder->parent;
+	node->first_child = XML_NO_NODE;
+	node->next_sibling = XML_NO_NODE;
+	node->first_attribute = first_attr;
+	node->attribute_count = attr_count;
+	node->print_size = 0;
+	node->text = empty_string();
+
+	U32 parent = builder->parent;
+	if (parent != XML_NO_NODE && xml_node(xml, parent)->first_child == XML_NO_NODE)
+		xml_node(xml, parent)->first_child = index;
+	if (builder->prev != XML_NO_NODE)
+		xml_node(xml, builder->prev)->next_sibling = index;
+
+	builder->prev = XML_NO_NODE;
+	builder->parent = index;
+	return true;
+}
 
-	for (XML_Node *child = node->children; child; child = child->next) {
-		if (!print_xml(p, child)) return false;
+bool xml_builder_text(void *user, String text)
+{
+	XML_Builder *builder = (XML_Builder*)user;
+	if (builder->parent != XML_NO_NODE) {
+		xml_node(builder->xml, builder->parent)->text = xml_builder_keep_text(builder, text);
 	}
+	return true;
+}
+
+bool xml_builder_end(void *user, Intern_Id tag)
+{
+	XML_Builder *builder = (XML_Builder*)user;
+	XML *xml = builder->xml;
 
-	success =
-		print(p, "</") &&
-		print(p, node->tag) &&
-		print(p, '>');
-	if (!success) return false;
+	// All the children are finished so the size of the subtree is known
+	XML_Node *node = xml_node(xml, builder->parent);
+	node->print_size = xml_print_size(xml, builder->parent);
 
+	builder->prev = builder->parent;
+	builder->parent = node->parent;
 	return true;
 }
 
+// Builds the DOM into `xml`, text outside of `source` is copied into the XML.
+void xml_builder_init(XML_Builder *builder, XML *xml, const char *source, size_t source_length)
+{
+	builder->xml = xml;
+	builder->source = source;
+	builder->source_length = source_length;
+	builder->prev = XML_NO_NODE;
+	builder->parent = XML_NO_NODE;
+}
+
+XML_Handler xml_builder_handler(XML_Builder *builder)
+{
+	XML_Handler handler;
+	handler.user = builder;
+	handler.start = xml_builder_start;
+	handler.text = xml_builder_text;
+	handler.end = xml_builder_end;
+	return handler;
+}
+
+bool parse_xml(XML *xml, const char *data, size_t length, XML_Source source=XML_Source_Copy)
+{
+	if (source == XML_Source_Copy) {
+		xml->owned_source = M_ALLOC(char, length);
+		memcpy(xml->owned_source, data, length);
+		data = xml->owned_source;
+	}
+
+	XML_Builder builder;
+	xml_builder_init(&builder, xml, data, length);
+
+	XML_Parser parser;
+	xml_parser_init(&parser, &xml->string_table, xml_builder_handler(&builder));
+
+	bool success = xml_parser_feed(&parser, data, length)
+		&& xml_parser_finish(&parser);
+
+	xml_parser_free(&parser);
+	return success;
+}
+
+inline char *xml_copy(char *dst, String str)
+{
+	memcpy(dst, str.data, str.length);
+	return dst + str.length;
+}
+
+char *xml_write_open(char *dst, XML *xml, XML_Node *node)
+{
+	*dst++ = '<';
+	dst = xml_copy(dst, xml_name(xml, node->tag));
+
+	for (U32 i = 0; i < node->attribute_count; i++) {
+		U32 attr = node->first_attribute + i;
+		*dst++ = ' ';
+		dst = xml_copy(dst, xml_name(xml, xml->attribute_keys.data[attr]));
+		*dst++ = '=';
+		*dst++ = '"';
+		dst = copy_escaped(dst, xml->attribute_values.data[attr]);
+		*dst++ = '"';
+	}
+
+	*dst++ = '>';
+	return dst;
+}
+
+// Writes the subtree of `root` to `dst`, which must have at least the
+// `print_size` of the root reserved. The tree is walked iteratively by
+// descending to the first child and climbing through the parent links when
+// a node has no more siblings. Returns the end of the written text.
+char *xml_write(char *dst, XML *xml, U32 root)
+{
+	U32 index = root;
+	for (;;) {
+		XML_Node *node = xml_node(xml, index);
+		dst = xml_write_open(dst, xml, node);
+
+		if (node->first_child != XML_NO_NODE) {
+			index = node->first_child;
+			continue;
+		}
+
+		for (;;) {
+			node = xml_node(xml, index);
+			*dst++ = '<';
+			*dst++ = '/';
+			dst = xml_copy(dst, xml_name(xml, node->tag));
+			*dst++ = '>';
+
+			if (index == root)
+				return dst;
+
+			if (node->next_sibling != XML_NO_NODE) {
+				index = node->next_sibling;
+				break;
+			}
+			index = node->parent;
+		}
+	}
+}
+
+// Prints the subtree of `root`, nothing is written if it doesn't fit
+bool print_xml(Printer *p, XML *xml, U32 root)
+{
+	U32 size = xml_node(xml, root)->print_size;
+	char *dst = print_reserve(p, size);
+	if (!dst)
+		return false;
+
+	char *end = xml_write(dst, xml, root);
+	assert(end == dst + size);
+	return true;
+}
@@ -0,0 +1,57 @@
+
+rewind_fixtures = [
+	([16, 32, 8, 100], 'Small blocks'),
+	([1, 1, 1, 1, 1, 1], 'Tiny blocks'),
+]
+
+for sizes, desc in rewind_fixtures:
+	result = test_call('push_rewind', ' '.join(str(s) for s in sizes))
+	expected = 'reused: %d\nintact\nreset\n' % len(sizes)
+	t.check(result == expected, 'Rewound blocks are reused', desc + ': ' + result)
+
+growing = [4 ** n for n in range(1, 12)]
+result = test_call('push_rewind', ' '.join(str(s) for s in growing))
+t.check(result.endswith('intact\nreset\n'), 'Rewinding new pages keeps older data', result)
+
+stream_fixtures = [
+	('hello', 'Short stream'),
+	('x' * 100000, 'Stream over one commit step'),
+	(''.join(chr(n % 256) for n in range(600000)), 'Stream over many commit steps'),
+]
+
+for data, desc in stream_fixtures:
+	result = test_call('reserved_stream', data)
+	t.check(result == 'stable\nequal\n', 'Reserved stream grows in place', desc + ': ' + result)
+
+aligned_fixtures = [
+	(['a', 'bcd', 'efghijk'], 'Odd length strings'),
+	(['x' * n for n in range(1, 200, 7)], 'Growing strings'),
+	(['y' * 5000, 'z', 'w' * 30000], 'Strings larger than a page'),
+]
+
+for words, desc in aligned_fixtures:
+	result = test_call('push_aligned', ' '.join(words))
+	t.check(result == 'misaligned: 0\nstream misaligned: 0\n', 'Aligned pushes are aligned', desc + ': ' + result)
+
+for count in [1, 10, 1000, 20000]:
+	result = test_call('pool', str(count))
+	t.check(result == 'duplicates: 0\n', 'Pool objects are distinct across threads', '%d objects: %s' % (count, result))
+
+for count in [1, 100, 5000]:
+	result = test_call('pool_caches', str(count))
+	t.check(result == 'foreign: 0\n', 'Pools work past the thread cache limit', '%d objects: %s' % (count, result))
+
+result = test_call('mem_tags', '')
+expected = 'tagged: 1000\nrealloc: 3000\ninherited: 3800\npush: yes\nfreed: 0\n'
+t.check(result == expected, 'Allocations are counted under their tag', result)
+
+dyn_array_fixtures = [
+	(0, 'inline inline intact\n'),
+	(4, 'inline inline intact\n'),
+	(5, 'heap arena intact\n'),
+	(1000, 'heap arena intact\n'),
+]
+
+for count, expected in dyn_array_fixtures:
+	result = test_call('dyn_array', str(count))
+	t.check(result == expected, 'Dyn_Array keeps small arrays inline', '%d values: %s' % (count, result))
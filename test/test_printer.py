@@ -0,0 +1,63 @@
+import struct
+
+def to_f32(value):
+	return struct.unpack('f', struct.pack('f', value))[0]
+
+random.seed(1234)
+
+float_fixtures = [
+	([0.0, 1.0, 2.0, 10.0, 100.0, 195.0, 123.456, 0.1, 0.2, 0.3], 'Simple values'),
+	([-1.0, -0.5, -123.25, -1e-10], 'Negative values'),
+	([1e21, 1e22, 1e-5, 1e-6, 1e-7, 1.5e300, 2.5e-300], 'Exponent boundaries'),
+	([5e-324, 2.2250738585072014e-308, 1.7976931348623157e308], 'Denormals and limits'),
+	([2.0 ** n for n in range(-60, 60)], 'Powers of two'),
+	([random.uniform(0, 1000) for n in range(500)], 'Random values'),
+	([random.uniform(-1, 1) * 10 ** random.randint(-300, 300) for n in range(500)], 'Random magnitudes'),
+]
+
+for data, desc in float_fixtures:
+	text = ' '.join(repr(x) for x in data)
+	out = test_call("print_f64", text).split()
+	if t.check(len(out) == len(data), "Printed all doubles", desc):
+		t.check(all(float(o) == x for o, x in zip(out, data)), "Doubles round trip", desc)
+		repr_length = sum(len(repr(x)) for x in data)
+		out_length = sum(len(o) for o in out)
+		t.check(out_length <= repr_length, "Doubles are printed short",
+			'%s, %d > %d' % (desc, out_length, repr_length))
+
+	data32 = [to_f32(x) for x in data if abs(x) < 1e38]
+	text = ' '.join(repr(x) for x in data32)
+	out = test_call("print_f32", text).split()
+	if t.check(len(out) == len(data32), "Printed all floats", desc):
+		t.check(all(to_f32(float(o)) == x for o, x in zip(out, data32)), "Floats round trip", desc)
+		t.check(all(len(o.split('e')[0].lstrip('-').replace('.', '').strip('0')) <= 9 for o in out), "Floats are printed short", desc)
+
+t.check(test_call("print_f32", "0.1 195 -2.5").split() == ['0.1', '195', '-2.5'],
+	"Floats are printed shortest")
+
+fixed_data = [0.0, -0.0, 1.0, 0.004, 0.006, -0.004, 9.996, 99.999, 1048.576, 123.456]
+# Decimal halfway cases, which are rarely exact in binary
+fixed_data += [252.665, -69.035, 0.125, 0.375, -0.625, 2.675, 1.005, 0.015, 1e20 + 0.5, 5e-324]
+fixed_data += [random.uniform(-1000, 1000) for n in range(200)]
+fixed_data += [random.randint(-1000000, 1000000) / 1000.0 for n in range(1000)]
+out = test_call("print_f64_fixed2", ' '.join(repr(x) for x in fixed_data)).split()
+expected = ['%.2f' % x for x in fixed_data]
+mismatch = [(o, e) for o, e in zip(out, expected) if o != e]
+t.check(len(out) == len(fixed_data) and not mismatch, "Fixed precision matches %.2f", str(mismatch[:3]))
+
+def html_escape(text):
+	return (text.replace('&', '&amp;').replace('<', '&lt;').replace('>', '&gt;')
+		.replace('"', '&quot;').replace("'", '&#39;'))
+
+escape_fixtures = fixtures + [
+	('', 'Empty text'),
+	('No special characters at all in this fairly long text', 'Clean text'),
+	('<>&"\'', 'Only special characters'),
+	('a' * 15 + '<' + 'b' * 16 + '&' + 'c' * 31 + '"', 'Special characters at chunk edges'),
+	(''.join(random.choice('ab<>&"\' ') for n in range(1000)), 'Random text'),
+	('x' * 10000 + '\'', 'Long clean run'),
+]
+
+for data, desc in escape_fixtures:
+	out = test_call("html_escape", data)
+	t.check(out == html_escape(str(data)), "HTML escaping is correct", desc)
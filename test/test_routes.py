@@ -7,3 +7,24 @@ for route in expect_routes:
 
 r = dorf_get('/sdoijfiosdjf')
 t.check(r.status_code == 404, 'Random route gives 404')
+
+r = dorf_get('/locations/999999')
+t.check(r.status_code == 404, 'Missing location gives 404')
+t.check(r.text == 'Location not found with ID #999999',
+	'Missing location reports its ID', r.text)
+
+import socket
+
+# The feed stream never ends, so only check the response headers
+stream = socket.create_connection(('127.0.0.1', 3500), timeout=5)
+stream.sendall('GET /feed/stream HTTP/1.1\r\n\r\n')
+response = ''
+while '\r\n\r\n' not in response:
+	chunk = stream.recv(1024)
+	if not chunk:
+		break
+	response += chunk
+stream.close()
+
+t.check(response.startswith('HTTP/1.1 200'), "Can open '/feed/stream'")
+t.check('Content-Type: text/event-stream' in response, "Feed stream is an event stream")
@@ -0,0 +1,35 @@
+import random
+
+words = ['svg', 'g', 'path', 'id', 'fill', 'stroke', 'd', 'face-base01', 'face-eyes02']
+rnd = random.Random(1234)
+many_words = ['w%d' % rnd.randint(0, 3000) for n in range(5000)]
+
+intern_fixtures = [
+	(words, 'XML names'),
+	(words * 3, 'Repeated names'),
+	(many_words, 'Many words with rehashing'),
+	(['a' * n for n in range(1, 40)], 'Growing lengths'),
+]
+
+for fixture, desc in intern_fixtures:
+	result = test_call('intern', ' '.join(fixture)).split()
+	if t.check(len(result) == len(fixture), 'Every word is interned', desc):
+		ids = {}
+		for word, id in zip(fixture, result):
+			ids.setdefault(word, id)
+		t.check(all(ids[w] == i for w, i in zip(fixture, result)), 'Equal words have equal ids', desc)
+		t.check(len(set(ids.values())) == len(ids), 'Different words have different ids', desc)
+		first_seen = sorted(ids.values(), key=int)
+		t.check(first_seen == [str(n) for n in range(1, len(ids) + 1)], 'Ids are sequential after the empty string', desc)
+
+for fixture, desc in intern_fixtures:
+	result = test_call('concurrent_intern', ' '.join(fixture))
+	t.check(result == 'mismatches: 0\n', 'Threads intern to the same strings', desc + ': ' + result)
+
+faces = open('data/faces.svg', 'rb').read()
+result = test_call('bench_intern', faces)
+t.check(result.startswith('interns: '), 'Intern benchmark runs', result)
+
+result = test_call('blob_names', '')
+t.check(result.startswith('names: ') and result.endswith('\nmismatches: 0\n'),
+	'Compiled asset names intern to their ids', result)
@@ -0,0 +1,6 @@
+
+result = test_call('symbolize', '')
+lines = result.splitlines()
+t.check(len(lines) >= 2, 'Stack trace is symbolized', result)
+t.check(lines[:2] == ['test_symbolize_capture test_call.cpp', 'test_symbolize test_call.cpp'],
+	'Frames resolve to the right functions', result)
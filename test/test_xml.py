@@ -5,6 +5,11 @@ xml_fixtures = [
 	("<other><inner arg='thing' second='woo' /></other>", 'Single quote arguments'),
 	('<root attr="&#65;&#x61;Ao">&#65;&#x61;Ao</root>', 'Character entities'),
 	('<root attr="&lt;&gt;&amp;&apos;&quot;">&lt;&gt;&amp;&apos;&quot;</root>', 'Predefined entities'),
+	('<?xml version="1.0"?>\n<!DOCTYPE root [\n\t<!ELEMENT root ANY>\n\t<!ELEMENT a ANY>\n]>\n<root><a>Text</a></root>', 'Prolog and doctype'),
+	('<root>' + ' \t\r\n' * 20 + '<a x="1"' + ' ' * 40 + '/>' + '\n' * 17 + '</root>', 'Long whitespace runs'),
+	('<!DOCTYPE root SYSTEM "root.dtd" [\n\t<!ENTITY greet "Hello &amp; hi">\n\t<!ENTITY % skip "x">\n\t<!ENTITY ch \'&#65;\'>\n]>\n<root a="&greet;" b="&ch;&ch;">&greet; world</root>', 'DTD entities'),
+	('<root a="plain" b="x &amp; y">Plain text</root>', 'Mixed plain and entity text'),
+	('<root><!-- ' + '- -> <!- ' * 10 + '--><a/><!---->' + '<!-- x -->' * 8 + '</root>', 'Long comments'),
 ]
 
 class Dorf_XML_Node:
@@ -72,12 +77,44 @@ def xml_match(py, dorf, desc):
 		for p,d in zip(children, dorf.children):
 			xml_match(p, d, desc)
 
-for data, desc in xml_fixtures:
-	dorf_xml = parse_dorf_xml(test_call("xml", data))
-	py_xml = xml.dom.minidom.parseString(data).documentElement
-	if not dorf_xml:
-		t.check(False, "Failed to parse XML", desc)
-	else:
-		xml_match(py_xml, dorf_xml, desc)
+# Parse with the XML owning a copy of the source, borrowing it in place and
+# streaming it in small chunks
+for test_name in ['xml', 'xml_borrow', 'xml_chunked']:
+	for data, desc in xml_fixtures:
+		desc = '%s (%s)' % (desc, test_name)
+		dorf_xml = parse_dorf_xml(test_call(test_name, data))
+		py_xml = xml.dom.minidom.parseString(data).documentElement
+		if not dorf_xml:
+			t.check(False, "Failed to parse XML", desc)
+		else:
+			xml_match(py_xml, dorf_xml, desc)
+
+
+
+# Malformed documents must fail as soon as the offending construct has been
+# fed instead of being held back until the end, the filler makes sure of that
+filler = '<x>' + 'text ' * 2000 + '</x>'
+xml_error_fixtures = [
+	('</a>' + filler, 0, 'Close tag without an open element'),
+	('<a></b>' + filler, 0, 'Mismatched close tag'),
+	('<a><b></bb>' + filler, 7, 'Close tag longer than the open tag'),
+	('<a x=1>' + filler, 0, 'Unquoted attribute'),
+	('<a>&#300;' + filler, 7, 'Character reference out of range'),
+	('<a/ >' + filler, 0, 'Broken empty element'),
+	('<!DOCTYPE a [ x ]>' + filler, 14, 'Invalid doctype'),
+]
+
+for data, offset, desc in xml_error_fixtures:
+	result = test_call('xml_chunked_error', '7\n' + data)
+	t.check(result.startswith('failed at %d,' % offset), 'Malformed XML fails early', '%s: %s' % (desc, result.strip()))
 
+result = test_call('xml_chunked_error', '7\n<a>' + filler + '</a>')
+t.check(result.startswith('ok,'), 'Well-formed XML parses in chunks', result.strip())
 
+# Constructs that never end are cut off at the token limit, fed in bigger
+# chunks as every chunk rescans the held back construct
+for desc, data in [('Text', '<a>' + 'x' * 100000), ('Tag', '<a ' + 'b="c" ' * 20000)]:
+	result = test_call('xml_chunked_error', '4096\n' + data)
+	failed = result.startswith('failed at ') and not result.startswith('failed at finish')
+	pending = int(result.split('pending ')[1])
+	t.check(failed and pending <= 65536, 'Unterminated construct is bounded', '%s: %s' % (desc, result.strip()))